@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/compressor.dir/src/main.cpp.o"
+  "CMakeFiles/compressor.dir/src/main.cpp.o.d"
+  "libcompressor.pdb"
+  "libcompressor.so"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/compressor.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/compressor_bench.dir/bench/compressorBench.cpp.o"
+  "CMakeFiles/compressor_bench.dir/bench/compressorBench.cpp.o.d"
+  "compressor_bench"
+  "compressor_bench.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/compressor_bench.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
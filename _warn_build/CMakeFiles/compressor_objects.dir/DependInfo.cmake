@@ -0,0 +1,54 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/src/commands/formatCommandLineArguments.cpp" "CMakeFiles/compressor_objects.dir/src/commands/formatCommandLineArguments.cpp.o" "gcc" "CMakeFiles/compressor_objects.dir/src/commands/formatCommandLineArguments.cpp.o.d"
+  "/root/repo/src/compression/BundleQueue.cpp" "CMakeFiles/compressor_objects.dir/src/compression/BundleQueue.cpp.o" "gcc" "CMakeFiles/compressor_objects.dir/src/compression/BundleQueue.cpp.o.d"
+  "/root/repo/src/compression/Compressor.cpp" "CMakeFiles/compressor_objects.dir/src/compression/Compressor.cpp.o" "gcc" "CMakeFiles/compressor_objects.dir/src/compression/Compressor.cpp.o.d"
+  "/root/repo/src/compression/CompressorImpl.cpp" "CMakeFiles/compressor_objects.dir/src/compression/CompressorImpl.cpp.o" "gcc" "CMakeFiles/compressor_objects.dir/src/compression/CompressorImpl.cpp.o.d"
+  "/root/repo/src/compression/CostModel.cpp" "CMakeFiles/compressor_objects.dir/src/compression/CostModel.cpp.o" "gcc" "CMakeFiles/compressor_objects.dir/src/compression/CostModel.cpp.o.d"
+  "/root/repo/src/compression/Delta.cpp" "CMakeFiles/compressor_objects.dir/src/compression/Delta.cpp.o" "gcc" "CMakeFiles/compressor_objects.dir/src/compression/Delta.cpp.o.d"
+  "/root/repo/src/compression/FragmentCache.cpp" "CMakeFiles/compressor_objects.dir/src/compression/FragmentCache.cpp.o" "gcc" "CMakeFiles/compressor_objects.dir/src/compression/FragmentCache.cpp.o.d"
+  "/root/repo/src/compression/SharedCache.cpp" "CMakeFiles/compressor_objects.dir/src/compression/SharedCache.cpp.o" "gcc" "CMakeFiles/compressor_objects.dir/src/compression/SharedCache.cpp.o.d"
+  "/root/repo/src/compression/functions/bundleInlineScripts.cpp" "CMakeFiles/compressor_objects.dir/src/compression/functions/bundleInlineScripts.cpp.o" "gcc" "CMakeFiles/compressor_objects.dir/src/compression/functions/bundleInlineScripts.cpp.o.d"
+  "/root/repo/src/compression/functions/canonicalizeAttributes.cpp" "CMakeFiles/compressor_objects.dir/src/compression/functions/canonicalizeAttributes.cpp.o" "gcc" "CMakeFiles/compressor_objects.dir/src/compression/functions/canonicalizeAttributes.cpp.o.d"
+  "/root/repo/src/compression/functions/collapseWhitespace.cpp" "CMakeFiles/compressor_objects.dir/src/compression/functions/collapseWhitespace.cpp.o" "gcc" "CMakeFiles/compressor_objects.dir/src/compression/functions/collapseWhitespace.cpp.o.d"
+  "/root/repo/src/compression/functions/dedupeInlineBlocks.cpp" "CMakeFiles/compressor_objects.dir/src/compression/functions/dedupeInlineBlocks.cpp.o" "gcc" "CMakeFiles/compressor_objects.dir/src/compression/functions/dedupeInlineBlocks.cpp.o.d"
+  "/root/repo/src/compression/functions/detectMinified.cpp" "CMakeFiles/compressor_objects.dir/src/compression/functions/detectMinified.cpp.o" "gcc" "CMakeFiles/compressor_objects.dir/src/compression/functions/detectMinified.cpp.o.d"
+  "/root/repo/src/compression/functions/mangleNames.cpp" "CMakeFiles/compressor_objects.dir/src/compression/functions/mangleNames.cpp.o" "gcc" "CMakeFiles/compressor_objects.dir/src/compression/functions/mangleNames.cpp.o.d"
+  "/root/repo/src/compression/functions/mergeStyleRules.cpp" "CMakeFiles/compressor_objects.dir/src/compression/functions/mergeStyleRules.cpp.o" "gcc" "CMakeFiles/compressor_objects.dir/src/compression/functions/mergeStyleRules.cpp.o.d"
+  "/root/repo/src/compression/functions/minifyCSS.cpp" "CMakeFiles/compressor_objects.dir/src/compression/functions/minifyCSS.cpp.o" "gcc" "CMakeFiles/compressor_objects.dir/src/compression/functions/minifyCSS.cpp.o.d"
+  "/root/repo/src/compression/functions/minifyHTML.cpp" "CMakeFiles/compressor_objects.dir/src/compression/functions/minifyHTML.cpp.o" "gcc" "CMakeFiles/compressor_objects.dir/src/compression/functions/minifyHTML.cpp.o.d"
+  "/root/repo/src/compression/functions/minifyInlineSVG.cpp" "CMakeFiles/compressor_objects.dir/src/compression/functions/minifyInlineSVG.cpp.o" "gcc" "CMakeFiles/compressor_objects.dir/src/compression/functions/minifyInlineSVG.cpp.o.d"
+  "/root/repo/src/compression/functions/minifyJS.cpp" "CMakeFiles/compressor_objects.dir/src/compression/functions/minifyJS.cpp.o" "gcc" "CMakeFiles/compressor_objects.dir/src/compression/functions/minifyJS.cpp.o.d"
+  "/root/repo/src/compression/functions/minifyJSON.cpp" "CMakeFiles/compressor_objects.dir/src/compression/functions/minifyJSON.cpp.o" "gcc" "CMakeFiles/compressor_objects.dir/src/compression/functions/minifyJSON.cpp.o.d"
+  "/root/repo/src/compression/functions/omitOptionalTags.cpp" "CMakeFiles/compressor_objects.dir/src/compression/functions/omitOptionalTags.cpp.o" "gcc" "CMakeFiles/compressor_objects.dir/src/compression/functions/omitOptionalTags.cpp.o.d"
+  "/root/repo/src/compression/functions/optimizeAttributes.cpp" "CMakeFiles/compressor_objects.dir/src/compression/functions/optimizeAttributes.cpp.o" "gcc" "CMakeFiles/compressor_objects.dir/src/compression/functions/optimizeAttributes.cpp.o.d"
+  "/root/repo/src/compression/functions/optimizeCSSValues.cpp" "CMakeFiles/compressor_objects.dir/src/compression/functions/optimizeCSSValues.cpp.o" "gcc" "CMakeFiles/compressor_objects.dir/src/compression/functions/optimizeCSSValues.cpp.o.d"
+  "/root/repo/src/compression/functions/optimizeStyleBlocks.cpp" "CMakeFiles/compressor_objects.dir/src/compression/functions/optimizeStyleBlocks.cpp.o" "gcc" "CMakeFiles/compressor_objects.dir/src/compression/functions/optimizeStyleBlocks.cpp.o.d"
+  "/root/repo/src/compression/functions/pruneUnusedRules.cpp" "CMakeFiles/compressor_objects.dir/src/compression/functions/pruneUnusedRules.cpp.o" "gcc" "CMakeFiles/compressor_objects.dir/src/compression/functions/pruneUnusedRules.cpp.o.d"
+  "/root/repo/src/compression/functions/removeComments.cpp" "CMakeFiles/compressor_objects.dir/src/compression/functions/removeComments.cpp.o" "gcc" "CMakeFiles/compressor_objects.dir/src/compression/functions/removeComments.cpp.o.d"
+  "/root/repo/src/helper/explodeAlgo.cpp" "CMakeFiles/compressor_objects.dir/src/helper/explodeAlgo.cpp.o" "gcc" "CMakeFiles/compressor_objects.dir/src/helper/explodeAlgo.cpp.o.d"
+  "/root/repo/src/script/FFIBridge.cpp" "CMakeFiles/compressor_objects.dir/src/script/FFIBridge.cpp.o" "gcc" "CMakeFiles/compressor_objects.dir/src/script/FFIBridge.cpp.o.d"
+  "/root/repo/src/utils/bundlerModelAlgo.cpp" "CMakeFiles/compressor_objects.dir/src/utils/bundlerModelAlgo.cpp.o" "gcc" "CMakeFiles/compressor_objects.dir/src/utils/bundlerModelAlgo.cpp.o.d"
+  "/root/repo/src/utils/hashAlgo.cpp" "CMakeFiles/compressor_objects.dir/src/utils/hashAlgo.cpp.o" "gcc" "CMakeFiles/compressor_objects.dir/src/utils/hashAlgo.cpp.o.d"
+  "/root/repo/src/utils/nameMapAlgo.cpp" "CMakeFiles/compressor_objects.dir/src/utils/nameMapAlgo.cpp.o" "gcc" "CMakeFiles/compressor_objects.dir/src/utils/nameMapAlgo.cpp.o.d"
+  "/root/repo/src/utils/pathDataAlgo.cpp" "CMakeFiles/compressor_objects.dir/src/utils/pathDataAlgo.cpp.o" "gcc" "CMakeFiles/compressor_objects.dir/src/utils/pathDataAlgo.cpp.o.d"
+  "/root/repo/src/utils/scanAlgo.cpp" "CMakeFiles/compressor_objects.dir/src/utils/scanAlgo.cpp.o" "gcc" "CMakeFiles/compressor_objects.dir/src/utils/scanAlgo.cpp.o.d"
+  "/root/repo/src/utils/styleSheetAlgo.cpp" "CMakeFiles/compressor_objects.dir/src/utils/styleSheetAlgo.cpp.o" "gcc" "CMakeFiles/compressor_objects.dir/src/utils/styleSheetAlgo.cpp.o.d"
+  "/root/repo/src/utils/traceAlgo.cpp" "CMakeFiles/compressor_objects.dir/src/utils/traceAlgo.cpp.o" "gcc" "CMakeFiles/compressor_objects.dir/src/utils/traceAlgo.cpp.o.d"
+  "/root/repo/src/utils/trimAlgo.cpp" "CMakeFiles/compressor_objects.dir/src/utils/trimAlgo.cpp.o" "gcc" "CMakeFiles/compressor_objects.dir/src/utils/trimAlgo.cpp.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
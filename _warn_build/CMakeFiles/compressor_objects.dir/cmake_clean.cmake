@@ -0,0 +1,79 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/compressor_objects.dir/src/commands/formatCommandLineArguments.cpp.o"
+  "CMakeFiles/compressor_objects.dir/src/commands/formatCommandLineArguments.cpp.o.d"
+  "CMakeFiles/compressor_objects.dir/src/compression/BundleQueue.cpp.o"
+  "CMakeFiles/compressor_objects.dir/src/compression/BundleQueue.cpp.o.d"
+  "CMakeFiles/compressor_objects.dir/src/compression/Compressor.cpp.o"
+  "CMakeFiles/compressor_objects.dir/src/compression/Compressor.cpp.o.d"
+  "CMakeFiles/compressor_objects.dir/src/compression/CompressorImpl.cpp.o"
+  "CMakeFiles/compressor_objects.dir/src/compression/CompressorImpl.cpp.o.d"
+  "CMakeFiles/compressor_objects.dir/src/compression/CostModel.cpp.o"
+  "CMakeFiles/compressor_objects.dir/src/compression/CostModel.cpp.o.d"
+  "CMakeFiles/compressor_objects.dir/src/compression/Delta.cpp.o"
+  "CMakeFiles/compressor_objects.dir/src/compression/Delta.cpp.o.d"
+  "CMakeFiles/compressor_objects.dir/src/compression/FragmentCache.cpp.o"
+  "CMakeFiles/compressor_objects.dir/src/compression/FragmentCache.cpp.o.d"
+  "CMakeFiles/compressor_objects.dir/src/compression/SharedCache.cpp.o"
+  "CMakeFiles/compressor_objects.dir/src/compression/SharedCache.cpp.o.d"
+  "CMakeFiles/compressor_objects.dir/src/compression/functions/bundleInlineScripts.cpp.o"
+  "CMakeFiles/compressor_objects.dir/src/compression/functions/bundleInlineScripts.cpp.o.d"
+  "CMakeFiles/compressor_objects.dir/src/compression/functions/canonicalizeAttributes.cpp.o"
+  "CMakeFiles/compressor_objects.dir/src/compression/functions/canonicalizeAttributes.cpp.o.d"
+  "CMakeFiles/compressor_objects.dir/src/compression/functions/collapseWhitespace.cpp.o"
+  "CMakeFiles/compressor_objects.dir/src/compression/functions/collapseWhitespace.cpp.o.d"
+  "CMakeFiles/compressor_objects.dir/src/compression/functions/dedupeInlineBlocks.cpp.o"
+  "CMakeFiles/compressor_objects.dir/src/compression/functions/dedupeInlineBlocks.cpp.o.d"
+  "CMakeFiles/compressor_objects.dir/src/compression/functions/detectMinified.cpp.o"
+  "CMakeFiles/compressor_objects.dir/src/compression/functions/detectMinified.cpp.o.d"
+  "CMakeFiles/compressor_objects.dir/src/compression/functions/mangleNames.cpp.o"
+  "CMakeFiles/compressor_objects.dir/src/compression/functions/mangleNames.cpp.o.d"
+  "CMakeFiles/compressor_objects.dir/src/compression/functions/mergeStyleRules.cpp.o"
+  "CMakeFiles/compressor_objects.dir/src/compression/functions/mergeStyleRules.cpp.o.d"
+  "CMakeFiles/compressor_objects.dir/src/compression/functions/minifyCSS.cpp.o"
+  "CMakeFiles/compressor_objects.dir/src/compression/functions/minifyCSS.cpp.o.d"
+  "CMakeFiles/compressor_objects.dir/src/compression/functions/minifyHTML.cpp.o"
+  "CMakeFiles/compressor_objects.dir/src/compression/functions/minifyHTML.cpp.o.d"
+  "CMakeFiles/compressor_objects.dir/src/compression/functions/minifyInlineSVG.cpp.o"
+  "CMakeFiles/compressor_objects.dir/src/compression/functions/minifyInlineSVG.cpp.o.d"
+  "CMakeFiles/compressor_objects.dir/src/compression/functions/minifyJS.cpp.o"
+  "CMakeFiles/compressor_objects.dir/src/compression/functions/minifyJS.cpp.o.d"
+  "CMakeFiles/compressor_objects.dir/src/compression/functions/minifyJSON.cpp.o"
+  "CMakeFiles/compressor_objects.dir/src/compression/functions/minifyJSON.cpp.o.d"
+  "CMakeFiles/compressor_objects.dir/src/compression/functions/omitOptionalTags.cpp.o"
+  "CMakeFiles/compressor_objects.dir/src/compression/functions/omitOptionalTags.cpp.o.d"
+  "CMakeFiles/compressor_objects.dir/src/compression/functions/optimizeAttributes.cpp.o"
+  "CMakeFiles/compressor_objects.dir/src/compression/functions/optimizeAttributes.cpp.o.d"
+  "CMakeFiles/compressor_objects.dir/src/compression/functions/optimizeCSSValues.cpp.o"
+  "CMakeFiles/compressor_objects.dir/src/compression/functions/optimizeCSSValues.cpp.o.d"
+  "CMakeFiles/compressor_objects.dir/src/compression/functions/optimizeStyleBlocks.cpp.o"
+  "CMakeFiles/compressor_objects.dir/src/compression/functions/optimizeStyleBlocks.cpp.o.d"
+  "CMakeFiles/compressor_objects.dir/src/compression/functions/pruneUnusedRules.cpp.o"
+  "CMakeFiles/compressor_objects.dir/src/compression/functions/pruneUnusedRules.cpp.o.d"
+  "CMakeFiles/compressor_objects.dir/src/compression/functions/removeComments.cpp.o"
+  "CMakeFiles/compressor_objects.dir/src/compression/functions/removeComments.cpp.o.d"
+  "CMakeFiles/compressor_objects.dir/src/helper/explodeAlgo.cpp.o"
+  "CMakeFiles/compressor_objects.dir/src/helper/explodeAlgo.cpp.o.d"
+  "CMakeFiles/compressor_objects.dir/src/script/FFIBridge.cpp.o"
+  "CMakeFiles/compressor_objects.dir/src/script/FFIBridge.cpp.o.d"
+  "CMakeFiles/compressor_objects.dir/src/utils/bundlerModelAlgo.cpp.o"
+  "CMakeFiles/compressor_objects.dir/src/utils/bundlerModelAlgo.cpp.o.d"
+  "CMakeFiles/compressor_objects.dir/src/utils/hashAlgo.cpp.o"
+  "CMakeFiles/compressor_objects.dir/src/utils/hashAlgo.cpp.o.d"
+  "CMakeFiles/compressor_objects.dir/src/utils/nameMapAlgo.cpp.o"
+  "CMakeFiles/compressor_objects.dir/src/utils/nameMapAlgo.cpp.o.d"
+  "CMakeFiles/compressor_objects.dir/src/utils/pathDataAlgo.cpp.o"
+  "CMakeFiles/compressor_objects.dir/src/utils/pathDataAlgo.cpp.o.d"
+  "CMakeFiles/compressor_objects.dir/src/utils/scanAlgo.cpp.o"
+  "CMakeFiles/compressor_objects.dir/src/utils/scanAlgo.cpp.o.d"
+  "CMakeFiles/compressor_objects.dir/src/utils/styleSheetAlgo.cpp.o"
+  "CMakeFiles/compressor_objects.dir/src/utils/styleSheetAlgo.cpp.o.d"
+  "CMakeFiles/compressor_objects.dir/src/utils/traceAlgo.cpp.o"
+  "CMakeFiles/compressor_objects.dir/src/utils/traceAlgo.cpp.o.d"
+  "CMakeFiles/compressor_objects.dir/src/utils/trimAlgo.cpp.o"
+  "CMakeFiles/compressor_objects.dir/src/utils/trimAlgo.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/compressor_objects.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,9 @@
+file(REMOVE_RECURSE
+  "libcompressor.a"
+  "libcompressor.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/compressor_static.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
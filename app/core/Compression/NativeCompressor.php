@@ -8,6 +8,30 @@ final class NativeCompressor
 {
    private const string ENV_LIBRARY_PATH = 'PHPSPA_COMPRESSOR_LIB';
 
+   /**
+    * Result flag: the input was already minified and only trimmed.
+    */
+   public const int FLAG_SKIPPED_MINIFIED = 1;
+
+   /**
+    * Result flag: native minifier output returned while esbuild still runs
+    * in the background; do not persist it.
+    */
+   public const int FLAG_PROVISIONAL = 2;
+
+   /**
+    * Result flag: the latency budget ran out mid-call and passes or esbuild
+    * were skipped; the output is valid but less compact.
+    */
+   public const int FLAG_DEADLINE_DEGRADED = 4;
+
+   /**
+    * Bundle job states returned by poll() and wait().
+    */
+   public const int JOB_UNKNOWN = -1;
+   public const int JOB_PENDING = 0;
+   public const int JOB_DONE = 1;
+
    private static ?bool $available = null;
 
    private static ?string $lastError = null;
@@ -16,6 +40,91 @@ final class NativeCompressor
 
    private static ?string $libraryPath = null;
 
+   /**
+    * Whether the loaded library exports the long-lived compressor handle API.
+    */
+   private static bool $supportsHandles = false;
+
+   /**
+    * Whether the loaded library exports the background bundling API.
+    */
+   private static bool $supportsBundling = false;
+
+   /**
+    * Whether the loaded library exports the delta encoding API.
+    */
+   private static bool $supportsDelta = false;
+
+   /**
+    * Whether the loaded library exports the output hash API.
+    */
+   private static bool $supportsHash = false;
+
+   /**
+    * Whether the loaded library exports the trace recording API.
+    */
+   private static bool $supportsTrace = false;
+
+   /**
+    * Whether the loaded library exports the shared cache API.
+    */
+   private static bool $supportsSharedCache = false;
+
+   /**
+    * Whether the loaded library exports the latency budget API.
+    */
+   private static bool $supportsDeadline = false;
+
+   /**
+    * Whether the loaded library exports the bundler routing stats API.
+    */
+   private static bool $supportsBundlerStats = false;
+
+   /**
+    * Whether the loaded library exports the class/id name map API.
+    */
+   private static bool $supportsNameMap = false;
+
+   /**
+    * Time allowed per handle-based compression, in microseconds; null for none.
+    */
+   private static ?int $latencyBudget = null;
+
+   /**
+    * Answer esbuild requests with cached or native output instead of waiting.
+    */
+   private static bool $asyncBundling = false;
+
+   /**
+    * Native compressor handles keyed by their options. Their buffers stay warm
+    * for the lifetime of the worker and are released on shutdown.
+    *
+    * @var array<string, \FFI\CData|null>
+    */
+   private static array $handles = [];
+
+   /**
+    * Result flags (FLAG_* bits) of the last handle-based compression.
+    */
+   private static int $lastFlags = 0;
+
+   /**
+    * 64-bit output hash (16 hex digits) of the last handle-based compression.
+    */
+   private static ?string $lastHash = null;
+
+   /**
+    * Native level (0-3) the last handle-based compression ran at.
+    */
+   private static ?int $lastLevel = null;
+
+   /**
+    * Tuning options applied to every handle (see phpspa_compressor_set_option).
+    *
+    * @var array<string, string>
+    */
+   private static array $options = [];
+
    public static function isAvailable(): bool
    {
       if (self::$available !== null) return self::$available;
@@ -28,12 +137,150 @@ final class NativeCompressor
       return self::$lastError;
    }
 
+   public static function getLastFlags(): int
+   {
+      return self::$lastFlags;
+   }
+
+   /**
+    * Native level (0-3) the last handle-based compression actually ran at;
+    * lower than requested when the latency budget forced it.
+    */
+   public static function getLastLevel(): ?int
+   {
+      return self::$lastLevel;
+   }
+
+   /**
+    * Bound the time of each handle-based compression. The library lowers
+    * the level to what its cost model predicts fits, and skips passes or
+    * esbuild runs mid-call once they would overrun. Ignored when the
+    * library has no latency budget API.
+    *
+    * @param int|null $microseconds Budget per call, or null for none
+    */
+   public static function setLatencyBudget(?int $microseconds): void
+   {
+      self::$latencyBudget = $microseconds === null ? null : max(0, $microseconds);
+   }
+
+   /**
+    * Hash of the last handle-based compression's output, computed by the
+    * native engine as it finished writing. Use it for ETags and cache keys
+    * instead of hashing the output again.
+    *
+    * @return string|null 16 hex digits, or null when the last call did not report one
+    */
+   public static function getLastHash(): ?string
+   {
+      return self::$lastHash;
+   }
+
+   /**
+    * The native 64-bit hash of any string, e.g. output served from a cache.
+    *
+    * @return string|null 16 hex digits, or null when the library has no hash API
+    */
+   public static function hash(string $content): ?string
+   {
+      if (!self::initialize() || !self::$supportsHash) return null;
+
+      return \sprintf('%016x', (int) self::invoke('phpspa_hash', $content, \strlen($content)));
+   }
+
+   /**
+    * Start recording a timeline of the native engine's work (passes,
+    * script/style blocks, esbuild runs, cache lookups) from every thread.
+    *
+    * @return bool False when the library has no trace API or a trace is already recording
+    */
+   public static function startTrace(): bool
+   {
+      if (!self::initialize() || !self::$supportsTrace) return false;
+
+      return (int) self::invoke('phpspa_trace_start') === 1;
+   }
+
+   /**
+    * Stop recording and write the timeline as Chrome trace_event JSON, for
+    * chrome://tracing or ui.perfetto.dev.
+    *
+    * @param string $path File to write
+    * @return bool False when no trace was recording or the file cannot be written
+    */
+   public static function stopTrace(string $path): bool
+   {
+      if (!self::initialize() || !self::$supportsTrace) return false;
+
+      return (int) self::invoke('phpspa_trace_stop', $path) === 1;
+   }
+
+   /**
+    * How this worker's scripts were routed between esbuild and the native
+    * minifier: decision counts (bundled, native_small, native_low_savings,
+    * explored), spawns and spawn_failures, saved_bytes (esbuild output bytes
+    * saved over the native minifier, on the runs sampled for it), and the learned spawn_ns,
+    * native_ps_per_byte, savings_ratio and threshold_bytes.
+    *
+    * @return array<string, int|float>|null Null when the library has no bundler stats API
+    */
+   public static function getBundlerStats(): ?array
+   {
+      if (!self::initialize() || !self::$supportsBundlerStats) return null;
+
+      $stats = self::$ffi->new('phpspa_bundler_stats');
+      self::invoke('phpspa_bundler_stats', \FFI::addr($stats));
+
+      return [
+         'bundled' => (int) $stats->bundled,
+         'native_small' => (int) $stats->native_small,
+         'native_low_savings' => (int) $stats->native_low_savings,
+         'explored' => (int) $stats->explored,
+         'spawns' => (int) $stats->spawns,
+         'spawn_failures' => (int) $stats->spawn_failures,
+         'saved_bytes' => (int) $stats->saved_bytes,
+         'spawn_ns' => (int) $stats->spawn_ns,
+         'native_ps_per_byte' => (int) $stats->native_ps_per_byte,
+         'savings_ratio' => (float) $stats->savings_ratio,
+         'threshold_bytes' => (int) $stats->threshold_bytes,
+      ];
+   }
+
+   /**
+    * Replace the class/id name map with a file written by exportNameMap()
+    * and freeze it, so every worker loading it mangles names alike. Load it
+    * before the first compression.
+    *
+    * @param string $path JSON map file
+    * @return bool False when the library has no name map API or the file is unreadable or malformed
+    */
+   public static function loadNameMap(string $path): bool
+   {
+      if (!self::initialize() || !self::$supportsNameMap) return false;
+
+      return (int) self::invoke('phpspa_names_load', $path) === 1;
+   }
+
+   /**
+    * Write the class/id names this worker has mangled so far, as JSON
+    * ({"classes": {"original": "short", ...}, "ids": {...}}).
+    *
+    * @param string $path File to write
+    * @return bool False when the library has no name map API or the file cannot be written
+    */
+   public static function exportNameMap(string $path): bool
+   {
+      if (!self::initialize() || !self::$supportsNameMap) return false;
+
+      return (int) self::invoke('phpspa_names_export', $path) === 1;
+   }
+
    /**
     * Compress HTML using the native shared library.
     *
     * @param string $content Content payload to compress
     * @param int $nativeLevel Native compressor level (1-3)
-    * @param string $type Content type enum['HTML', 'JS', 'CSS']
+    * @param string $type Content type enum['HTML', 'JS', 'CSS', 'JSON']
     * @param string $scope Compression scope enum['GLOBAL', 'SCOPED']
     * @param bool $useEsbuild Use esbuild for minification
     * @return string
@@ -48,6 +295,40 @@ final class NativeCompressor
       $outLen = self::$ffi->new('size_t');
       $debugOutput = self::$ffi->new('char[1024]');
 
+      self::$lastFlags = 0;
+      self::$lastHash = null;
+      self::$lastLevel = null;
+
+      $handle = self::$supportsHandles ? self::handleFor($level, $type, $scope, $useEsbuild) : null;
+
+      if ($handle !== null) {
+         $budget = self::$latencyBudget !== null && self::$supportsDeadline ? self::$latencyBudget : null;
+
+         if ($useEsbuild && self::$asyncBundling && self::$supportsBundling) {
+            // --- The cached bundled output, or the native one while esbuild fills the cache in the background ---
+            $resultPointer = self::invoke('phpspa_bundle_optimistic', $handle, $content, \strlen($content), $budget ?? -1, \FFI::addr($outLen));
+         } elseif ($budget !== null) {
+            $resultPointer = self::invoke('phpspa_compressor_run_within', $handle, $content, \strlen($content), $budget, $debugOutput, \FFI::addr($outLen));
+         } else {
+            $resultPointer = self::invoke('phpspa_compressor_run', $handle, $content, \strlen($content), $debugOutput, \FFI::addr($outLen));
+         }
+
+         if ($resultPointer === null || \FFI::isNull($resultPointer)) {
+            throw new \RuntimeException('Native compressor returned a null pointer.');
+         }
+         error_log(\FFI::string($debugOutput));
+         self::$lastFlags = (int) self::invoke('phpspa_compressor_flags', $handle);
+         if (self::$supportsHash) {
+            self::$lastHash = \sprintf('%016x', (int) self::invoke('phpspa_compressor_hash', $handle));
+         }
+         if (self::$supportsDeadline) {
+            self::$lastLevel = (int) self::invoke('phpspa_compressor_level', $handle);
+         }
+
+         // --- Borrowed from the handle's output buffer: copy it, never free it ---
+         return \FFI::string($resultPointer, $outLen->cdata ?? 0);
+      }
+
       if ($useEsbuild)
          $resultPointer = self::invoke('phpspa_compress_html_esbuild', $content, $level, $type, $scope, $debugOutput, \FFI::addr($outLen));
       else
@@ -65,11 +346,193 @@ final class NativeCompressor
       }
    }
 
+   /**
+    * Set a native tuning option on current and future handles.
+    * Ignored when the loaded library has no handle API.
+    *
+    * @param string $name Option name, e.g. 'prune_unused_css'
+    * @param string $value Option value
+    */
+   public static function setOption(string $name, string $value): void
+   {
+      self::$options[$name] = $value;
+
+      if (self::$ffi === null || !self::$supportsHandles) return;
+
+      foreach (self::$handles as $handle) {
+         if ($handle !== null) {
+            self::invoke('phpspa_compressor_set_option', $handle, $name, $value);
+         }
+      }
+   }
+
+   /**
+    * Stop blocking requests on esbuild: serve the cached bundled result, or
+    * the native result while esbuild fills the cache in the background.
+    * Tuning options and the latency budget apply as they do to blocking runs.
+    */
+   public static function setAsyncBundling(bool $enabled): void
+   {
+      self::$asyncBundling = $enabled;
+   }
+
+   /**
+    * Share compressed outputs with every process that opens the same file.
+    *
+    * @param string $path Cache file, ideally on tmpfs (e.g. /dev/shm/phpspa-cache)
+    * @param int $bytes Space for cached outputs when the file is created
+    * @return bool False when the library has no shared cache API or cannot map the file
+    */
+   public static function enableSharedCache(string $path, int $bytes): bool
+   {
+      if (!self::initialize() || !self::$supportsSharedCache) return false;
+
+      return (int) self::invoke('phpspa_shared_cache_open', $path, max(0, $bytes)) === 1;
+   }
+
+   /**
+    * Queue an esbuild job and return its ticket without waiting.
+    *
+    * @param int $nativeLevel Native compressor level (1-3)
+    * @param string $type Content type enum['JS', 'CSS']
+    * @return int|null Ticket, or null when the library has no bundling API
+    */
+   public static function submit(string $content, int $nativeLevel, string $type, string $scope): ?int
+   {
+      if (!self::initialize() || !self::$supportsBundling) return null;
+
+      $ticket = (int) self::invoke('phpspa_bundle_submit', $content, \strlen($content), max(1, min(3, $nativeLevel)), $type, $scope);
+      return $ticket === 0 ? null : $ticket;
+   }
+
+   /**
+    * State of a submitted job (JOB_* constant).
+    */
+   public static function poll(int $ticket): int
+   {
+      if (!self::initialize() || !self::$supportsBundling) return self::JOB_UNKNOWN;
+
+      return (int) self::invoke('phpspa_bundle_poll', $ticket);
+   }
+
+   /**
+    * Wait up to $timeoutMs for a submitted job (JOB_* constant).
+    */
+   public static function wait(int $ticket, int $timeoutMs): int
+   {
+      if (!self::initialize() || !self::$supportsBundling) return self::JOB_UNKNOWN;
+
+      return (int) self::invoke('phpspa_bundle_wait', $ticket, $timeoutMs);
+   }
+
+   /**
+    * Collect a finished job's output and release the ticket.
+    *
+    * @return string|null Null while the job is pending, or when the ticket is unknown or expired
+    */
+   public static function take(int $ticket): ?string
+   {
+      if (!self::initialize() || !self::$supportsBundling) return null;
+
+      $outLen = self::$ffi->new('size_t');
+      $flags = self::$ffi->new('uint32_t');
+      $debugOutput = self::$ffi->new('char[1024]');
+
+      $resultPointer = self::invoke('phpspa_bundle_take', $ticket, $debugOutput, \FFI::addr($flags), \FFI::addr($outLen));
+      if ($resultPointer === null || \FFI::isNull($resultPointer)) return null;
+
+      error_log(\FFI::string($debugOutput));
+      self::$lastFlags = (int) $flags->cdata;
+
+      try {
+         return \FFI::string($resultPointer, $outLen->cdata ?? 0);
+      } finally {
+         self::invoke('phpspa_free_string', $resultPointer);
+      }
+   }
+
+   /**
+    * Patch that turns $base (the output the client already has) into
+    * $target. Compare its length with $target's before sending it.
+    *
+    * @return string|null Null when the library has no delta API
+    */
+   public static function encodeDelta(string $base, string $target): ?string
+   {
+      if (!self::initialize() || !self::$supportsDelta) return null;
+
+      $outLen = self::$ffi->new('size_t');
+      $resultPointer = self::invoke('phpspa_delta_encode', $base, \strlen($base), $target, \strlen($target), \FFI::addr($outLen));
+      if ($resultPointer === null || \FFI::isNull($resultPointer)) return null;
+
+      try {
+         return \FFI::string($resultPointer, $outLen->cdata ?? 0);
+      } finally {
+         self::invoke('phpspa_free_string', $resultPointer);
+      }
+   }
+
+   /**
+    * Rebuild the target of a patch from its base (reference applier).
+    *
+    * @return string|null Null when the patch is malformed, was made for another base, or the library has no delta API
+    */
+   public static function applyDelta(string $base, string $patch): ?string
+   {
+      if (!self::initialize() || !self::$supportsDelta) return null;
+
+      $outLen = self::$ffi->new('size_t');
+      $resultPointer = self::invoke('phpspa_delta_apply', $base, \strlen($base), $patch, \strlen($patch), \FFI::addr($outLen));
+      if ($resultPointer === null || \FFI::isNull($resultPointer)) return null;
+
+      try {
+         return \FFI::string($resultPointer, $outLen->cdata ?? 0);
+      } finally {
+         self::invoke('phpspa_free_string', $resultPointer);
+      }
+   }
+
    public static function getLibraryPath(): ?string
    {
       return self::$libraryPath;
    }
 
+   /**
+    * Destroy every native compressor handle created by this process.
+    */
+   public static function releaseHandles(): void
+   {
+      foreach (self::$handles as $handle) {
+         if ($handle !== null) {
+            self::invoke('phpspa_compressor_destroy', $handle);
+         }
+      }
+
+      self::$handles = [];
+   }
+
+   private static function handleFor(int $level, string $type, string $scope, bool $useEsbuild): ?\FFI\CData
+   {
+      $key = $level . ':' . $type . ':' . $scope . ':' . (int) $useEsbuild;
+
+      if (!\array_key_exists($key, self::$handles)) {
+         if (self::$handles === []) {
+            \register_shutdown_function([self::class, 'releaseHandles']);
+         }
+
+         $handle = self::invoke('phpspa_compressor_create', $level, $type, $scope, (int) $useEsbuild);
+         self::$handles[$key] = ($handle === null || \FFI::isNull($handle)) ? null : $handle;
+
+         foreach (self::$options as $name => $value) {
+            if (self::$handles[$key] !== null) {
+               self::invoke('phpspa_compressor_set_option', self::$handles[$key], $name, $value);
+            }
+         }
+      }
+
+      return self::$handles[$key];
+   }
+
    private static function initialize(): bool
    {
       if (self::$ffi !== null) {
@@ -89,15 +552,45 @@ final class NativeCompressor
          return false;
       }
 
-      try {
-         self::$ffi = \FFI::cdef(self::cDefinition(), $libraryPath);
+      // --- Each tier adds the functions of a later library release; load the newest the library exports ---
+      $tiers = [
+         self::cDefinition(),
+         self::handleCDefinition(),
+         self::bundleCDefinition(),
+         self::deltaCDefinition(),
+         self::hashCDefinition(),
+         self::traceCDefinition(),
+         self::sharedCacheCDefinition(),
+         self::deadlineCDefinition(),
+         self::bundlerStatsCDefinition(),
+         self::nameMapCDefinition(),
+      ];
+      $error = null;
+
+      for ($count = \count($tiers); $count > 0; $count--) {
+         try {
+            self::$ffi = \FFI::cdef(\implode('', \array_slice($tiers, 0, $count)), $libraryPath);
+         } catch (\Throwable $e) {
+            $error = $e;
+            continue;
+         }
+
+         self::$supportsHandles = $count > 1;
+         self::$supportsBundling = $count > 2;
+         self::$supportsDelta = $count > 3;
+         self::$supportsHash = $count > 4;
+         self::$supportsTrace = $count > 5;
+         self::$supportsSharedCache = $count > 6;
+         self::$supportsDeadline = $count > 7;
+         self::$supportsBundlerStats = $count > 8;
+         self::$supportsNameMap = $count > 9;
          self::$libraryPath = $libraryPath;
          return true;
-      } catch (\Throwable $e) {
-         self::$ffi = null;
-         self::$lastError = 'FFI failed to load ' . $libraryPath . ': ' . $e->getMessage();
-         return false;
       }
+
+      self::$ffi = null;
+      self::$lastError = 'FFI failed to load ' . $libraryPath . ': ' . $error?->getMessage();
+      return false;
    }
 
    private static function resolveLibraryPath(): ?string
@@ -156,6 +649,106 @@ final class NativeCompressor
 char* phpspa_compress_html(const char* input, int level, const char* type, size_t* out_len);
 char* phpspa_compress_html_esbuild(const char* input, int level, const char* type, const char* scope, char* debugOutput, size_t* out_len);
 void phpspa_free_string(char* buffer);
+CDEF;
+   }
+
+   private static function handleCDefinition(): string
+   {
+      return <<<'CDEF'
+
+typedef struct phpspa_compressor phpspa_compressor;
+phpspa_compressor* phpspa_compressor_create(int level, const char* type, const char* scope, int use_esbuild);
+const char* phpspa_compressor_run(phpspa_compressor* handle, const char* input, size_t input_len, char* debugOutput, size_t* out_len);
+uint32_t phpspa_compressor_flags(const phpspa_compressor* handle);
+int phpspa_compressor_set_option(phpspa_compressor* handle, const char* name, const char* value);
+void phpspa_compressor_destroy(phpspa_compressor* handle);
+CDEF;
+   }
+
+   private static function bundleCDefinition(): string
+   {
+      return <<<'CDEF'
+
+uint64_t phpspa_bundle_submit(const char* input, size_t input_len, int level, const char* type, const char* scope);
+int phpspa_bundle_poll(uint64_t ticket);
+int phpspa_bundle_wait(uint64_t ticket, int timeout_ms);
+char* phpspa_bundle_take(uint64_t ticket, char* debugOutput, uint32_t* flags, size_t* out_len);
+const char* phpspa_bundle_optimistic(phpspa_compressor* handle, const char* input, size_t input_len, int64_t budget_us, size_t* out_len);
+CDEF;
+   }
+
+   private static function deltaCDefinition(): string
+   {
+      return <<<'CDEF'
+
+char* phpspa_delta_encode(const char* base, size_t base_len, const char* target, size_t target_len, size_t* out_len);
+char* phpspa_delta_apply(const char* base, size_t base_len, const char* patch, size_t patch_len, size_t* out_len);
+CDEF;
+   }
+
+   private static function hashCDefinition(): string
+   {
+      return <<<'CDEF'
+
+uint64_t phpspa_compressor_hash(const phpspa_compressor* handle);
+uint64_t phpspa_hash(const char* data, size_t data_len);
+CDEF;
+   }
+
+   private static function traceCDefinition(): string
+   {
+      return <<<'CDEF'
+
+int phpspa_trace_start(void);
+int phpspa_trace_stop(const char* path);
+CDEF;
+   }
+
+   private static function sharedCacheCDefinition(): string
+   {
+      return <<<'CDEF'
+
+int phpspa_shared_cache_open(const char* path, size_t heap_bytes);
+CDEF;
+   }
+
+   private static function deadlineCDefinition(): string
+   {
+      return <<<'CDEF'
+
+const char* phpspa_compressor_run_within(phpspa_compressor* handle, const char* input, size_t input_len, int64_t budget_us, char* debugOutput, size_t* out_len);
+int phpspa_compressor_level(const phpspa_compressor* handle);
+CDEF;
+   }
+
+   private static function bundlerStatsCDefinition(): string
+   {
+      return <<<'CDEF'
+
+typedef struct phpspa_bundler_stats {
+   uint64_t bundled;
+   uint64_t native_small;
+   uint64_t native_low_savings;
+   uint64_t explored;
+   uint64_t spawns;
+   uint64_t spawn_failures;
+   int64_t saved_bytes;
+   int64_t spawn_ns;
+   int64_t native_ps_per_byte;
+   double savings_ratio;
+   uint64_t threshold_bytes;
+} phpspa_bundler_stats;
+
+void phpspa_bundler_stats(phpspa_bundler_stats* out);
+CDEF;
+   }
+
+   private static function nameMapCDefinition(): string
+   {
+      return <<<'CDEF'
+
+int phpspa_names_load(const char* path);
+int phpspa_names_export(const char* path);
 CDEF;
    }
 }
@@ -12,6 +12,7 @@ use PhpSPA\Core\Router\MapRoute;
 use PhpSPA\Core\Router\PrefixRouter;
 use PhpSPA\Core\Http\HttpRequest;
 use PhpSPA\Compression\Compressor;
+use PhpSPA\Core\Compression\NativeCompressor;
 use PhpSPA\Core\Config\CompressionConfig;
 use PhpSPA\Core\Helper\CsrfManager;
 use PhpSPA\Core\Helper\SessionHandler;
@@ -1156,7 +1157,10 @@ abstract class AppImpl implements ApplicationContract {
             if (!$isPhpSpaRequest) {
                if (!is_dir($fileDir)) mkdir($fileDir);
 
-               if ($fileName) {
+               // --- Provisional output is replaced by esbuild's once the background job finishes ---
+               $provisional = (NativeCompressor::getLastFlags() & NativeCompressor::FLAG_PROVISIONAL) !== 0;
+
+               if ($fileName && !$provisional) {
                   @file_put_contents($newName, "<?php\nreturn <<<'$assetType'\n$content\n$assetType;");
                }
             }
@@ -39,6 +39,20 @@ trait HtmlCompressor
     */
    private static string $compressionEngine = 'php';
 
+   /**
+    * Whether unused inline CSS is pruned (native engine, full pages only)
+    *
+    * @var bool
+    */
+   private static bool $pruneUnusedCss = false;
+
+   /**
+    * Whether a page's inline scripts are minified by esbuild (native engine)
+    *
+    * @var bool
+    */
+   private static bool $bundleInlineScripts = false;
+
    /**
     * Set compression level
     *
@@ -61,6 +75,238 @@ trait HtmlCompressor
       self::$useGzip = $enabled;
    }
 
+   /**
+    * Drop inline <style> rules whose selectors match nothing in the page.
+    *
+    * Only the native engine prunes, and only full documents (fragments are
+    * styled by a page it cannot see). List the classes and ids your scripts
+    * add at runtime, e.g. ['is-open', '#modal', 'js-*'].
+    *
+    * @param bool $enabled Whether to prune unused CSS
+    * @param array<string> $allowlist Classes ("name"), ids ("#id") or prefixes ("name-*") to keep
+    * @return void
+    */
+   public static function setCssPruning(bool $enabled, array $allowlist = []): void
+   {
+      self::$pruneUnusedCss = $enabled;
+      NativeCompressor::setOption('prune_unused_css', $enabled ? '1' : '0');
+      NativeCompressor::setOption('css_allowlist', implode(' ', $allowlist));
+   }
+
+   /**
+    * Minify all inline <script> blocks of a page with esbuild.
+    *
+    * The native engine collects the page's scripts and runs a single esbuild
+    * process for all of them, at LEVEL_AGGRESSIVE and above.
+    *
+    * @param bool $enabled Whether inline scripts go through esbuild
+    * @return void
+    */
+   public static function setInlineScriptBundling(bool $enabled): void
+   {
+      self::$bundleInlineScripts = $enabled;
+   }
+
+   /**
+    * Stop blocking requests on esbuild.
+    *
+    * Scripts are answered from a per-worker cache of esbuild output; on a
+    * miss the native minifier's result is served while esbuild builds the
+    * cached version in the background. Requires the native engine.
+    *
+    * @param bool $enabled Whether esbuild runs asynchronously
+    * @return void
+    */
+   public static function setAsyncBundling(bool $enabled): void
+   {
+      NativeCompressor::setAsyncBundling($enabled);
+   }
+
+   /**
+    * Keep or drop end tags the HTML parser implies (</li>, </p>, </td>, ...).
+    *
+    * Applies to the native engine at LEVEL_EXTREME and is on by default;
+    * the parsed DOM is unchanged either way.
+    *
+    * @param bool $enabled Whether to omit optional end tags
+    * @return void
+    */
+   public static function setOptionalTagOmission(bool $enabled): void
+   {
+      NativeCompressor::setOption('omit_optional_tags', $enabled ? '1' : '0');
+   }
+
+   /**
+    * Decimals kept when inline SVG path data and points are rounded.
+    *
+    * Applies to the native engine at LEVEL_EXTREME (default 3). A negative
+    * value keeps every coordinate exactly as written.
+    *
+    * @param int $decimals Decimal places (0-10), or -1 to disable rounding
+    * @return void
+    */
+   public static function setSvgPrecision(int $decimals): void
+   {
+      NativeCompressor::setOption('svg_precision', (string) max(-1, min(10, $decimals)));
+   }
+
+   /**
+    * Keep one copy of <style> blocks a page repeats byte for byte.
+    *
+    * Applies to the native engine at LEVEL_AGGRESSIVE and above. A
+    * component rendered many times repeats its inline stylesheet once per
+    * instance; with this on, only one copy is kept, placed so the cascade is
+    * unchanged. Only enable it for pages that are always replaced whole:
+    * PhpSPA navigation swaps single components, and a swapped-in component
+    * whose copy was dropped would arrive without its styles.
+    *
+    * @param bool $enabled Whether repeated <style> blocks are dropped
+    * @return void
+    */
+   public static function setInlineStyleDedupe(bool $enabled): void
+   {
+      NativeCompressor::setOption('dedupe_inline_styles', $enabled ? '1' : '0');
+   }
+
+   /**
+    * Keep one copy of inline scripts a page repeats byte for byte.
+    *
+    * Applies to the native engine at LEVEL_AGGRESSIVE and above. A
+    * component rendered many times (list items, cards) repeats its inline
+    * script once per instance; with this on, only the last copy is kept,
+    * after the markup of every instance, so it downloads, parses and runs
+    * once. Only enable it when those scripts can run once per page: scripts
+    * reading document.currentScript are always kept.
+    *
+    * @param bool $enabled Whether repeated inline scripts are dropped
+    * @return void
+    */
+   public static function setInlineScriptDedupe(bool $enabled): void
+   {
+      NativeCompressor::setOption('dedupe_inline_scripts', $enabled ? '1' : '0');
+   }
+
+   /**
+    * Cache the minified output of page fragments between requests.
+    *
+    * Elements carrying one of the marker attributes (by default the
+    * component wrapper, data-phpspa-target) are minified on their own and
+    * cached per worker by a hash of their raw markup, so a request only pays
+    * for the fragments that changed. Requires the native engine; ignored
+    * while unused CSS pruning is on, which needs the whole page.
+    *
+    * @param bool $enabled Whether fragment output is cached
+    * @param array<string> $markers Attributes marking a fragment's root element
+    * @return void
+    */
+   public static function setFragmentCache(bool $enabled, array $markers = ['data-phpspa-target']): void
+   {
+      NativeCompressor::setOption('fragment_cache', $enabled ? '1' : '0');
+      if ($markers !== []) {
+         NativeCompressor::setOption('fragment_markers', implode(' ', $markers));
+      }
+   }
+
+   /**
+    * Share compressed output between all workers of the host.
+    *
+    * Outputs are stored in a memory-mapped file that every worker opening
+    * the same path reads and fills, so a recycled worker starts warm and a
+    * page is compressed once per host rather than once per worker. The file
+    * keeps the size it was created with; delete it to resize. Requires the
+    * native engine on Linux or macOS.
+    *
+    * @param string $path Cache file, ideally on tmpfs (e.g. /dev/shm/phpspa-cache)
+    * @param int $bytes Space for cached outputs when the file is created
+    * @return bool Whether the cache is in use
+    */
+   public static function setSharedCache(string $path, int $bytes = 64 * 1024 * 1024): bool
+   {
+      return NativeCompressor::enableSharedCache($path, $bytes);
+   }
+
+   /**
+    * Bound the time spent compressing each response.
+    *
+    * The native engine picks the most aggressive level (up to the configured
+    * one) that its cost model, learned from the throughput of earlier calls,
+    * predicts to fit. It also skips passes and esbuild runs mid-call once they
+    * would overrun. NativeCompressor::getLastLevel() reports the level used.
+    * Requires the native engine.
+    *
+    * @param int|null $microseconds Budget per call, or null for none
+    * @return void
+    */
+   public static function setLatencyBudget(?int $microseconds): void
+   {
+      NativeCompressor::setLatencyBudget($microseconds);
+   }
+
+   /**
+    * Rewrite class and id names to short generated ones.
+    *
+    * Applies to the native engine at LEVEL_EXTREME. A name is rewritten the
+    * same way in class/id attributes, inline and external CSS selectors,
+    * and string literals passed to classList, querySelector(All), closest,
+    * matches, getElementById and getElementsByClassName. Names built at
+    * runtime or used by code that is not compressed must be allowlisted;
+    * entries of the unused CSS allowlist are kept as well.
+    *
+    * Without a loaded map each worker assigns names in the order it meets
+    * them, so pages and stylesheets compressed by different workers
+    * disagree. With several workers, load one map file everywhere (see
+    * NativeCompressor::loadNameMap()) before the first compression.
+    *
+    * @param bool $enabled Whether names are mangled
+    * @param array<string> $allowlist Names kept as written ("name", "#id", "prefix-*")
+    * @return void
+    */
+   public static function setNameMangling(bool $enabled, array $allowlist = []): void
+   {
+      NativeCompressor::setOption('mangle_names', $enabled ? '1' : '0');
+      NativeCompressor::setOption('mangle_allowlist', implode(' ', $allowlist));
+   }
+
+   /**
+    * Write every tag with its classes and attributes in one canonical order.
+    *
+    * Applies to the native engine at LEVEL_EXTREME. Class tokens are sorted
+    * (repeats dropped) and attributes sorted by name, so the same element
+    * written in different orders by different templates becomes the same
+    * bytes, which gzip and brotli compress better. Elements with framework
+    * directives (x-*, v-*, hx-*, wire:*, @..., :...) keep their attribute
+    * order, and class values holding template syntax ({{, ${, <?) are kept
+    * as written. Scripts comparing className strings see the sorted tokens.
+    * Only worth enabling for templates that write the same element in
+    * different orders: consistent pages gain a few bytes at most, and can
+    * grow slightly under brotli.
+    *
+    * @param bool $enabled Whether tags are canonicalized
+    * @return void
+    */
+   public static function setAttributeCanonicalization(bool $enabled): void
+   {
+      NativeCompressor::setOption('canonical_attributes', $enabled ? '1' : '0');
+   }
+
+   /**
+    * Smallest script (or page's inline scripts together) sent to esbuild.
+    *
+    * Below it the native minifier is used: a process spawn costs far more
+    * than minifying a short script natively. By default (0) the native
+    * engine learns the threshold from the spawn latency and native
+    * throughput it measures, and also skips esbuild when its expected extra
+    * savings are negligible. NativeCompressor::getBundlerStats() reports
+    * the decisions.
+    *
+    * @param int $bytes Threshold in bytes, or 0 to learn it
+    * @return void
+    */
+   public static function setBundlerMinBytes(int $bytes): void
+   {
+      NativeCompressor::setOption('bundler_min_bytes', (string) max(0, $bytes));
+   }
+
    /**
     * Compress HTML content
     *
@@ -93,7 +339,7 @@ trait HtmlCompressor
 -->\n";
 
       // Apply minification based on compression level
-      $html = self::minify($html, 'HTML', self::$compressionLevel);
+      $html = self::minify($html, 'HTML', self::$compressionLevel, 'global', self::$bundleInlineScripts);
 
       // Append Comments
       $html = $comment . $html;
@@ -108,7 +354,7 @@ trait HtmlCompressor
     * Minify HTML content
     *
     * @param string $content HTML content
-    * @param string $type Content type enum['HTML', 'JS', 'CSS']
+    * @param string $type Content type enum['HTML', 'JS', 'CSS', 'JSON']
     * @param int $level Compression level
     * @param string $scope Compression scope enum['GLOBAL', 'SCOPED']
     * @return string Minified HTML
@@ -117,8 +363,11 @@ trait HtmlCompressor
    {
       if ($level === Compressor::LEVEL_NONE) return $content;
 
+      $useNative = self::isNativeCompressorAvailable();
+
+      // --- Pruning must see the markup inside <pre>/<code>; the native engine keeps their content verbatim ---
       $preservedBlocks = null;
-      if ($type === 'HTML') {
+      if ($type === 'HTML' && !($useNative && self::$pruneUnusedCss)) {
          [$content, $preservedBlocks] = self::protectPreformattedBlocks($content);
       }
 
@@ -126,7 +375,7 @@ trait HtmlCompressor
          $level = self::detectOptimalLevel($content);
       }
 
-      if (self::isNativeCompressorAvailable()) {
+      if ($useNative) {
          $result = self::compressWithNative($content, $level, $type, $scope, $useEsbuild);
       } else {
          // Fallback to PHP implementation
@@ -223,12 +472,15 @@ trait HtmlCompressor
     * Compress using PHP fallback
     *
     * @param string $content HTML content
-    * @param string $type Content type enum['HTML', 'JS', 'CSS']
+    * @param string $type Content type enum['HTML', 'JS', 'CSS', 'JSON']
     * @param int $level Compression level
     * @return string Compressed HTML
     */
    private static function compressWithFallback(string $content, int $level, string $type, string $scope = 'global'): string
    {
+      // --- Re-encoding through json_decode() would rewrite numbers and escapes: only the native engine minifies JSON ---
+      if ($type === 'JSON') return $content;
+
       if ($type === 'JS') $content = "<script>$content</script>";
       elseif ($type === 'CSS') $content = "<style>$content</style>";
 
@@ -375,7 +627,7 @@ trait HtmlCompressor
     * Compress component content for SPA responses
     *
     * @param string $content Component HTML content
-    * @param string $type Content type enum['HTML', 'JS', 'CSS'] 
+    * @param string $type Content type enum['HTML', 'JS', 'CSS', 'JSON'] 
     * @return string Base64 encoded compressed content
     */
    public static function compressComponent(string $content, string $type = 'HTML'): string
@@ -425,7 +677,7 @@ trait HtmlCompressor
     *
     * @param string $content Content to compress
     * @param int $level Compression level
-    * @param string $type Content type enum['HTML', 'JS', 'CSS']
+    * @param string $type Content type enum['HTML', 'JS', 'CSS', 'JSON']
     * @param string $scope Compression scope enum['GLOBAL', 'SCOPED']
     * @param bool $useEsbuild Use esbuild for minification
     * @return string Compressed content
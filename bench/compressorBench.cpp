@@ -0,0 +1,133 @@
+/**
+ * Compressor throughput benchmark and PGO training driver.
+ *
+ * Runs every file of a corpus directory through the native compressor
+ * (.html/.htm as HTML, .css as CSS, .js as JS) and reports the throughput
+ * per file and for the whole corpus. The PGO pipeline runs it once on the
+ * instrumented library to collect profiles and once per build to compare.
+ *
+ * Usage: compressor_bench --corpus <dir> [--level 0-3] [--iterations N] [--runs N]
+ *
+ * With --runs, each file is timed N times and the fastest run is reported,
+ * which keeps comparisons between builds stable on a noisy machine.
+ */
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+#include "../src/commands/formatCommandLineArguments.hh"
+#include "../src/compression/Compressor.h"
+
+namespace {
+
+   struct CorpusFile {
+      std::string name;
+      phpspa::ContentType type;
+      std::string content;
+   };
+
+   std::optional<phpspa::ContentType> detectType(const std::filesystem::path& path) {
+      std::string extension = path.extension().string();
+      std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char ch) {
+         return static_cast<char>(std::tolower(ch));
+      });
+
+      if (extension == ".html" || extension == ".htm") return phpspa::ContentType::HTML;
+      if (extension == ".css") return phpspa::ContentType::CSS;
+      if (extension == ".js") return phpspa::ContentType::JS;
+      return std::nullopt;
+   }
+
+   std::vector<CorpusFile> loadCorpus(const std::filesystem::path& directory) {
+      std::vector<CorpusFile> files;
+
+      for (const auto& entry : std::filesystem::recursive_directory_iterator(directory)) {
+         if (!entry.is_regular_file()) continue;
+
+         const std::optional<phpspa::ContentType> type = detectType(entry.path());
+         if (!type) continue;
+
+         std::ifstream stream(entry.path(), std::ios::binary);
+         std::string content((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+         files.push_back({ entry.path().filename().string(), *type, std::move(content) });
+      }
+
+      std::sort(files.begin(), files.end(), [](const CorpusFile& a, const CorpusFile& b) {
+         return a.name < b.name;
+      });
+      return files;
+   }
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+   std::map<std::string, std::string> arguments = formatCommandLineArguments(argc, argv);
+
+   if (!arguments.contains("corpus")) {
+      std::cout << "--corpus <dir> is required" << std::endl;
+      return 1;
+   }
+
+   const std::vector<CorpusFile> corpus = loadCorpus(arguments["corpus"]);
+   if (corpus.empty()) {
+      std::cout << "No .html, .css or .js files found in " << arguments["corpus"] << std::endl;
+      return 1;
+   }
+
+   const int iterations = arguments.contains("iterations") ? std::max(1, std::stoi(arguments["iterations"])) : 200;
+   const int runs = arguments.contains("runs") ? std::max(1, std::stoi(arguments["runs"])) : 1;
+
+   std::vector<HtmlCompressor::Level> levels{ HtmlCompressor::WHITESPACE, HtmlCompressor::BASIC, HtmlCompressor::AGGRESSIVE, HtmlCompressor::EXTREME };
+   if (arguments.contains("level")) {
+      levels = { static_cast<HtmlCompressor::Level>(std::stoi(arguments["level"])) };
+   }
+
+   size_t totalBytes = 0;
+   double totalSeconds = 0.0;
+
+   std::cout << std::left << std::setw(28) << "file" << std::setw(7) << "level"
+             << std::right << std::setw(10) << "bytes" << std::setw(10) << "output" << std::setw(12) << "MB/s" << '\n';
+
+   std::string output;
+
+   for (const HtmlCompressor::Level level : levels) {
+      for (const CorpusFile& file : corpus) {
+         // --- Native paths only: the bundler would measure process spawns, not the library ---
+         phpspa::CompressorOptions options;
+         options.level = level;
+         options.type = file.type;
+         phpspa::Compressor compressor(std::move(options));
+         compressor.compress(file.content, output); // --- warm-up ---
+
+         double seconds = 0.0;
+         for (int run = 0; run < runs; ++run) {
+            const auto start = std::chrono::steady_clock::now();
+            for (int i = 0; i < iterations; ++i) {
+               compressor.compress(file.content, output);
+            }
+            const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            seconds = run == 0 ? elapsed : std::min(seconds, elapsed);
+         }
+
+         const size_t processed = file.content.size() * static_cast<size_t>(iterations);
+         totalBytes += processed;
+         totalSeconds += seconds;
+
+         std::cout << std::left << std::setw(28) << file.name << std::setw(7) << static_cast<int>(level)
+                   << std::right << std::setw(10) << file.content.size() << std::setw(10) << output.size()
+                   << std::setw(12) << std::fixed << std::setprecision(2) << (processed / 1e6) / seconds << '\n';
+      }
+   }
+
+   // --- Machine-readable summary consumed by cmake/PgoPipeline.cmake ---
+   std::cout << "TOTAL_THROUGHPUT_MBPS=" << std::fixed << std::setprecision(2) << (totalBytes / 1e6) / totalSeconds << std::endl;
+   return 0;
+}
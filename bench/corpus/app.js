@@ -0,0 +1,101 @@
+/**
+ * Client-side helpers for the PhpSPA examples.
+ *
+ * This file is intentionally written in a verbose style so that the
+ * corpus exercises comment stripping, ASI handling and whitespace.
+ */
+
+// --- Tiny event bus shared by the widgets ---
+const bus = {
+    listeners: {},
+
+    on(event, callback) {
+        if (!this.listeners[event]) {
+            this.listeners[event] = []
+        }
+        this.listeners[event].push(callback)
+    },
+
+    emit(event, payload) {
+        const callbacks = this.listeners[event] || []
+        for (const callback of callbacks) {
+            callback(payload)
+        }
+    }
+}
+
+/* Debounce helper: delays `fn` until `wait` ms have passed without calls. */
+function debounce(fn, wait) {
+    let timer = null
+
+    return function (...args) {
+        clearTimeout(timer)
+        timer = setTimeout(() => fn.apply(this, args), wait)
+    }
+}
+
+function formatCurrency(amount, currency = "USD") {
+    return new Intl.NumberFormat("en-US", {
+        style: "currency",
+        currency: currency
+    }).format(amount)
+}
+
+function toggleRow(row) {
+    if (row.classList.contains("is-open")) {
+        row.classList.remove("is-open")
+    } else {
+        row.classList.add("is-open")
+    }
+}
+
+export function boot(root, options) {
+    const settings = Object.assign({ animate: false, delay: 150 }, options)
+    const search = root.querySelector(".c-filters input[name='q']")
+
+    if (search) {
+        search.addEventListener("input", debounce(function (event) {
+            bus.emit("search", event.target.value.trim())
+        }, settings.delay))
+    }
+
+    root.querySelectorAll(".c-table tbody tr").forEach(function (row) {
+        row.addEventListener("click", () => toggleRow(row))
+    })
+
+    bus.on("search", function (query) {
+        const rows = root.querySelectorAll(".c-table tbody tr")
+        let visible = 0
+
+        rows.forEach((row) => {
+            const matches = row.textContent.toLowerCase().indexOf(query.toLowerCase()) !== -1
+            row.hidden = !matches
+            if (matches) visible++
+        })
+
+        const counter = document.getElementById("result-count")
+        if (counter) {
+            counter.textContent = visible + " of " + rows.length + " orders"
+        }
+    })
+
+    try {
+        const total = Array.from(root.querySelectorAll("[data-amount]"))
+            .map((cell) => parseFloat(cell.dataset.amount))
+            .reduce((sum, value) => sum + value, 0)
+
+        bus.emit("total", formatCurrency(total))
+    } catch (error) {
+        console.warn("Could not compute total", error)
+    } finally {
+        if (settings.animate) {
+            root.classList.add("is-animated")
+        }
+    }
+
+    const pattern = /\s+/g
+    return {
+        normalize: (text) => text.replace(pattern, " "),
+        template: `Rendered ${new Date().toISOString()}`
+    }
+}
@@ -0,0 +1 @@
+/*! micro-dom v1.4.2 | MIT */!function(t,e){"object"==typeof exports&&"undefined"!=typeof module?module.exports=e():"function"==typeof define&&define.amd?define(e):(t="undefined"!=typeof globalThis?globalThis:t||self).microDom=e()}(this,function(){"use strict";function t(t,e){return(e||document).querySelector(t)}function e(t,e){return Array.prototype.slice.call((e||document).querySelectorAll(t))}function n(t,e,n,r){t.addEventListener(e,function(t){var e=t.target.closest(n);e&&r.call(e,t)})}function r(t,e){var n=new XMLHttpRequest;return new Promise(function(r,o){n.open("GET",t),n.onload=function(){n.status>=200&&n.status<300?r(e?JSON.parse(n.responseText):n.responseText):o(new Error(n.statusText))},n.onerror=function(){o(new Error("Network error"))},n.send()})}function o(t,e){var n;return function(){var r=this,o=arguments;clearTimeout(n),n=setTimeout(function(){t.apply(r,o)},e)}}return{$:t,$$:e,on:n,get:r,debounce:o,version:"1.4.2"}});
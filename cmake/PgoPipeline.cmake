@@ -0,0 +1,133 @@
+# Profile-guided + LTO build pipeline for the compressor library.
+#
+# Driven by the pgo-* targets (configure with -DPHPSPA_PGO=ON):
+#   pgo-baseline    Release build as shipped today, measured on the corpus
+#   pgo-instrument  Release build with -fprofile-generate
+#   pgo-train       runs compressor_bench over the corpus to collect profiles
+#   pgo-optimize    rebuilds with -fprofile-use and LTO, measured on the corpus
+#   pgo             prints the throughput difference
+#
+# Usage: cmake -DSTEP=<step> -DSOURCE_DIR=... -DWORK_DIR=... -DCORPUS_DIR=... -P PgoPipeline.cmake
+
+set(BASELINE_DIR "${WORK_DIR}/baseline")
+set(OPTIMIZED_DIR "${WORK_DIR}/optimized")
+set(PROFILE_DIR "${WORK_DIR}/profile")
+
+# --- Iterations per file and level when measuring / training ---
+set(MEASURE_ITERATIONS 300)
+set(TRAIN_ITERATIONS 50)
+
+function(pgo_configure dir)
+   execute_process(
+      COMMAND ${CMAKE_COMMAND} -S ${SOURCE_DIR} -B ${dir} -G ${GENERATOR}
+         -DCMAKE_BUILD_TYPE=Release
+         -DCMAKE_CXX_COMPILER=${CXX_COMPILER}
+         -DPHPSPA_PGO=OFF
+         -DPHPSPA_BUILD_BENCH=ON
+         -DPHPSPA_PGO_PROFILE_DIR=${PROFILE_DIR}
+         ${ARGN}
+      RESULT_VARIABLE result
+   )
+   if(NOT result EQUAL 0)
+      message(FATAL_ERROR "Configuring ${dir} failed")
+   endif()
+endfunction()
+
+function(pgo_build dir)
+   execute_process(
+      COMMAND ${CMAKE_COMMAND} --build ${dir} --target compressor_bench --parallel
+      RESULT_VARIABLE result
+   )
+   if(NOT result EQUAL 0)
+      message(FATAL_ERROR "Building ${dir} failed")
+   endif()
+endfunction()
+
+# --- Runs the bench driver and stores TOTAL_THROUGHPUT_MBPS in <result_file> ---
+function(pgo_run_bench dir iterations result_file)
+   execute_process(
+      COMMAND ${dir}/compressor_bench --corpus ${CORPUS_DIR} --iterations ${iterations}
+      OUTPUT_VARIABLE output
+      RESULT_VARIABLE result
+   )
+   if(NOT result EQUAL 0)
+      message(FATAL_ERROR "compressor_bench failed in ${dir}:\n${output}")
+   endif()
+
+   message("${output}")
+   if(result_file)
+      string(REGEX MATCH "TOTAL_THROUGHPUT_MBPS=([0-9.]+)" _ "${output}")
+      file(WRITE ${result_file} "${CMAKE_MATCH_1}")
+   endif()
+endfunction()
+
+if(STEP STREQUAL "baseline")
+   pgo_configure(${BASELINE_DIR} -DPHPSPA_PGO_PHASE= -DPHPSPA_ENABLE_LTO=OFF)
+   pgo_build(${BASELINE_DIR})
+   pgo_run_bench(${BASELINE_DIR} ${MEASURE_ITERATIONS} ${WORK_DIR}/baseline.txt)
+
+elseif(STEP STREQUAL "instrument")
+   file(REMOVE_RECURSE ${PROFILE_DIR})
+   file(MAKE_DIRECTORY ${PROFILE_DIR})
+   pgo_configure(${OPTIMIZED_DIR} -DPHPSPA_PGO_PHASE=GENERATE -DPHPSPA_ENABLE_LTO=OFF)
+   pgo_build(${OPTIMIZED_DIR})
+
+elseif(STEP STREQUAL "train")
+   pgo_run_bench(${OPTIMIZED_DIR} ${TRAIN_ITERATIONS} "")
+
+elseif(STEP STREQUAL "optimize")
+   # --- Clang writes raw profiles that must be merged before -fprofile-use ---
+   if(CXX_COMPILER_ID MATCHES "Clang")
+      find_program(LLVM_PROFDATA NAMES llvm-profdata)
+      if(NOT LLVM_PROFDATA)
+         message(FATAL_ERROR "llvm-profdata is required to merge Clang profiles")
+      endif()
+
+      file(GLOB raw_profiles "${PROFILE_DIR}/*.profraw")
+      execute_process(
+         COMMAND ${LLVM_PROFDATA} merge -output=${PROFILE_DIR}/default.profdata ${raw_profiles}
+         RESULT_VARIABLE result
+      )
+      if(NOT result EQUAL 0)
+         message(FATAL_ERROR "Merging Clang profiles failed")
+      endif()
+   endif()
+
+   # --- Same build tree as the instrumented build so GCC finds its .gcda files ---
+   pgo_configure(${OPTIMIZED_DIR} -DPHPSPA_PGO_PHASE=USE -DPHPSPA_ENABLE_LTO=ON)
+   pgo_build(${OPTIMIZED_DIR})
+   pgo_run_bench(${OPTIMIZED_DIR} ${MEASURE_ITERATIONS} ${WORK_DIR}/optimized.txt)
+
+elseif(STEP STREQUAL "report")
+   file(READ ${WORK_DIR}/baseline.txt baseline)
+   file(READ ${WORK_DIR}/optimized.txt optimized)
+
+   if(baseline STREQUAL "" OR optimized STREQUAL "")
+      message(FATAL_ERROR "Missing throughput results, run pgo-baseline and pgo-optimize first")
+   endif()
+
+   # --- CMake math is integer only: compare in hundredths of a percent ---
+   string(REPLACE "." "" baseline_scaled "${baseline}")
+   string(REPLACE "." "" optimized_scaled "${optimized}")
+   math(EXPR gain "(${optimized_scaled} - ${baseline_scaled}) * 10000 / ${baseline_scaled}")
+   set(gain_sign "+")
+   if(gain LESS 0)
+      set(gain_sign "-")
+      math(EXPR gain "0 - ${gain}")
+   endif()
+   math(EXPR gain_whole "${gain} / 100")
+   math(EXPR gain_fraction "${gain} % 100")
+   if(gain_fraction LESS 10)
+      set(gain_fraction "0${gain_fraction}")
+   endif()
+
+   message("")
+   message("PGO + LTO pipeline results (corpus: ${CORPUS_DIR})")
+   message("  Baseline Release : ${baseline} MB/s")
+   message("  PGO + LTO        : ${optimized} MB/s")
+   message("  Throughput change: ${gain_sign}${gain_whole}.${gain_fraction}%")
+   message("  Optimized library: ${OPTIMIZED_DIR}")
+
+else()
+   message(FATAL_ERROR "Unknown PGO step '${STEP}'")
+endif()
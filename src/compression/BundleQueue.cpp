@@ -0,0 +1,244 @@
+#include "BundleQueue.h"
+#include "SharedCache.h"
+#include "../utils/trace.h"
+
+#include <cstdlib>
+
+namespace phpspa {
+
+   namespace {
+
+      // --- The options as a whole (a page's pruning, tag omission or mangling shape its bundled output too), then the input ---
+      std::string makeCacheKey(const CompressorOptions& options, std::string_view input) {
+         std::string key = SharedCache::shapeOf(options);
+         key.reserve(key.size() + input.size() + 1);
+         key += '\x1E';
+         key.append(input.data(), input.size());
+         return key;
+      }
+
+      // --- Only JS and HTML (inline scripts) at AGGRESSIVE/EXTREME reach the bundler; CSS is fast enough inline ---
+      bool usesBundler(const CompressorOptions& options) {
+         return options.useBundler && options.type != ContentType::CSS && options.level >= HtmlCompressor::AGGRESSIVE;
+      }
+
+      // --- The native minifier's answer, within the caller's latency budget when it has one ---
+      CompressResult compressNative(std::string_view in, std::string& out, const CompressorOptions& options, int64_t budgetMicros) {
+         Compressor compressor(options);
+         return budgetMicros < 0 ? compressor.compress(in, out) : compressor.compressWithin(in, out, budgetMicros);
+      }
+
+      size_t resultBytes(const BundleResult& result) {
+         return result.output.size() + result.debug.size();
+      }
+
+   } // namespace
+
+   BundleQueue& BundleQueue::instance() {
+      // --- Never destroyed: a worker detached inside an esbuild run still uses it when the run ends ---
+      static BundleQueue* const queue = new BundleQueue();
+      static const bool stopsAtExit = std::atexit([] { queue->shutdown(); }) == 0;
+      (void) stopsAtExit;
+      return *queue;
+   }
+
+   void BundleQueue::shutdown() {
+      std::unique_lock<std::mutex> lock(mutex);
+      stopping = true;
+      queue.clear();
+      jobQueued.notify_all();
+
+#ifdef _WIN32
+      // --- At DLL detach the process has already ended the workers; waiting would deadlock ---
+      const bool idle = false;
+#else
+      // --- An esbuild run can take up to 20 s; exit does not wait for it ---
+      const bool idle = jobFinished.wait_for(lock, kShutdownGrace, [&] { return busyWorkers == 0; });
+#endif
+      std::vector<std::thread> stopped = std::move(workers);
+      lock.unlock();
+
+      for (std::thread& worker : stopped) {
+         if (idle) {
+            worker.join();
+         } else {
+            worker.detach();
+         }
+      }
+   }
+
+   uint64_t BundleQueue::submit(std::string input, CompressorOptions options) {
+      uint64_t ticket = 0;
+      {
+         std::lock_guard<std::mutex> lock(mutex);
+         ensureWorkers();
+         expireFinished(std::chrono::steady_clock::now());
+         ticket = nextTicket++;
+         pending.insert(ticket);
+         queue.push_back({ ticket, std::move(input), std::move(options), std::string() });
+      }
+      jobQueued.notify_one();
+      return ticket;
+   }
+
+   JobState BundleQueue::poll(uint64_t ticket) {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (finished.contains(ticket)) return JobState::DONE;
+      return pending.contains(ticket) ? JobState::PENDING : JobState::UNKNOWN;
+   }
+
+   JobState BundleQueue::wait(uint64_t ticket, std::chrono::milliseconds timeout) {
+      TraceSpan span("bundle wait");
+      std::unique_lock<std::mutex> lock(mutex);
+      jobFinished.wait_for(lock, timeout, [&] { return !pending.contains(ticket); });
+      span.arg("done", finished.contains(ticket));
+
+      if (finished.contains(ticket)) return JobState::DONE;
+      return pending.contains(ticket) ? JobState::PENDING : JobState::UNKNOWN;
+   }
+
+   bool BundleQueue::take(uint64_t ticket, BundleResult& result) {
+      std::lock_guard<std::mutex> lock(mutex);
+      const auto job = finished.find(ticket);
+      if (job == finished.end()) return false;
+
+      finishedBytes -= resultBytes(job->second.result);
+      result = std::move(job->second.result);
+      finished.erase(job);
+      return true;
+   }
+
+   CompressResult BundleQueue::compressOptimistic(std::string_view in, std::string& out, const CompressorOptions& options, int64_t budgetMicros) {
+      if (!usesBundler(options)) return compressNative(in, out, options, budgetMicros);
+
+      std::string key = makeCacheKey(options, in);
+      {
+         TraceSpan span("bundle cache lookup", static_cast<int64_t>(in.size()));
+         std::lock_guard<std::mutex> lock(mutex);
+         const auto hit = cache.find(key);
+         span.arg("hit", hit != cache.end());
+         if (hit != cache.end()) {
+            out = hit->second.output;
+            return hit->second.result;
+         }
+      }
+
+      // --- A bundled result another worker process filled ---
+      SharedCache& sharedCache = SharedCache::instance();
+      if (sharedCache.isOpen()) {
+         TraceSpan span("shared cache lookup", static_cast<int64_t>(in.size()));
+         CompressResult shared;
+         shared.level = options.level;
+         const bool hit = sharedCache.find(SharedCache::keyOf(options, in), out, shared);
+         span.arg("hit", hit);
+         if (hit) return shared;
+      }
+
+      CompressorOptions nativeOptions = options;
+      nativeOptions.useBundler = false;
+      CompressResult result = compressNative(in, out, nativeOptions, budgetMicros);
+
+      // --- The bundler skips minified input too: the native answer is final ---
+      if (result.flags & SKIPPED_MINIFIED) return result;
+
+      {
+         std::lock_guard<std::mutex> lock(mutex);
+         if (!filling.contains(key)) {
+            ensureWorkers();
+            filling.insert(key);
+            queue.push_back({ 0, std::string(in), options, std::move(key) });
+            jobQueued.notify_one();
+         }
+      }
+
+      result.flags |= PROVISIONAL;
+      return result;
+   }
+
+   // --- Caller holds the mutex ---
+   void BundleQueue::ensureWorkers() {
+      if (!workers.empty() || stopping) return;
+      for (size_t i = 0; i < kWorkerCount; ++i) {
+         workers.emplace_back(&BundleQueue::workerLoop, this);
+      }
+   }
+
+   void BundleQueue::workerLoop() {
+      for (;;) {
+         Job job;
+         {
+            std::unique_lock<std::mutex> lock(mutex);
+            jobQueued.wait(lock, [&] { return stopping || !queue.empty(); });
+            if (stopping) return;
+
+            job = std::move(queue.front());
+            queue.pop_front();
+            ++busyWorkers;
+         }
+
+         BundleResult done;
+         char debugOutput[1024] = {};
+         bool succeeded = true;
+         try {
+            Compressor compressor(job.options);
+            done.result = compressor.compress(job.input, done.output, debugOutput);
+         } catch (...) {
+            succeeded = false;
+            done.output = std::move(job.input);
+         }
+         done.debug = succeeded ? debugOutput : "Compression failed, returning the input unchanged";
+
+         {
+            std::lock_guard<std::mutex> lock(mutex);
+            --busyWorkers;
+            if (!job.cacheKey.empty()) {
+               filling.erase(job.cacheKey);
+               if (succeeded) storeInCache(std::move(job.cacheKey), std::move(done.output), done.result);
+            } else {
+               const auto now = std::chrono::steady_clock::now();
+               pending.erase(job.ticket);
+               finishedBytes += resultBytes(done);
+               finished.emplace(job.ticket, FinishedJob{ std::move(done), now });
+               finishedOrder.push_back(job.ticket);
+               expireFinished(now);
+            }
+         }
+         jobFinished.notify_all();
+      }
+   }
+
+   // --- Caller holds the mutex ---
+   void BundleQueue::expireFinished(std::chrono::steady_clock::time_point now) {
+      while (!finishedOrder.empty()) {
+         const auto job = finished.find(finishedOrder.front());
+         if (job != finished.end()) {
+            // --- The newest result stays until its time is up, however large ---
+            const bool overBudget = finishedBytes > kFinishedBytes && finished.size() > 1;
+            if (now - job->second.finishedAt < kFinishedTtl && !overBudget) return;
+            finishedBytes -= resultBytes(job->second.result);
+            finished.erase(job);
+         }
+         finishedOrder.pop_front();
+      }
+   }
+
+   // --- Caller holds the mutex ---
+   void BundleQueue::storeInCache(std::string key, std::string output, CompressResult result) {
+      const size_t entryBytes = key.size() + output.size();
+      if (entryBytes > kCacheBytes) return;
+
+      while (cacheBytes + entryBytes > kCacheBytes && !cacheOrder.empty()) {
+         const auto oldest = cache.find(*cacheOrder.front());
+         cacheBytes -= oldest->first.size() + oldest->second.output.size();
+         cache.erase(oldest);
+         cacheOrder.pop_front();
+      }
+
+      const auto [entry, inserted] = cache.emplace(std::move(key), CacheEntry{ std::move(output), result });
+      if (!inserted) return;
+
+      cacheBytes += entryBytes;
+      cacheOrder.push_back(&entry->first);
+   }
+
+} // namespace phpspa
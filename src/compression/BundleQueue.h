@@ -0,0 +1,130 @@
+#ifndef PHPSPA_BUNDLE_QUEUE_H
+#define PHPSPA_BUNDLE_QUEUE_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "Compressor.h"
+
+namespace phpspa {
+
+   enum class JobState {
+      PENDING,
+      DONE,
+      UNKNOWN // --- never submitted, already taken, or expired untaken ---
+   };
+
+   struct BundleResult {
+      std::string output;
+      CompressResult result;
+      std::string debug; // --- bundler diagnostics ---
+   };
+
+   /**
+    * Runs bundler jobs (esbuild can take seconds) on background threads.
+    *
+    * submit() returns a ticket immediately; poll(), wait() and take() collect
+    * the result. compressOptimistic() never waits: it answers with a cached
+    * bundled result, or with the native minifier's output while a background
+    * job bundles the same input into the cache for the next call.
+    *
+    * A finished job's result is kept for kFinishedTtl, and finished results
+    * together for at most kFinishedBytes (oldest dropped first); a ticket
+    * never taken is forgotten after that.
+    *
+    * One process-wide instance, safe to use from any thread. At exit, queued
+    * jobs are dropped and a job still running gets kShutdownGrace to finish
+    * before its worker is detached.
+    */
+   class BundleQueue {
+      public:
+         static BundleQueue& instance();
+
+         BundleQueue(const BundleQueue&) = delete;
+         BundleQueue& operator=(const BundleQueue&) = delete;
+
+         /**
+          * Queue a compression job
+          * @return Ticket for poll/wait/take (never 0)
+          */
+         uint64_t submit(std::string input, CompressorOptions options);
+
+         JobState poll(uint64_t ticket);
+
+         // --- Block until the job finishes or the timeout elapses ---
+         JobState wait(uint64_t ticket, std::chrono::milliseconds timeout);
+
+         // --- Move a finished job's result out and forget the ticket; false while pending, unknown or expired ---
+         bool take(uint64_t ticket, BundleResult& result);
+
+         /**
+          * Compress without waiting for the bundler
+          * @param options Options of the bundled result (useBundler is honored)
+          * @param budgetMicros Latency budget of the native answer, as Compressor::compressWithin; negative for none
+          * @return Flags of the returned output; PROVISIONAL when it is the native fallback
+          */
+         CompressResult compressOptimistic(std::string_view in, std::string& out, const CompressorOptions& options, int64_t budgetMicros = -1);
+
+      private:
+         struct Job {
+            uint64_t ticket;
+            std::string input;
+            CompressorOptions options;
+            std::string cacheKey; // --- set for cache fills, which have no owner to take them ---
+         };
+
+         struct FinishedJob {
+            BundleResult result;
+            std::chrono::steady_clock::time_point finishedAt;
+         };
+
+         static constexpr size_t kWorkerCount = 2;
+         static constexpr size_t kCacheBytes = 16 * 1024 * 1024;
+         static constexpr size_t kFinishedBytes = 64 * 1024 * 1024;
+         static constexpr std::chrono::seconds kFinishedTtl{ 60 };
+         static constexpr std::chrono::milliseconds kShutdownGrace{ 200 };
+
+         BundleQueue() = default;
+
+         void ensureWorkers();
+         void workerLoop();
+         void shutdown();
+         void expireFinished(std::chrono::steady_clock::time_point now);
+         void storeInCache(std::string key, std::string output, CompressResult result);
+
+         std::mutex mutex;
+         std::condition_variable jobQueued;
+         std::condition_variable jobFinished;
+         std::deque<Job> queue;
+         std::vector<std::thread> workers;
+         bool stopping = false;
+         size_t busyWorkers = 0;
+         uint64_t nextTicket = 1;
+
+         std::unordered_set<uint64_t> pending;
+         std::unordered_map<uint64_t, FinishedJob> finished;
+         std::deque<uint64_t> finishedOrder; // --- tickets in the order they finished; taken ones are skipped ---
+         size_t finishedBytes = 0;
+
+         // --- Optimistic mode: bundled outputs keyed by options + input, evicted oldest first ---
+         struct CacheEntry {
+            std::string output;
+            CompressResult result;
+         };
+         std::unordered_map<std::string, CacheEntry> cache;
+         std::deque<const std::string*> cacheOrder; // --- keys owned by cache, whose nodes never move ---
+         std::unordered_set<std::string> filling;
+         size_t cacheBytes = 0;
+   };
+
+} // namespace phpspa
+
+#endif // PHPSPA_BUNDLE_QUEUE_H
@@ -0,0 +1,285 @@
+#include "Compressor.h"
+#include "CostModel.h"
+#include "FragmentCache.h"
+#include "SharedCache.h"
+#include "../utils/hash.h"
+#include "../utils/nameMap.h"
+#include "../utils/styleSheet.h"
+#include "../utils/trace.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace phpspa {
+
+   namespace {
+
+      // --- Applies the options to the calling thread for the duration of one call ---
+      class SettingsScope {
+         public:
+            SettingsScope(const CompressorOptions& options, int64_t deadline, int64_t bundlerDeadline)
+               : previousLevel(HtmlCompressor::currentLevel), previousSettings(HtmlCompressor::settings) {
+               HtmlCompressor::currentLevel = options.level;
+               HtmlCompressor::settings.minifiedThreshold = options.minifiedThreshold;
+               HtmlCompressor::settings.pruneUnusedCSS = options.pruneUnusedCSS;
+               HtmlCompressor::settings.cssAllowlist = &options.cssAllowlist;
+               HtmlCompressor::settings.omitOptionalTags = options.omitOptionalTags;
+               HtmlCompressor::settings.svgPrecision = options.svgPrecision;
+               HtmlCompressor::settings.dedupeInlineStyles = options.dedupeInlineStyles;
+               HtmlCompressor::settings.dedupeInlineScripts = options.dedupeInlineScripts;
+               HtmlCompressor::settings.mangleNames = options.mangleNames;
+               HtmlCompressor::settings.canonicalizeAttributes = options.canonicalizeAttributes;
+               HtmlCompressor::settings.mangleAllowlist = &options.mangleAllowlist;
+               HtmlCompressor::settings.bundlerMinBytes = options.bundlerMinBytes;
+               HtmlCompressor::settings.deadline = deadline;
+               HtmlCompressor::settings.bundlerDeadline = bundlerDeadline;
+               HtmlCompressor::settings.degraded = false;
+               if (options.mangleNames && options.level == HtmlCompressor::EXTREME) HtmlCompressor::reserveKeptNames();
+            }
+
+            ~SettingsScope() {
+               HtmlCompressor::currentLevel = previousLevel;
+               HtmlCompressor::settings = previousSettings;
+            }
+
+            SettingsScope(const SettingsScope&) = delete;
+            SettingsScope& operator=(const SettingsScope&) = delete;
+
+         private:
+            HtmlCompressor::Level previousLevel;
+            HtmlCompressor::Settings previousSettings;
+      };
+
+      bool isMinified(ContentType type, std::string_view in) {
+         switch (type) {
+            case ContentType::HTML: return HtmlCompressor::isMinifiedHTML(in);
+            case ContentType::CSS: return HtmlCompressor::isMinifiedCSS(in);
+            case ContentType::JS: return HtmlCompressor::isMinifiedJS(in);
+            case ContentType::JSON: return false; // --- stripping runs at memory speed; no pre-scan ---
+         }
+         return false;
+      }
+
+      // --- Stands in for a fragment while the rest is compressed: a void tag no pass rewrites or treats as a follower ---
+      constexpr std::string_view kFragmentPlaceholder = "<wbr \x1A>";
+
+      // --- Whether a run with these options spawns esbuild (HTML: when the page has inline scripts) ---
+      bool runsBundler(const CompressorOptions& options) {
+         return options.useBundler && options.level >= HtmlCompressor::AGGRESSIVE && (options.type == ContentType::JS || options.type == ContentType::HTML);
+      }
+
+      bool manglesNames(const CompressorOptions& options) {
+         return options.mangleNames && options.level == HtmlCompressor::EXTREME;
+      }
+
+      // --- Options that shape a fragment's output; the page-level ones never reach fragments ---
+      uint64_t fragmentSignature(const CompressorOptions& options) {
+         const uint64_t signature = static_cast<uint64_t>(options.level) | (options.omitOptionalTags ? 1u << 2 : 0) | (options.useBundler ? 1u << 3 : 0) |
+                                    (static_cast<uint64_t>(options.svgPrecision + 1) << 4) | (options.dedupeInlineScripts ? uint64_t{ 1 } << 32 : 0) |
+                                    (options.canonicalizeAttributes ? uint64_t{ 1 } << 33 : 0) | (options.dedupeInlineStyles ? uint64_t{ 1 } << 34 : 0);
+         if (!manglesNames(options)) return signature;
+
+         // --- Mangled names also depend on what is kept as written and on the loaded map ---
+         std::string kept;
+         for (const std::string& name : options.cssAllowlist) kept += name + '\n';
+         kept += '\x1F';
+         for (const std::string& name : options.mangleAllowlist) kept += name + '\n';
+         return hash64(kept, signature ^ nameMapFingerprint());
+      }
+
+   } // namespace
+
+   Compressor::Compressor(CompressorOptions options) : compressorOptions(std::move(options)) {}
+
+   CompressResult Compressor::compress(std::string_view in, std::string& out) {
+      return compress(in, out, nullptr);
+   }
+
+   CompressResult Compressor::compress(std::string_view in, std::string& out, char* debugOutput) {
+      TraceSpan span("compress", static_cast<int64_t>(in.size()));
+      span.arg("level", compressorOptions.level);
+      const int64_t started = HtmlCompressor::now();
+      CompressResult result;
+      result.level = compressorOptions.level;
+
+      // --- Another process (or an earlier life of this one) may have compressed the same input ---
+      // --- Names assigned on first sight differ between processes: mangled output is shared only with a loaded map ---
+      SharedCache& sharedCache = SharedCache::instance();
+      const bool shared = sharedCache.isOpen() && (!manglesNames(compressorOptions) || nameMapFingerprint() != 0);
+      SharedCache::Key sharedKey{};
+      if (shared) {
+         TraceSpan lookup("shared cache lookup", static_cast<int64_t>(in.size()));
+         sharedKey = SharedCache::keyOf(compressorOptions, in);
+         const bool hit = sharedCache.find(sharedKey, out, result);
+         lookup.arg("hit", hit);
+         if (hit) return result;
+      }
+
+      SettingsScope settingsScope(compressorOptions, callDeadline, callBundlerDeadline);
+
+      // --- CSS/JS minifiers repeat the scan themselves and take their trim-only path; a page's names must be rewritten regardless ---
+      if (!(compressorOptions.type == ContentType::HTML && manglesNames(compressorOptions)) && isMinified(compressorOptions.type, in)) {
+         result.flags |= SKIPPED_MINIFIED;
+
+         if (compressorOptions.type == ContentType::HTML) {
+            out.assign(in.data(), in.size());
+            result.hash = hash64(out);
+            return result;
+         }
+      }
+
+      switch (compressorOptions.type) {
+         case ContentType::HTML:
+            // --- Pruning weighs every rule against the whole page; the placeholder byte must not occur already ---
+            if (compressorOptions.memoizeFragments && !compressorOptions.pruneUnusedCSS && std::memchr(in.data(), '\x1A', in.size()) == nullptr) {
+               compressMemoized(in, 0, in.size(), 0, in.size(), out, debugOutput);
+            } else {
+               compressHTML(in, out, debugOutput);
+            }
+            break;
+
+         case ContentType::CSS:
+            out.assign(in.data(), in.size());
+            HtmlCompressor::minifyCSS(out);
+            break;
+
+         case ContentType::JS:
+            out.assign(in.data(), in.size());
+            if (compressorOptions.useBundler) {
+               HtmlCompressor::minifyJS(out, compressorOptions.scope, debugOutput);
+            } else {
+               HtmlCompressor::minifyJS(out, compressorOptions.scope);
+            }
+            break;
+
+         case ContentType::JSON:
+            out.assign(in.data(), in.size());
+            HtmlCompressor::minifyJSON(out);
+            break;
+      }
+
+      // --- A cut-short run must not be served to later callers; neither it nor a trim-only run says what the level costs ---
+      const bool degraded = HtmlCompressor::settings.degraded;
+      if (degraded) {
+         result.flags |= DEADLINE_DEGRADED;
+      } else if ((result.flags & SKIPPED_MINIFIED) == 0) {
+         CostModel::instance().observe(compressorOptions.type, compressorOptions.level, runsBundler(compressorOptions), in.size(), HtmlCompressor::now() - started);
+      }
+
+      // --- Hashed while the freshly written output is still in cache, so callers need no second pass ---
+      result.hash = hash64(out);
+      if (shared && !degraded) sharedCache.store(sharedKey, out, result);
+      return result;
+   }
+
+   CompressResult Compressor::compressWithin(std::string_view in, std::string& out, int64_t budgetMicros, char* debugOutput) {
+      const CostModel& model = CostModel::instance();
+      const int64_t budget = std::max<int64_t>(budgetMicros, 0) * 1000;
+      const HtmlCompressor::Level configured = compressorOptions.level;
+      // --- Below EXTREME names would stay unmangled while the stylesheets and scripts that use them are ---
+      const HtmlCompressor::Level level = manglesNames(compressorOptions) ? configured : model.pick(compressorOptions.type, configured, in.size(), budget);
+
+      // --- esbuild must start early enough for its spawn to end inside the budget ---
+      callDeadline = HtmlCompressor::now() + budget;
+      callBundlerDeadline = std::max<int64_t>(callDeadline - model.bundlerCost(), 1);
+      compressorOptions.level = level;
+
+      CompressResult result;
+      try {
+         result = compress(in, out, debugOutput);
+      } catch (...) {
+         compressorOptions.level = configured;
+         callDeadline = callBundlerDeadline = 0;
+         throw;
+      }
+
+      compressorOptions.level = configured;
+      callDeadline = callBundlerDeadline = 0;
+      return result;
+   }
+
+   void Compressor::compressHTML(std::string_view in, std::string& out, char* debugOutput) {
+      if (compressorOptions.useBundler && compressorOptions.level >= HtmlCompressor::AGGRESSIVE) {
+         // --- One bundler process for all inline scripts, before minifyHTML sees them ---
+         std::string page(in);
+         HtmlCompressor::bundleInlineScripts(page, debugOutput);
+         HtmlCompressor::compress(page, out, workspace);
+      } else {
+         HtmlCompressor::compress(in, out, workspace);
+      }
+   }
+
+   void Compressor::compressMemoized(std::string_view html, size_t start, size_t end, size_t searchFrom, size_t searchTo, std::string& out, char* debugOutput) {
+      std::vector<Fragment> fragments;
+      findFragments(html, searchFrom, searchTo, compressorOptions.fragmentMarkers, fragments);
+      if (fragments.empty()) {
+         compressHTML(html.substr(start, end - start), out, debugOutput);
+         return;
+      }
+
+      FragmentCache& cache = FragmentCache::instance();
+      const uint64_t signature = fragmentSignature(compressorOptions);
+
+      // --- Cached fragments are spliced in; the others are compressed (and their own fragments reused) first ---
+      std::vector<std::string> outputs(fragments.size());
+      std::string skeleton;
+      skeleton.reserve(end - start);
+      size_t pos = start;
+
+      for (size_t i = 0; i < fragments.size(); ++i) {
+         const Fragment& fragment = fragments[i];
+         const std::string_view raw = html.substr(fragment.start, fragment.end - fragment.start);
+
+         bool hit = false;
+         {
+            TraceSpan lookup("fragment cache lookup", static_cast<int64_t>(raw.size()));
+            hit = cache.find(signature, raw, outputs[i]);
+            lookup.arg("hit", hit);
+         }
+         if (!hit) {
+            compressMemoized(html, fragment.start, fragment.end, fragment.contentStart, fragment.contentEnd, outputs[i], debugOutput);
+            if (!HtmlCompressor::settings.degraded) cache.store(signature, raw, outputs[i]);
+         }
+
+         skeleton.append(html.substr(pos, fragment.start - pos));
+         skeleton += kFragmentPlaceholder;
+         pos = fragment.end;
+      }
+      skeleton.append(html.substr(pos, end - pos));
+
+      // --- The fragments' style blocks sit between the skeleton's, out of the rule dedupe's sight ---
+      const bool dedupeAcrossStyleBlocks = HtmlCompressor::settings.dedupeAcrossStyleBlocks;
+      for (const Fragment& fragment : fragments) {
+         if (findTagIgnoreCase(html.substr(0, fragment.end), "<style", fragment.start) != std::string_view::npos) {
+            HtmlCompressor::settings.dedupeAcrossStyleBlocks = false;
+            break;
+         }
+      }
+
+      std::string compressed;
+      compressHTML(skeleton, compressed, debugOutput);
+      HtmlCompressor::settings.dedupeAcrossStyleBlocks = dedupeAcrossStyleBlocks;
+
+      out.clear();
+      out.reserve(compressed.size() + end - start);
+      size_t read = 0;
+      size_t spliced = 0;
+      for (const std::string& output : outputs) {
+         const size_t placeholder = compressed.find(kFragmentPlaceholder, read);
+         if (placeholder == std::string::npos) break;
+
+         out.append(compressed, read, placeholder - read);
+         out += output;
+         read = placeholder + kFragmentPlaceholder.size();
+         ++spliced;
+      }
+
+      // --- Every placeholder must come back exactly once; otherwise compress the range as a whole ---
+      if (spliced != outputs.size() || compressed.find(kFragmentPlaceholder, read) != std::string::npos) {
+         compressHTML(html.substr(start, end - start), out, debugOutput);
+         return;
+      }
+      out.append(compressed, read, std::string::npos);
+   }
+
+} // namespace phpspa
@@ -0,0 +1,145 @@
+#ifndef PHPSPA_COMPRESSOR_H
+#define PHPSPA_COMPRESSOR_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "HtmlCompressor.h"
+
+namespace phpspa {
+
+   enum class ContentType {
+      HTML,
+      CSS,
+      JS,
+      JSON
+   };
+
+   struct CompressorOptions {
+      HtmlCompressor::Level level = HtmlCompressor::BASIC;
+      ContentType type = ContentType::HTML;
+
+      // --- JS only: "global" or "scoped" (wrapped in an IIFE) ---
+      std::string scope = "global";
+
+      // --- JS: minify with esbuild at AGGRESSIVE/EXTREME, falling back to the native minifier ---
+      // --- HTML: minify all inline scripts of the page in one esbuild run ---
+      bool useBundler = false;
+
+      // --- Scripts (a page's inline scripts together) below this many bytes skip esbuild; 0 = learned from spawn and native timings ---
+      size_t bundlerMinBytes = 0;
+
+      // --- Inputs whose density pre-scan scores at least this compact are returned as-is (> 1 disables) ---
+      double minifiedThreshold = 0.95;
+
+      // --- HTML only: drop inline CSS rules that cannot match the page (full documents only) ---
+      bool pruneUnusedCSS = false;
+
+      // --- Classes/ids added at runtime that pruning must keep ("name", "#id", "prefix-*") ---
+      std::vector<std::string> cssAllowlist;
+
+      // --- HTML only, EXTREME: omit end tags the parser implies without changing the DOM ---
+      bool omitOptionalTags = true;
+
+      // --- HTML only, EXTREME: decimals kept in inline SVG path data and points (negative keeps them exact) ---
+      int svgPrecision = 3;
+
+      // --- HTML only, AGGRESSIVE+: keep one of byte-identical <style> blocks (for pages that are never swapped in part, as PhpSPA navigation does) ---
+      bool dedupeInlineStyles = false;
+
+      // --- HTML only, AGGRESSIVE+: keep only the last of byte-identical inline scripts (for components whose scripts can run once per page) ---
+      bool dedupeInlineScripts = false;
+
+      // --- EXTREME: rewrite class and id names to short ones, the same way in every page, stylesheet and script of the process ---
+      bool mangleNames = false;
+
+      // --- HTML only, EXTREME: sort class tokens and attributes so gzip/brotli see repeated tags as repeated bytes (changes className and attribute order seen by scripts) ---
+      bool canonicalizeAttributes = false;
+
+      // --- Classes/ids referenced by code the compressor never sees, kept as written (cssAllowlist entries are kept too) ---
+      std::vector<std::string> mangleAllowlist;
+
+      // --- HTML only: reuse cached output for marked fragments seen before (not with pruneUnusedCSS) ---
+      bool memoizeFragments = false;
+
+      // --- Attributes marking a fragment's root element ---
+      std::vector<std::string> fragmentMarkers{ "data-phpspa-target" };
+   };
+
+   enum ResultFlag : uint32_t {
+      // --- The pre-scan found the input already minified; it was only trimmed ---
+      SKIPPED_MINIFIED = 1u << 0,
+
+      // --- Native minifier output returned while the bundled result is still being built ---
+      PROVISIONAL = 1u << 1,
+
+      // --- A latency budget skipped passes or the bundler mid-call: valid output, less compact ---
+      DEADLINE_DEGRADED = 1u << 2
+   };
+
+   struct CompressResult {
+      uint32_t flags = 0;
+
+      // --- Level the output was compressed at; below the configured one when a latency budget lowered it ---
+      HtmlCompressor::Level level = HtmlCompressor::BASIC;
+
+      // --- hash64 of the output, for ETags and cache keys ---
+      uint64_t hash = 0;
+   };
+
+   /**
+    * Reusable compressor for C++ callers linking the library directly.
+    *
+    * Keeps its scratch buffers between calls, so repeated compression of
+    * similarly sized inputs stops allocating once the buffers are warm.
+    * An instance is not thread-safe; use one per thread.
+    */
+   class Compressor {
+      public:
+         explicit Compressor(CompressorOptions options = {});
+
+         /**
+          * Compress content according to the configured options
+          * @param in The content to compress
+          * @param out Receives the compressed content (its capacity is reused)
+          */
+         CompressResult compress(std::string_view in, std::string& out);
+
+         /**
+          * Compress content, reporting bundler activity for JS
+          * @param debugOutput Optional 1024-byte buffer receiving bundler diagnostics
+          */
+         CompressResult compress(std::string_view in, std::string& out, char* debugOutput);
+
+         /**
+          * Compress within a latency budget: at the most aggressive level up to
+          * the configured one that the cost model predicts to fit, skipping
+          * passes and esbuild runs mid-call once they would overrun
+          * @param budgetMicros Time allowed for the call, in microseconds
+          * @param debugOutput Optional 1024-byte buffer receiving bundler diagnostics
+          */
+         CompressResult compressWithin(std::string_view in, std::string& out, int64_t budgetMicros, char* debugOutput = nullptr);
+
+         const CompressorOptions& options() const { return compressorOptions; }
+
+         void setOptions(CompressorOptions options) { compressorOptions = std::move(options); }
+
+      private:
+         // --- Bundles the page's inline scripts first when the options ask for it ---
+         void compressHTML(std::string_view in, std::string& out, char* debugOutput);
+
+         // --- Compress html[start, end), taking marked fragments inside [searchFrom, searchTo) from the cache ---
+         void compressMemoized(std::string_view html, size_t start, size_t end, size_t searchFrom, size_t searchTo, std::string& out, char* debugOutput);
+
+         CompressorOptions compressorOptions;
+         HtmlCompressor::Workspace workspace;
+
+         // --- HtmlCompressor::now() deadlines of the compressWithin() call in progress; 0 otherwise ---
+         int64_t callDeadline = 0;
+         int64_t callBundlerDeadline = 0;
+   };
+
+} // namespace phpspa
+
+#endif // PHPSPA_COMPRESSOR_H
@@ -1,16 +1,63 @@
 #include "HtmlCompressor.h"
+#include "../utils/trace.h"
+
+#include <chrono>
 
 // --- Define static member variable ---
-HtmlCompressor::Level HtmlCompressor::currentLevel{ HtmlCompressor::BASIC };
+thread_local HtmlCompressor::Level HtmlCompressor::currentLevel{ HtmlCompressor::BASIC };
+thread_local HtmlCompressor::Settings HtmlCompressor::settings{};
 
-std::string HtmlCompressor::compress(const std::string& html) {
-   std::string compressedHtml = html;
+int64_t HtmlCompressor::now() {
+   return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
 
-   compressedHtml.reserve(html.size());
+bool HtmlCompressor::overDeadline(int64_t deadline) {
+   if (deadline == 0 || now() < deadline) return false;
 
-   if (HtmlCompressor::currentLevel >= BASIC) minifyHTML(compressedHtml);
-   if (HtmlCompressor::currentLevel >= AGGRESSIVE) removeComments(compressedHtml);
-   // if (level >= EXTREME) optimizeAttributes(compressedHtml); // --- This is done in the minifyHTML function ---
+   settings.degraded = true;
+   return true;
+}
 
+std::string HtmlCompressor::compress(const std::string& html) {
+   std::string compressedHtml;
+   Workspace workspace;
+
+   compress(html, compressedHtml, workspace);
    return compressedHtml;
 }
+
+void HtmlCompressor::compress(std::string_view html, std::string& out, Workspace& workspace) {
+   out.assign(html.data(), html.size());
+
+   if (HtmlCompressor::currentLevel == WHITESPACE) {
+      TraceSpan span("collapseWhitespace", static_cast<int64_t>(out.size()));
+      collapseWhitespace(out);
+      return;
+   }
+   // --- minifyHTML always runs; the passes around it are dropped once a deadline has passed ---
+   if (HtmlCompressor::currentLevel >= EXTREME && !overDeadline(settings.deadline)) {
+      TraceSpan span("minifyInlineSVG", static_cast<int64_t>(out.size()));
+      minifyInlineSVG(out);
+   }
+   if (HtmlCompressor::currentLevel >= BASIC) {
+      TraceSpan span("minifyHTML", static_cast<int64_t>(out.size()));
+      minifyHTML(out, workspace);
+   }
+   if (HtmlCompressor::currentLevel >= AGGRESSIVE && !overDeadline(settings.deadline)) {
+      TraceSpan span("removeComments", static_cast<int64_t>(out.size()));
+      removeComments(out);
+   }
+   if (HtmlCompressor::currentLevel >= AGGRESSIVE && !overDeadline(settings.deadline)) {
+      TraceSpan span("dedupeInlineBlocks", static_cast<int64_t>(out.size()));
+      dedupeInlineBlocks(out);
+   }
+   if (!overDeadline(settings.deadline)) {
+      TraceSpan span("optimizeStyleBlocks", static_cast<int64_t>(out.size()));
+      optimizeStyleBlocks(out);
+   }
+   if (HtmlCompressor::currentLevel >= EXTREME && settings.omitOptionalTags && !overDeadline(settings.deadline)) {
+      TraceSpan span("omitOptionalTags", static_cast<int64_t>(out.size()));
+      omitOptionalTags(out);
+   }
+   // if (level >= EXTREME) optimizeAttributes(compressedHtml); // --- This is done in the minifyHTML function ---
+}
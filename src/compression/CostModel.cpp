@@ -0,0 +1,77 @@
+#include "CostModel.h"
+#include "../utils/bundlerModel.h"
+
+#include <algorithm>
+
+namespace phpspa {
+
+   namespace {
+
+      // --- Per-call work that does not scale with the input (option setup, hashing a short output) ---
+      constexpr int64_t kNativeFixedNanos = 2000;
+
+      // --- Below this, the fixed overhead drowns the per-byte rate: such runs teach nothing ---
+      constexpr size_t kMinObservedBytes = 512;
+
+      // --- Weight of a new sample: 1/8 ---
+      constexpr int kSmoothingShift = 3;
+
+      // --- Priors from the bench corpus (Release build), picoseconds per byte at WHITESPACE..EXTREME ---
+      constexpr int64_t kHtmlPicos[] = { 1500, 10000, 250000, 250000 };
+      constexpr int64_t kCssPicos[] = { 2000, 2000, 350000, 350000 };
+      constexpr int64_t kJsPicos[] = { 25000, 25000, 25000, 25000 };
+      constexpr int64_t kJsonPicos[] = { 2000, 2000, 2000, 2000 };
+
+      void smooth(std::atomic<int64_t>& average, int64_t sample) {
+         const int64_t current = average.load(std::memory_order_relaxed);
+         average.store(current + ((sample - current) >> kSmoothingShift), std::memory_order_relaxed);
+      }
+
+   } // namespace
+
+   CostModel& CostModel::instance() {
+      static CostModel model;
+      return model;
+   }
+
+   CostModel::CostModel() {
+      for (size_t level = 0; level < kLevels; ++level) {
+         picosPerByte[static_cast<size_t>(ContentType::HTML) * kLevels + level].store(kHtmlPicos[level], std::memory_order_relaxed);
+         picosPerByte[static_cast<size_t>(ContentType::CSS) * kLevels + level].store(kCssPicos[level], std::memory_order_relaxed);
+         picosPerByte[static_cast<size_t>(ContentType::JS) * kLevels + level].store(kJsPicos[level], std::memory_order_relaxed);
+         picosPerByte[static_cast<size_t>(ContentType::JSON) * kLevels + level].store(kJsonPicos[level], std::memory_order_relaxed);
+      }
+   }
+
+   size_t CostModel::cell(ContentType type, HtmlCompressor::Level level) {
+      const size_t clamped = std::min<size_t>(static_cast<size_t>(std::max(0, static_cast<int>(level))), kLevels - 1);
+      return static_cast<size_t>(type) * kLevels + clamped;
+   }
+
+   int64_t CostModel::predict(ContentType type, HtmlCompressor::Level level, bool bundler, size_t bytes) const {
+      const int64_t native = kNativeFixedNanos + picosPerByte[cell(type, level)].load(std::memory_order_relaxed) * static_cast<int64_t>(bytes) / 1000;
+      return bundler ? native + bundlerCost() : native;
+   }
+
+   int64_t CostModel::bundlerCost() const {
+      return bundlerSpawnNanos();
+   }
+
+   HtmlCompressor::Level CostModel::pick(ContentType type, HtmlCompressor::Level max, size_t bytes, int64_t budgetNanos) const {
+      // --- Other content types treat WHITESPACE as BASIC ---
+      const HtmlCompressor::Level cheapest = type == ContentType::HTML ? HtmlCompressor::WHITESPACE : HtmlCompressor::BASIC;
+
+      for (int level = max; level > cheapest; --level) {
+         if (predict(type, static_cast<HtmlCompressor::Level>(level), false, bytes) <= budgetNanos) return static_cast<HtmlCompressor::Level>(level);
+      }
+      return std::min(cheapest, max);
+   }
+
+   void CostModel::observe(ContentType type, HtmlCompressor::Level level, bool bundler, size_t bytes, int64_t nanos) {
+      // --- A bundled run's time is mostly the spawn, which says nothing about the native rate ---
+      if (bundler || bytes < kMinObservedBytes) return;
+
+      smooth(picosPerByte[cell(type, level)], std::max<int64_t>(nanos - kNativeFixedNanos, 0) * 1000 / static_cast<int64_t>(bytes));
+   }
+
+} // namespace phpspa
@@ -0,0 +1,59 @@
+#ifndef PHPSPA_COST_MODEL_H
+#define PHPSPA_COST_MODEL_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include "Compressor.h"
+
+namespace phpspa {
+
+   /**
+    * Predicted cost of a compression run, per content type and level, learned
+    * from the runs this process has timed.
+    *
+    * A native run costs a small fixed overhead plus a per-byte rate; an
+    * esbuild run adds a fixed spawn cost that dwarfs both, learned by the
+    * bundler model (utils/bundlerModel.h) that decides which scripts reach
+    * esbuild at all. Each figure starts
+    * from a prior measured on the bench corpus and follows an exponentially
+    * weighted average of the observed ones, so it adapts to the host and to
+    * the pages actually served.
+    *
+    * One process-wide instance, safe to use from any thread; concurrent
+    * updates may drop a sample, never corrupt one.
+    */
+   class CostModel {
+      public:
+         static CostModel& instance();
+
+         CostModel(const CostModel&) = delete;
+         CostModel& operator=(const CostModel&) = delete;
+
+         // --- Predicted nanoseconds for bytes of input; bundler adds the esbuild spawn ---
+         int64_t predict(ContentType type, HtmlCompressor::Level level, bool bundler, size_t bytes) const;
+
+         // --- Predicted nanoseconds of the esbuild spawn alone ---
+         int64_t bundlerCost() const;
+
+         // --- Most aggressive level up to max whose native run fits budgetNanos; the cheapest level when none does ---
+         HtmlCompressor::Level pick(ContentType type, HtmlCompressor::Level max, size_t bytes, int64_t budgetNanos) const;
+
+         // --- Feed the timing of a complete (not cut short, not cached) run; bundled runs are timed by the bundler model ---
+         void observe(ContentType type, HtmlCompressor::Level level, bool bundler, size_t bytes, int64_t nanos);
+
+      private:
+         static constexpr size_t kTypes = 4;
+         static constexpr size_t kLevels = 4;
+
+         CostModel();
+
+         static size_t cell(ContentType type, HtmlCompressor::Level level);
+
+         // --- Native rate in picoseconds per byte ---
+         std::atomic<int64_t> picosPerByte[kTypes * kLevels];
+   };
+
+} // namespace phpspa
+
+#endif // PHPSPA_COST_MODEL_H
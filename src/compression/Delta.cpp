@@ -0,0 +1,256 @@
+#include "Delta.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
+#include <cstddef>
+#include <functional>
+#include <utility>
+#include <vector>
+
+namespace phpspa {
+
+   namespace {
+
+      // --- Base occurrences of a token tried on each side of the cursor ---
+      constexpr std::ptrdiff_t kCandidates = 16;
+
+      uint32_t fnv1a(std::string_view text) {
+         uint32_t hash = 2166136261u;
+         for (const char ch : text) {
+            hash ^= static_cast<unsigned char>(ch);
+            hash *= 16777619u;
+         }
+         return hash;
+      }
+
+      void writeNumber(std::string& out, size_t value) {
+         char digits[16];
+         const auto result = std::to_chars(digits, digits + sizeof(digits), value, 36);
+         out.append(digits, result.ptr);
+      }
+
+      size_t numberLength(size_t value) {
+         size_t length = 1;
+         while (value >= 36) {
+            value /= 36;
+            ++length;
+         }
+         return length;
+      }
+
+      bool readNumber(std::string_view text, size_t& pos, size_t& value) {
+         const auto result = std::from_chars(text.data() + pos, text.data() + text.size(), value, 36);
+         if (result.ec != std::errc() || result.ptr == text.data() + pos) return false;
+         pos = static_cast<size_t>(result.ptr - text.data());
+         return true;
+      }
+
+      bool isBoundary(std::string_view text, size_t pos) {
+         if (pos == 0) return true;
+         const char previous = text[pos - 1];
+         return text[pos] == '<' || previous == '>' || previous == ' ' || previous == '\n' || previous == '\t' || previous == '\r' ||
+                previous == ',' || previous == ';' || previous == '{' || previous == '}';
+      }
+
+      // --- Token start offsets, closed by text.size() ---
+      std::vector<size_t> tokenize(std::string_view text) {
+         std::vector<size_t> starts;
+         starts.reserve(text.size() / 8 + 2);
+         for (size_t pos = 0; pos < text.size(); ++pos) {
+            if (isBoundary(text, pos)) starts.push_back(pos);
+         }
+         starts.push_back(text.size());
+         return starts;
+      }
+
+      std::string_view tokenAt(std::string_view text, const std::vector<size_t>& starts, size_t index) {
+         return text.substr(starts[index], starts[index + 1] - starts[index]);
+      }
+
+      // --- Buffers adjacent copies and pending inserts so each becomes a single op ---
+      class PatchWriter {
+         public:
+            PatchWriter(std::string& patch, std::string_view target) : patch(patch), target(target) {}
+
+            // --- Base offset the next copy continues from without a seek ---
+            size_t cursor() const { return copyStart + copyLength; }
+
+            void copy(size_t from, size_t length) {
+               if (insertLength == 0 && copyLength > 0 && from == cursor()) {
+                  copyLength += length;
+                  return;
+               }
+               flush();
+               if (from != copyStart) {
+                  patch += '@';
+                  writeNumber(patch, from);
+               }
+               copyStart = from;
+               copyLength = length;
+            }
+
+            // --- Target bytes [from, from + length), contiguous with the pending insert ---
+            void insert(size_t from, size_t length) {
+               flushCopy();
+               if (insertLength == 0) insertStart = from;
+               insertLength += length;
+            }
+
+            void flush() {
+               flushCopy();
+               if (insertLength == 0) return;
+               patch += '+';
+               writeNumber(patch, insertLength);
+               patch += ':';
+               patch.append(target.substr(insertStart, insertLength));
+               insertLength = 0;
+            }
+
+         private:
+            void flushCopy() {
+               if (copyLength == 0) return;
+               patch += '=';
+               writeNumber(patch, copyLength);
+               copyStart += copyLength;
+               copyLength = 0;
+            }
+
+            std::string& patch;
+            std::string_view target;
+            size_t copyStart = 0;
+            size_t copyLength = 0;
+            size_t insertStart = 0;
+            size_t insertLength = 0;
+      };
+
+   } // namespace
+
+   void encodeDelta(std::string_view base, std::string_view target, std::string& patch) {
+      patch.clear();
+      writeNumber(patch, base.size());
+      patch += '.';
+      writeNumber(patch, fnv1a(base));
+      patch += '.';
+      writeNumber(patch, target.size());
+      patch += '|';
+
+      const std::vector<size_t> baseStarts = tokenize(base);
+      const std::vector<size_t> targetStarts = tokenize(target);
+      const size_t baseTokens = baseStarts.size() - 1;
+      const size_t targetTokens = targetStarts.size() - 1;
+
+      // --- (token hash, base token index) pairs, sorted: equal tokens form runs in base order ---
+      const std::hash<std::string_view> hasher;
+      std::vector<std::pair<size_t, size_t>> occurrences;
+      occurrences.reserve(baseTokens);
+      for (size_t index = 0; index < baseTokens; ++index) {
+         occurrences.emplace_back(hasher(tokenAt(base, baseStarts, index)), index);
+      }
+      std::sort(occurrences.begin(), occurrences.end());
+
+      PatchWriter writer(patch, target);
+
+      // --- Bytes of the longest token run shared by target from token i and base from token k ---
+      auto matchLength = [&](size_t i, size_t k) {
+         size_t end = 0;
+         while (i + end < targetTokens && k + end < baseTokens && tokenAt(target, targetStarts, i + end) == tokenAt(base, baseStarts, k + end)) {
+            ++end;
+         }
+         return targetStarts[i + end] - targetStarts[i];
+      };
+
+      size_t i = 0;
+      while (i < targetTokens) {
+         const std::string_view token = tokenAt(target, targetStarts, i);
+         const size_t cursor = writer.cursor();
+         const size_t cursorToken = static_cast<size_t>(std::lower_bound(baseStarts.begin(), baseStarts.end(), cursor) - baseStarts.begin());
+
+         size_t bestToken = 0;
+         size_t bestLength = 0;
+         std::ptrdiff_t bestGain = 0;
+
+         const auto consider = [&](size_t k) {
+            const size_t length = matchLength(i, k);
+            if (length == 0) return;
+
+            // --- Worth a copy op (and a seek) only when it beats inserting the bytes ---
+            const size_t from = baseStarts[k];
+            const size_t cost = 1 + numberLength(length) + (from == cursor ? 0 : 1 + numberLength(from)) + 3;
+            const std::ptrdiff_t gain = static_cast<std::ptrdiff_t>(length) - static_cast<std::ptrdiff_t>(cost);
+            if (gain > bestGain) {
+               bestGain = gain;
+               bestToken = k;
+               bestLength = length;
+            }
+         };
+
+         if (cursorToken < baseTokens) consider(cursorToken);
+
+         const size_t hash = hasher(token);
+         const auto runStart = std::lower_bound(occurrences.begin(), occurrences.end(), std::pair<size_t, size_t>(hash, 0));
+         const auto middle = std::lower_bound(runStart, occurrences.end(), std::pair<size_t, size_t>(hash, cursorToken));
+         for (auto it = middle - std::min<std::ptrdiff_t>(middle - runStart, kCandidates); it != occurrences.end() && it->first == hash && it < middle + kCandidates; ++it) {
+            if (it->second != cursorToken) consider(it->second);
+         }
+
+         if (bestLength == 0) {
+            writer.insert(targetStarts[i], token.size());
+            ++i;
+            continue;
+         }
+
+         writer.copy(baseStarts[bestToken], bestLength);
+         i = static_cast<size_t>(std::lower_bound(targetStarts.begin() + static_cast<std::ptrdiff_t>(i), targetStarts.end(), targetStarts[i] + bestLength) - targetStarts.begin());
+      }
+      writer.flush();
+   }
+
+   bool applyDelta(std::string_view base, std::string_view patch, std::string& out) {
+      size_t pos = 0;
+      size_t baseLength = 0;
+      size_t baseHash = 0;
+      size_t targetLength = 0;
+
+      if (!readNumber(patch, pos, baseLength) || pos >= patch.size() || patch[pos++] != '.') return false;
+      if (!readNumber(patch, pos, baseHash) || pos >= patch.size() || patch[pos++] != '.') return false;
+      if (!readNumber(patch, pos, targetLength) || pos >= patch.size() || patch[pos++] != '|') return false;
+      if (baseLength != base.size() || baseHash != fnv1a(base)) return false;
+
+      out.clear();
+      out.reserve(targetLength);
+      size_t cursor = 0;
+
+      while (pos < patch.size()) {
+         const char op = patch[pos++];
+         size_t value = 0;
+         if (!readNumber(patch, pos, value)) return false;
+
+         switch (op) {
+            case '@':
+               if (value > base.size()) return false;
+               cursor = value;
+               break;
+
+            case '=':
+               if (value > base.size() - cursor) return false;
+               out.append(base.substr(cursor, value));
+               cursor += value;
+               break;
+
+            case '+':
+               if (pos >= patch.size() || patch[pos++] != ':' || value > patch.size() - pos) return false;
+               out.append(patch.substr(pos, value));
+               pos += value;
+               break;
+
+            default:
+               return false;
+         }
+
+         if (out.size() > targetLength) return false;
+      }
+      return out.size() == targetLength;
+   }
+
+} // namespace phpspa
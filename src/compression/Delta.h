@@ -0,0 +1,38 @@
+#ifndef PHPSPA_DELTA_H
+#define PHPSPA_DELTA_H
+
+#include <string>
+#include <string_view>
+
+namespace phpspa {
+
+   /**
+    * Patches between two renders of the same page or component, so a client
+    * holding the previous output only receives the bytes that changed.
+    *
+    * Format (numbers are lowercase base 36):
+    *
+    *   <base length>.<base hash>.<target length>|<ops>
+    *
+    *   @n      move the base cursor to offset n
+    *   =n      copy n bytes from the base at the cursor, advancing it
+    *   +n:...  insert the n bytes that follow
+    *
+    * The base hash is 32-bit FNV-1a; a patch applied to any other base is
+    * rejected. Copies start and end on token boundaries (before "<", after
+    * ">", whitespace and ",;{}"), which are always ASCII, so inserted bytes
+    * of UTF-8 input are themselves valid UTF-8.
+    */
+
+   // --- Patch that turns base into target (may exceed target's size when they share little) ---
+   void encodeDelta(std::string_view base, std::string_view target, std::string& patch);
+
+   /**
+    * Reference applier for ports of the format (e.g. the JS runtime)
+    * @return false, with out unspecified, when the patch is malformed or was made for another base
+    */
+   bool applyDelta(std::string_view base, std::string_view patch, std::string& out);
+
+} // namespace phpspa
+
+#endif // PHPSPA_DELTA_H
@@ -0,0 +1,202 @@
+#include "FragmentCache.h"
+#include "../utils/styleSheet.h"
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <functional>
+
+namespace phpspa {
+
+   namespace {
+
+      // --- Elements whose content is not markup ---
+      constexpr std::array<std::string_view, 9> kRawTextElements{
+         "iframe", "noembed", "noframes", "noscript", "script", "style", "textarea", "title", "xmp",
+      };
+
+      // --- Whitespace-preserving or foreign content: minified differently than in isolation ---
+      constexpr std::array<std::string_view, 5> kOpaqueElements{ "code", "listing", "math", "pre", "svg" };
+
+      // --- End tags the parser may imply, so the token after the content depends on the page ---
+      constexpr std::array<std::string_view, 19> kImpliedEndElements{
+         "body", "caption", "colgroup", "dd", "dt", "head", "html", "li", "optgroup", "option",
+         "p", "rp", "rt", "tbody", "td", "tfoot", "th", "thead", "tr",
+      };
+
+      constexpr std::array<std::string_view, 15> kVoidElements{
+         "area", "base", "br", "col", "embed", "hr", "img", "input", "keygen", "link", "meta", "param", "source", "track", "wbr",
+      };
+
+      template <typename Container>
+      bool contains(const Container& names, std::string_view name) {
+         return std::find(names.begin(), names.end(), name) != names.end();
+      }
+
+      std::string readTagName(std::string_view html, size_t pos) {
+         std::string name;
+         while (pos < html.size() && (std::isalnum(static_cast<unsigned char>(html[pos])) || html[pos] == '-' || html[pos] == ':')) {
+            name += static_cast<char>(std::tolower(static_cast<unsigned char>(html[pos])));
+            ++pos;
+         }
+         return name;
+      }
+
+      // --- Position of the ">" closing the tag at pos, skipping quoted attribute values ---
+      size_t findTagEnd(std::string_view html, size_t pos) {
+         while (pos < html.size()) {
+            const char ch = html[pos];
+            if (ch == '>') return pos;
+            if ((ch == '"' || ch == '\'') && html[pos - 1] == '=') {
+               pos = html.find(ch, pos + 1);
+               if (pos == std::string_view::npos) return pos;
+            }
+            ++pos;
+         }
+         return std::string_view::npos;
+      }
+
+      struct TagStep {
+         size_t start = 0;
+         size_t end = 0; // --- one past ">" ---
+         std::string name;
+         bool closing = false;
+      };
+
+      /**
+       * One step of a forward tag scan over html[pos, to): skips text, comments
+       * and raw-text content, and reports the next tag.
+       * @return false at the end of the range or on an unterminated construct
+       */
+      bool nextTag(std::string_view html, size_t& pos, size_t to, TagStep& tag) {
+         for (;;) {
+            const size_t open = html.find('<', pos);
+            if (open == std::string_view::npos || open >= to) return false;
+
+            if (html.compare(open, 4, "<!--") == 0) {
+               const size_t close = html.find("-->", open + 4);
+               if (close == std::string_view::npos || close + 3 > to) return false;
+               pos = close + 3;
+               continue;
+            }
+
+            tag.closing = open + 1 < to && html[open + 1] == '/';
+            tag.name = readTagName(html, open + (tag.closing ? 2 : 1));
+            if (tag.name.empty()) {
+               pos = open + 1;
+               continue;
+            }
+
+            const size_t close = tag.closing ? html.find('>', open) : findTagEnd(html, open + 1);
+            if (close == std::string_view::npos || close >= to) return false;
+
+            tag.start = open;
+            tag.end = close + 1;
+            pos = tag.end;
+
+            if (!tag.closing && contains(kRawTextElements, tag.name)) {
+               const size_t rawEnd = findTagIgnoreCase(html, "</" + tag.name, pos);
+               if (rawEnd == std::string_view::npos || rawEnd >= to) return false;
+               pos = rawEnd;
+            }
+            return true;
+         }
+      }
+
+      bool isMarked(std::string_view startTag, const std::vector<std::string>& markers) {
+         return std::any_of(markers.begin(), markers.end(), [&](const std::string& marker) { return hasAttribute(startTag, marker); });
+      }
+
+      // --- The end tag matching a start tag named name ---
+      bool findMatchingEnd(std::string_view html, std::string_view name, size_t pos, size_t to, TagStep& endTag) {
+         size_t depth = 1;
+         while (nextTag(html, pos, to, endTag)) {
+            if (endTag.name != name) continue;
+
+            if (!endTag.closing) {
+               ++depth;
+            } else if (--depth == 0) {
+               return true;
+            }
+         }
+         return false;
+      }
+
+   } // namespace
+
+   void findFragments(std::string_view html, size_t from, size_t to, const std::vector<std::string>& markers, std::vector<Fragment>& fragments) {
+      size_t opaqueDepth = 0;
+      size_t pos = from;
+      TagStep tag;
+      TagStep endTag;
+
+      while (nextTag(html, pos, to, tag)) {
+         if (contains(kOpaqueElements, tag.name)) {
+            if (!tag.closing) {
+               if (html[tag.end - 2] != '/') ++opaqueDepth; // --- <svg/> has no content ---
+            } else if (opaqueDepth > 0) {
+               --opaqueDepth;
+            }
+            continue;
+         }
+         if (tag.closing || opaqueDepth > 0) continue;
+         if (contains(kRawTextElements, tag.name) || contains(kImpliedEndElements, tag.name) || contains(kVoidElements, tag.name)) continue;
+
+         if (!isMarked(html.substr(tag.start, tag.end - tag.start), markers)) continue;
+
+         // --- Without a matching end tag the element is scanned through, so marked descendants can still qualify ---
+         if (!findMatchingEnd(html, tag.name, tag.end, to, endTag)) continue;
+
+         fragments.push_back({ tag.start, tag.end, endTag.start, endTag.end });
+         pos = endTag.end;
+      }
+   }
+
+   FragmentCache& FragmentCache::instance() {
+      static FragmentCache cache;
+      return cache;
+   }
+
+   uint64_t FragmentCache::keyOf(uint64_t signature, std::string_view raw) {
+      return static_cast<uint64_t>(std::hash<std::string_view>{}(raw)) ^ (signature * 0x9E3779B97F4A7C15ull);
+   }
+
+   bool FragmentCache::find(uint64_t signature, std::string_view raw, std::string& out) {
+      std::lock_guard<std::mutex> lock(mutex);
+      const auto hit = entries.find(keyOf(signature, raw));
+      if (hit == entries.end() || hit->second.signature != signature || hit->second.raw != raw) return false;
+
+      out = hit->second.output;
+      return true;
+   }
+
+   void FragmentCache::store(uint64_t signature, std::string_view raw, std::string_view output) {
+      const size_t entryBytes = raw.size() + output.size();
+      if (entryBytes > kCacheBytes) return;
+
+      const uint64_t key = keyOf(signature, raw);
+      std::lock_guard<std::mutex> lock(mutex);
+
+      // --- Filled by a concurrent miss, or (vanishingly rare) a colliding fragment that keeps its slot ---
+      if (entries.contains(key)) return;
+
+      while (cacheBytes + entryBytes > kCacheBytes && !order.empty()) {
+         const auto oldest = entries.find(order.front());
+         cacheBytes -= oldest->second.raw.size() + oldest->second.output.size();
+         entries.erase(oldest);
+         order.pop_front();
+      }
+
+      entries.emplace(key, Entry{ signature, std::string(raw), std::string(output) });
+      order.push_back(key);
+      cacheBytes += entryBytes;
+   }
+
+   void FragmentCache::clear() {
+      std::lock_guard<std::mutex> lock(mutex);
+      entries.clear();
+      order.clear();
+      cacheBytes = 0;
+   }
+
+} // namespace phpspa
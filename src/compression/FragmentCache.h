@@ -0,0 +1,73 @@
+#ifndef PHPSPA_FRAGMENT_CACHE_H
+#define PHPSPA_FRAGMENT_CACHE_H
+
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace phpspa {
+
+   // --- A marked element: start tag at start, content in [contentStart, contentEnd), end tag ending at end ---
+   struct Fragment {
+      size_t start;
+      size_t contentStart;
+      size_t contentEnd;
+      size_t end;
+   };
+
+   /**
+    * Outermost marked elements in html[from, to) that minify the same on
+    * their own as in the page: not inside pre/code/svg/math, and with an end
+    * tag the parser never implies, so the element's last token is followed
+    * by that end tag in both.
+    */
+   void findFragments(std::string_view html, size_t from, size_t to, const std::vector<std::string>& markers, std::vector<Fragment>& fragments);
+
+   /**
+    * Minified output of page fragments (component subtrees), keyed by a hash
+    * of their raw bytes and of the options that shaped the output. A hit
+    * also compares the raw bytes, so a hash collision is only a miss.
+    *
+    * One process-wide instance, safe to use from any thread. Entries are
+    * evicted oldest first once the byte budget is spent.
+    */
+   class FragmentCache {
+      public:
+         static FragmentCache& instance();
+
+         FragmentCache(const FragmentCache&) = delete;
+         FragmentCache& operator=(const FragmentCache&) = delete;
+
+         // --- Copies the cached output into out; false on a miss ---
+         bool find(uint64_t signature, std::string_view raw, std::string& out);
+
+         void store(uint64_t signature, std::string_view raw, std::string_view output);
+
+         void clear();
+
+      private:
+         static constexpr size_t kCacheBytes = 8 * 1024 * 1024;
+
+         struct Entry {
+            uint64_t signature;
+            std::string raw;
+            std::string output;
+         };
+
+         FragmentCache() = default;
+
+         static uint64_t keyOf(uint64_t signature, std::string_view raw);
+
+         std::mutex mutex;
+         std::unordered_map<uint64_t, Entry> entries;
+         std::deque<uint64_t> order;
+         size_t cacheBytes = 0;
+   };
+
+} // namespace phpspa
+
+#endif // PHPSPA_FRAGMENT_CACHE_H
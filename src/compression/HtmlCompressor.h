@@ -1,26 +1,109 @@
 #ifndef HTML_COMPRESSOR_H
 #define HTML_COMPRESSOR_H
 
+#include <cstdint>
 #include <string>
+#include <string_view>
+#include <vector>
+
+struct StyleBlock;
 
 class HtmlCompressor {
    public:
       enum Level {
+         WHITESPACE = 0, // --- collapse whitespace and drop comments only; no tag parsing ---
          BASIC = 1,
          AGGRESSIVE = 2,
          EXTREME = 3
       };
 
-      static Level currentLevel;
+      // --- Per thread, so independent compressors can run concurrently ---
+      static thread_local Level currentLevel;
+
+      // --- Feature settings consulted by the passes, installed per call by phpspa::Compressor ---
+      struct Settings {
+         // --- Inputs whose density scan scores at least this compact are returned as-is (> 1 disables) ---
+         double minifiedThreshold = 0.95;
+
+         // --- Drop <style> rules whose selectors cannot match the (full) document ---
+         bool pruneUnusedCSS = false;
+
+         // --- Classes/ids added at runtime that pruning must keep ("name", "#id", "prefix-*") ---
+         const std::vector<std::string>* cssAllowlist = nullptr;
+
+         // --- EXTREME: drop end tags the HTML parser implies (</li>, </p>, </td>, </body>, ...) ---
+         bool omitOptionalTags = true;
+
+         // --- EXTREME: decimals kept in inline SVG path data and points (negative keeps them exact) ---
+         int svgPrecision = 3;
+
+         // --- EXTREME: drop a rule repeated in a later <style> block; off while blocks of the page are elsewhere ---
+         bool dedupeAcrossStyleBlocks = true;
+
+         // --- now() after which optional passes and inline block minification are skipped; 0 = none ---
+         int64_t deadline = 0;
+
+         // --- now() after which no esbuild run is started (the native minifier is used instead); 0 = none ---
+         int64_t bundlerDeadline = 0;
+
+         // --- AGGRESSIVE+: keep one of byte-identical <style> blocks ---
+         bool dedupeInlineStyles = false;
+
+         // --- AGGRESSIVE+: keep one of byte-identical inline scripts (the last) ---
+         bool dedupeInlineScripts = false;
+
+         // --- EXTREME: rewrite class and id names to the process-wide short names (utils/nameMap.h) ---
+         bool mangleNames = false;
+
+         // --- EXTREME: sort class tokens and (where no framework directive is present) attributes, so repeated tags are repeated bytes ---
+         bool canonicalizeAttributes = false;
+
+         // --- Classes/ids referenced by code the compressor never sees, kept as written (same syntax as cssAllowlist) ---
+         const std::vector<std::string>* mangleAllowlist = nullptr;
+
+         // --- Scripts below this many bytes skip esbuild; 0 = the bundler model's learned threshold ---
+         size_t bundlerMinBytes = 0;
+
+         // --- Set when work was skipped or cheapened to meet a deadline ---
+         bool degraded = false;
+      };
+
+      static thread_local Settings settings;
+
+      // --- Reserve the allowlisted names before any is generated, so none of them is handed to another name ---
+      static void reserveKeptNames();
+
+      // --- Monotonic clock in nanoseconds, the scale of the Settings deadlines ---
+      static int64_t now();
+
+      // --- True when the deadline (one of the Settings deadlines) is set and has passed; marks the call degraded ---
+      static bool overDeadline(int64_t deadline);
+
+      // --- Scratch buffers reused across calls; their capacity grows with the largest input seen ---
+      struct Workspace {
+         std::vector<std::string> tagStack;
+         std::string tagContent;
+         std::string tagName;
+         std::string attributes;
+         std::string block;
+      };
 
       /**
        * Compress HTML content based on specified level
        * @param html The HTML content to compress
-       * @param level Compression level (1-3)
+       * @param level Compression level (0-3)
        * @return Compressed HTML string
        */
       static std::string compress(const std::string& html);
 
+      /**
+       * Compress HTML content into an existing buffer, reusing its capacity
+       * @param html The HTML content to compress
+       * @param out Receives the compressed HTML
+       * @param workspace Scratch buffers kept by the caller between calls
+       */
+      static void compress(std::string_view html, std::string& out, Workspace& workspace);
+
       // --- Minify inline CSS content ---
       static void minifyCSS(std::string& css);
 
@@ -30,16 +113,77 @@ class HtmlCompressor {
       // --- Minify JavaScript content with scope (global|scoped) ---
       static void minifyJS(std::string& js, const std::string& scope, char* debugOutput);
 
+      // --- Strip whitespace between JSON tokens; false (unchanged) when the input is not valid JSON ---
+      static bool minifyJSON(std::string& json);
+
+      // --- Minify several scripts with one bundler process; false (scripts untouched) when it is unavailable or fails ---
+      static bool minifyJSBatch(std::vector<std::string>& scripts, const std::string& scope, char* debugOutput);
+
+      // --- Minify every inline script of a page in a single bundler run (AGGRESSIVE/EXTREME) ---
+      static void bundleInlineScripts(std::string& html, char* debugOutput);
+
+      // --- Cheap vectorized pre-scan: does the content already look minified? ---
+      static bool isMinifiedHTML(std::string_view html);
+      static bool isMinifiedCSS(std::string_view css);
+      static bool isMinifiedJS(std::string_view js);
+
    private:
 
       // --- Remove HTML comments (<!-- -->) ---
       static void removeComments(std::string& html);
       
       // --- Remove unnecessary whitespace (multiple spaces, newlines, tabs) ---
-      static void minifyHTML(std::string& html);
+      static void minifyHTML(std::string& html, Workspace& workspace);
+
+      // --- WHITESPACE level: collapse whitespace, drop comments, copy tags and raw-text bodies verbatim ---
+      static void collapseWhitespace(std::string& html);
+
+      // --- minifyHTML's tag loop, instantiated per level so no per-tag level checks remain ---
+      template <Level level>
+      static void minifyHTMLAt(std::string& html, Workspace& workspace);
+
+      // --- Multi-megabyte documents: chunks minified on several threads; false when not worth splitting ---
+      static bool minifyHTMLParallel(std::string& html);
+
+      // --- Page pass over all <style> blocks: unused-rule pruning (opt-in) and rule merging (EXTREME) ---
+      static void optimizeStyleBlocks(std::string& html);
+
+      // --- Drop rules whose selectors reference classes, ids or tags absent from the document ---
+      static bool pruneUnusedRules(std::string_view html, std::vector<StyleBlock>& blocks);
+
+      // --- Dedupe and merge rules across blocks without changing the cascade ---
+      static bool mergeStyleRules(std::vector<StyleBlock>& blocks);
+
+      // --- Compact declaration values of minified CSS (colors, numbers, shorthands, keywords) ---
+      static void optimizeCSSValues(std::string& css);
+
+      // --- Keep one copy of <style> blocks and inline scripts (each behind its setting) a page repeats byte for byte ---
+      static void dedupeInlineBlocks(std::string& html);
+
+      // --- Drop optional end tags where the spec's next-token/parent conditions hold ---
+      static void omitOptionalTags(std::string& html);
+
+      // --- Compact <svg> subtrees: path data, editor metadata, default attributes ---
+      static void minifyInlineSVG(std::string& html);
+
+      // --- EXTREME with mangleNames set: class/id names are rewritten wherever they occur ---
+      static bool manglingNames();
+
+      // --- Rewrite class/id names in class, id, id-reference, fragment href, url(#id) and event handler values ---
+      static void mangleAttributes(const std::string& tagContent, std::string& out);
+
+      // --- Rewrite .class and #id in selectors, and url(#id) in declarations ---
+      static void mangleStyleSheet(std::string& css);
+
+      // --- Rewrite names in string literals passed to classList, querySelector(All), closest, matches, getElementById and getElementsByClassName ---
+      static void mangleScript(std::string& js);
+
+      // --- Sort the class tokens and the attributes of a start tag; anything it cannot parse is copied unchanged ---
+      static void canonicalizeAttributes(const std::string& tagContent, std::string& out);
 
-      // --- Optimize attributes (remove quotes where safe, trim values) ---
-      static void optimizeAttributes(std::string& tagContent);
+      // --- Optimize attributes (remove quotes where safe, trim values); instantiated for AGGRESSIVE and EXTREME ---
+      template <Level level>
+      static void optimizeAttributes(std::string& tagContent, std::string& scratch);
 };
 
 #endif // HTML_COMPRESSOR_H
@@ -0,0 +1,274 @@
+#include "SharedCache.h"
+#include "../utils/hash.h"
+#include "../utils/nameMap.h"
+
+#include <cstring>
+#include <mutex>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace phpspa {
+
+   namespace {
+
+      constexpr char kMagic[8] = { 'P', 'H', 'P', 'S', 'P', 'A', 'C', '1' };
+      constexpr uint32_t kVersion = 1;
+
+      // --- Slots tried from a key's home slot before the oldest of them is reused ---
+      constexpr uint64_t kProbeLength = 8;
+
+      // --- One slot per this many heap bytes: room for records averaging a quarter of it ---
+      constexpr uint64_t kHeapBytesPerSlot = 512;
+
+      constexpr uint64_t kMinHeapBytes = 64 * 1024;
+
+      // --- A record must leave most of the ring to the others ---
+      constexpr uint64_t kMaxRecordShare = 8;
+
+      // --- Geometry at the start of the file, read before mapping it ---
+      struct Layout {
+         char magic[8];
+         uint32_t version;
+         uint32_t headerBytes;
+         uint64_t slotCount; // --- power of two ---
+         uint64_t heapBytes;
+      };
+
+      struct Record {
+         uint64_t keyLow;
+         uint64_t keyHigh;
+         uint64_t outputHash;
+         uint32_t length;
+         uint32_t flags;
+      };
+
+      uint64_t alignUp(uint64_t value) {
+         return (value + 7) & ~uint64_t{ 7 };
+      }
+
+      uint64_t roundUpPowerOfTwo(uint64_t value) {
+         uint64_t result = 1;
+         while (result < value) result <<= 1;
+         return result;
+      }
+
+   } // namespace
+
+   static_assert(std::atomic<uint64_t>::is_always_lock_free, "the shared index needs address-free 64-bit atomics");
+
+   struct SharedCache::Slot {
+      std::atomic<uint64_t> tag;      // --- key.low; a hint, the record holds the full key ---
+      std::atomic<uint64_t> position; // --- record start + 1; 0 while empty or being replaced ---
+   };
+
+   struct SharedCache::Header {
+      Layout layout;
+      alignas(64) std::atomic<uint64_t> head; // --- heap bytes ever reserved; a record at start is intact while head <= start + heapBytes ---
+
+      Slot* slots() { return reinterpret_cast<Slot*>(reinterpret_cast<char*>(this) + sizeof(Header)); }
+      const Slot* slots() const { return reinterpret_cast<const Slot*>(reinterpret_cast<const char*>(this) + sizeof(Header)); }
+      char* heap() { return reinterpret_cast<char*>(slots() + layout.slotCount); }
+      const char* heap() const { return reinterpret_cast<const char*>(slots() + layout.slotCount); }
+   };
+
+   SharedCache& SharedCache::instance() {
+      static SharedCache cache;
+      return cache;
+   }
+
+   std::string SharedCache::shapeOf(const CompressorOptions& options) {
+      std::string shape;
+      shape += static_cast<char>('0' + options.level);
+      shape += static_cast<char>('0' + static_cast<int>(options.type));
+      shape += options.useBundler ? 'b' : '-';
+      shape += options.pruneUnusedCSS ? 'p' : '-';
+      shape += options.omitOptionalTags ? 'o' : '-';
+      shape += options.memoizeFragments ? 'm' : '-';
+      shape += options.mangleNames ? 'n' : '-';
+      shape += options.dedupeInlineStyles ? 'y' : '-';
+      shape += options.dedupeInlineScripts ? 's' : '-';
+      shape += options.canonicalizeAttributes ? 'c' : '-';
+      shape += std::to_string(options.svgPrecision) + '|' + std::to_string(options.minifiedThreshold) + '|' + std::to_string(options.bundlerMinBytes) + '|' + options.scope;
+      for (const std::string& name : options.cssAllowlist) shape += '\n' + name;
+      shape += '\x1F';
+      for (const std::string& marker : options.fragmentMarkers) shape += '\n' + marker;
+      if (options.mangleNames) {
+         shape += '\x1F' + std::to_string(nameMapFingerprint());
+         for (const std::string& name : options.mangleAllowlist) shape += '\n' + name;
+      }
+      return shape;
+   }
+
+   SharedCache::Key SharedCache::keyOf(const CompressorOptions& options, std::string_view in) {
+      const uint64_t seed = hash64(shapeOf(options), kVersion);
+      return { hash64(in, seed), hash64(in, ~seed) };
+   }
+
+#ifdef _WIN32
+   bool SharedCache::open(const std::string&, size_t) {
+      return false;
+   }
+#else
+   bool SharedCache::open(const std::string& path, size_t heapBytes) {
+      static std::mutex openMutex;
+      std::lock_guard<std::mutex> lock(openMutex);
+      if (isOpen()) return path == mappedPath;
+
+      const uint64_t requestedHeap = alignUp(heapBytes < kMinHeapBytes ? kMinHeapBytes : heapBytes);
+
+      const int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+      if (fd < 0) return false;
+
+      // --- The creator initializes the file while holding the lock; later processes only map it ---
+      if (flock(fd, LOCK_EX) != 0) {
+         ::close(fd);
+         return false;
+      }
+
+      void* mapping = MAP_FAILED;
+      size_t fileBytes = 0;
+      struct stat info {};
+
+      if (fstat(fd, &info) == 0) {
+         Layout existing{};
+         const bool initialized = static_cast<size_t>(info.st_size) >= sizeof(Header) && pread(fd, &existing, sizeof(Layout), 0) == static_cast<ssize_t>(sizeof(Layout)) &&
+                                  std::memcmp(existing.magic, kMagic, sizeof(kMagic)) == 0;
+
+         if (initialized) {
+            const bool compatible = existing.version == kVersion && existing.headerBytes == sizeof(Header) && existing.heapBytes > 0 &&
+                                    existing.slotCount > 0 && (existing.slotCount & (existing.slotCount - 1)) == 0;
+            fileBytes = sizeof(Header) + existing.slotCount * sizeof(Slot) + existing.heapBytes;
+            if (compatible && static_cast<size_t>(info.st_size) == fileBytes) {
+               mapping = mmap(nullptr, fileBytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            }
+         } else {
+            // --- New, or left behind by a creator that died before writing the magic ---
+            const uint64_t slotCount = roundUpPowerOfTwo(requestedHeap / kHeapBytesPerSlot);
+            fileBytes = sizeof(Header) + slotCount * sizeof(Slot) + requestedHeap;
+
+            if (ftruncate(fd, 0) == 0 && ftruncate(fd, static_cast<off_t>(fileBytes)) == 0) {
+               mapping = mmap(nullptr, fileBytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            }
+            if (mapping != MAP_FAILED) {
+               // --- The file is zero-filled: every slot is empty and head is 0 ---
+               Layout& created = static_cast<Header*>(mapping)->layout;
+               created.version = kVersion;
+               created.headerBytes = sizeof(Header);
+               created.slotCount = slotCount;
+               created.heapBytes = requestedHeap;
+               std::atomic_thread_fence(std::memory_order_release);
+               std::memcpy(created.magic, kMagic, sizeof(kMagic));
+            }
+         }
+      }
+
+      flock(fd, LOCK_UN);
+      ::close(fd);
+      if (mapping == MAP_FAILED) return false;
+
+      mappedPath = path;
+      header.store(static_cast<Header*>(mapping), std::memory_order_release);
+      return true;
+   }
+#endif
+
+   bool SharedCache::find(const Key& key, std::string& out, CompressResult& result) const {
+      const Header* mapped = header.load(std::memory_order_acquire);
+      if (mapped == nullptr) return false;
+
+      const Slot* slots = mapped->slots();
+      const uint64_t mask = mapped->layout.slotCount - 1;
+
+      for (uint64_t probe = 0; probe < kProbeLength; ++probe) {
+         const Slot& slot = slots[(key.low + probe) & mask];
+         if (slot.tag.load(std::memory_order_acquire) != key.low) continue;
+
+         const uint64_t position = slot.position.load(std::memory_order_acquire);
+         if (position != 0 && readRecord(mapped, position - 1, key, out, result)) return true;
+      }
+      return false;
+   }
+
+   bool SharedCache::readRecord(const Header* mapped, uint64_t start, const Key& key, std::string& out, CompressResult& result) const {
+      const uint64_t heapBytes = mapped->layout.heapBytes;
+      if (mapped->head.load(std::memory_order_acquire) > start + heapBytes) return false;
+
+      const uint64_t offset = start % heapBytes;
+      if (offset + sizeof(Record) > heapBytes) return false;
+
+      Record record;
+      std::memcpy(&record, mapped->heap() + offset, sizeof(Record));
+      if (record.keyLow != key.low || record.keyHigh != key.high || record.length > heapBytes - offset - sizeof(Record)) return false;
+
+      out.assign(mapped->heap() + offset + sizeof(Record), record.length);
+
+      // --- A writer that reserved over the record while it was copied has moved head past it ---
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (mapped->head.load(std::memory_order_relaxed) > start + heapBytes) return false;
+
+      // --- Catches a record torn by a writer that was lapped by the ring ---
+      if (hash64(out) != record.outputHash) return false;
+
+      result.flags = record.flags;
+      result.hash = record.outputHash;
+      return true;
+   }
+
+   void SharedCache::store(const Key& key, std::string_view output, const CompressResult& result) {
+      Header* mapped = header.load(std::memory_order_acquire);
+      if (mapped == nullptr) return;
+
+      const uint64_t heapBytes = mapped->layout.heapBytes;
+      const uint64_t size = alignUp(sizeof(Record) + output.size());
+      if (size > heapBytes / kMaxRecordShare || output.size() > UINT32_MAX) return;
+
+      // --- Records never straddle the end of the ring: the tail is skipped instead ---
+      uint64_t head = mapped->head.load(std::memory_order_relaxed);
+      uint64_t start = 0;
+      do {
+         const uint64_t offset = head % heapBytes;
+         start = offset + size > heapBytes ? head + (heapBytes - offset) : head;
+      } while (!mapped->head.compare_exchange_weak(head, start + size, std::memory_order_acq_rel, std::memory_order_relaxed));
+
+      const Record record{ key.low, key.high, result.hash, static_cast<uint32_t>(output.size()), result.flags };
+      char* target = mapped->heap() + start % heapBytes;
+      std::memcpy(target, &record, sizeof(Record));
+      std::memcpy(target + sizeof(Record), output.data(), output.size());
+
+      // --- This key's slot, else an empty one, else the one holding the oldest record ---
+      Slot* slots = mapped->slots();
+      const uint64_t mask = mapped->layout.slotCount - 1;
+      Slot* chosen = nullptr;
+      uint64_t oldest = UINT64_MAX;
+
+      for (uint64_t probe = 0; probe < kProbeLength; ++probe) {
+         Slot& slot = slots[(key.low + probe) & mask];
+         const uint64_t tag = slot.tag.load(std::memory_order_relaxed);
+         if (tag == key.low) {
+            chosen = &slot;
+            break;
+         }
+
+         const uint64_t position = slot.position.load(std::memory_order_relaxed);
+         if (tag == 0 && position == 0) {
+            chosen = &slot;
+            break;
+         }
+         if (position < oldest) {
+            oldest = position;
+            chosen = &slot;
+         }
+      }
+
+      chosen->position.store(0, std::memory_order_relaxed);
+      chosen->tag.store(key.low, std::memory_order_relaxed);
+      chosen->position.store(start + 1, std::memory_order_release);
+   }
+
+} // namespace phpspa
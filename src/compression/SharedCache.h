@@ -0,0 +1,73 @@
+#ifndef PHPSPA_SHARED_CACHE_H
+#define PHPSPA_SHARED_CACHE_H
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include "Compressor.h"
+
+namespace phpspa {
+
+   /**
+    * Compressed outputs shared by every process that maps the same file
+    * (e.g. all PHP-FPM workers of a host), so results survive worker
+    * recycling and are stored once per host.
+    *
+    * Layout: a header, an open-addressing index of (tag, position) slots and
+    * a ring heap of records. Readers and writers never lock: writers reserve
+    * heap space with one CAS and publish a slot after writing the record;
+    * eviction is the ring wrapping over old records. A hit re-checks that its
+    * record was not overwritten while it was copied, and compares the full
+    * 128-bit key and the output hash, so races and torn records are misses.
+    *
+    * POSIX only; open() fails elsewhere.
+    */
+   class SharedCache {
+      public:
+         struct Key {
+            uint64_t low;
+            uint64_t high;
+         };
+
+         static SharedCache& instance();
+
+         // --- Every option that shapes the output, as bytes: options that compress alike have the same shape ---
+         static std::string shapeOf(const CompressorOptions& options);
+
+         // --- Key of in compressed with options: a hash of its shape and the input ---
+         static Key keyOf(const CompressorOptions& options, std::string_view in);
+
+         SharedCache(const SharedCache&) = delete;
+         SharedCache& operator=(const SharedCache&) = delete;
+
+         /**
+          * Map the cache file, creating it with about heapBytes of values if it
+          * does not exist (an existing file keeps its size). Once per process;
+          * the mapping lives until exit.
+          * @return false when the file cannot be mapped or was made by an incompatible build
+          */
+         bool open(const std::string& path, size_t heapBytes);
+
+         bool isOpen() const { return header.load(std::memory_order_acquire) != nullptr; }
+
+         // --- Copies a cached output into out; false on a miss ---
+         bool find(const Key& key, std::string& out, CompressResult& result) const;
+
+         void store(const Key& key, std::string_view output, const CompressResult& result);
+
+      private:
+         struct Header;
+         struct Slot;
+
+         SharedCache() = default;
+
+         bool readRecord(const Header* mapped, uint64_t start, const Key& key, std::string& out, CompressResult& result) const;
+
+         std::atomic<Header*> header{ nullptr };
+         std::string mappedPath;
+   };
+
+} // namespace phpspa
+
+#endif // PHPSPA_SHARED_CACHE_H
@@ -0,0 +1,90 @@
+#include "../HtmlCompressor.h"
+#include "../../utils/styleSheet.h"
+#include "../../utils/trace.h"
+
+#include <algorithm>
+#include <cctype>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+   struct InlineScript {
+      size_t bodyStart;
+      size_t bodyEnd;
+   };
+
+   bool isBlank(std::string_view text) {
+      return std::all_of(text.begin(), text.end(), [](char ch) { return std::isspace(static_cast<unsigned char>(ch)); });
+   }
+
+   // --- Inline JavaScript bodies, outside comments and raw text that merely looks like markup ---
+   std::vector<InlineScript> findInlineScripts(std::string_view html) {
+      std::vector<InlineScript> scripts;
+
+      for (size_t pos = html.find('<'); pos != std::string_view::npos; pos = html.find('<', pos + 1)) {
+         if (html.compare(pos, 4, "<!--") == 0) {
+            const size_t end = html.find("-->", pos + 4);
+            if (end == std::string_view::npos) break;
+            pos = end;
+            continue;
+         }
+
+         bool skipped = false;
+         for (const std::string_view inert : { "style", "textarea", "xmp" }) {
+            if (isTagAt(html, pos, inert)) {
+               const size_t close = findTagIgnoreCase(html, std::string("</") + std::string(inert), pos + 1);
+               if (close == std::string_view::npos) return scripts;
+               pos = close;
+               skipped = true;
+               break;
+            }
+         }
+         if (skipped || !isTagAt(html, pos, "script")) continue;
+
+         const size_t openEnd = html.find('>', pos);
+         const size_t close = openEnd == std::string_view::npos ? openEnd : findTagIgnoreCase(html, "</script", openEnd);
+         if (close == std::string_view::npos) break;
+
+         const std::string_view openTag = html.substr(pos, openEnd - pos + 1);
+         const std::string_view body = html.substr(openEnd + 1, close - openEnd - 1);
+
+         // --- "<!--" switches the tokenizer into escaped script data; leave such bodies alone ---
+         if (!hasAttribute(openTag, "src") && classifyScriptType(tagAttribute(openTag, "type")) == ScriptKind::JavaScript && !isBlank(body) && body.find("<!--") == std::string_view::npos) {
+            scripts.push_back({ openEnd + 1, close });
+         }
+         pos = close;
+      }
+      return scripts;
+   }
+
+   bool containsScriptClose(const std::string& js) {
+      return findTagIgnoreCase(js, "</script", 0) != std::string_view::npos;
+   }
+
+} // namespace
+
+void HtmlCompressor::bundleInlineScripts(std::string& html, char* debugOutput) {
+   TraceSpan span("bundleInlineScripts", static_cast<int64_t>(html.size()));
+   const std::vector<InlineScript> scripts = findInlineScripts(html);
+   if (scripts.empty()) return;
+   span.arg("scripts", static_cast<int64_t>(scripts.size()));
+
+   std::vector<std::string> sources;
+   sources.reserve(scripts.size());
+   for (const InlineScript& script : scripts) {
+      sources.emplace_back(html, script.bodyStart, script.bodyEnd - script.bodyStart);
+   }
+
+   // --- Inline classic scripts share the page's global scope ---
+   if (!minifyJSBatch(sources, "global", debugOutput)) return;
+
+   // --- Back to front, so earlier offsets stay valid ---
+   for (size_t i = scripts.size(); i-- > 0;) {
+      std::string& bundled = sources[i];
+      while (!bundled.empty() && std::isspace(static_cast<unsigned char>(bundled.back()))) bundled.pop_back();
+      if (bundled.empty() || containsScriptClose(bundled)) continue;
+
+      html.replace(scripts[i].bodyStart, scripts[i].bodyEnd - scripts[i].bodyStart, bundled);
+   }
+}
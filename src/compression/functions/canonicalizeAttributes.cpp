@@ -0,0 +1,140 @@
+#include "../HtmlCompressor.h"
+#include "../../utils/trim.h"
+
+#include <algorithm>
+#include <cctype>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+   struct Attribute {
+      std::string_view name;
+      std::string_view text; // --- name through the end of the value, quotes included ---
+   };
+
+   char lower(char ch) {
+      return static_cast<char>(std::tolower(static_cast<unsigned char>(ch)));
+   }
+
+   bool equalsLower(std::string_view text, std::string_view lowerText) {
+      return text.size() == lowerText.size() && std::equal(text.begin(), text.end(), lowerText.begin(), [](char a, char b) { return lower(a) == b; });
+   }
+
+   bool lessIgnoreCase(std::string_view a, std::string_view b) {
+      return std::lexicographical_compare(a.begin(), a.end(), b.begin(), b.end(), [](char x, char y) { return lower(x) < lower(y); });
+   }
+
+   // --- Framework directives (Alpine, Vue, htmx, Angular, Livewire) can be processed in the order they are written ---
+   bool orderSensitive(std::string_view name) {
+      if (!std::isalpha(static_cast<unsigned char>(name[0]))) return true;
+      for (const std::string_view prefix : { "x-", "v-", "hx-", "wire:" }) {
+         if (name.size() > prefix.size() && equalsLower(name.substr(0, prefix.size()), prefix)) return true;
+      }
+      return false;
+   }
+
+   // --- Split a start tag into its attributes and what follows the last one ("/>", " />", ">"); false for anything unusual ---
+   bool parseAttributes(std::string_view tag, size_t& nameEnd, std::vector<Attribute>& attributes, size_t& tailStart) {
+      size_t pos = 1;
+      while (pos < tag.size() && !isWhitespace(tag[pos]) && tag[pos] != '>' && tag[pos] != '/') ++pos;
+      nameEnd = pos;
+      tailStart = pos;
+
+      while (true) {
+         while (pos < tag.size() && isWhitespace(tag[pos])) ++pos;
+         if (pos >= tag.size()) return false;
+         if (tag[pos] == '>' || (tag[pos] == '/' && pos + 1 < tag.size() && tag[pos + 1] == '>')) return pos + (tag[pos] == '/' ? 2 : 1) == tag.size();
+         if (tag[pos] == '/') return false;
+
+         const size_t start = pos;
+         while (pos < tag.size() && !isWhitespace(tag[pos]) && tag[pos] != '=' && tag[pos] != '>' && tag[pos] != '/') ++pos;
+         const std::string_view name = tag.substr(start, pos - start);
+         if (name.empty()) return false;
+
+         if (pos < tag.size() && tag[pos] == '=') {
+            ++pos;
+            if (pos < tag.size() && (tag[pos] == '"' || tag[pos] == '\'')) {
+               const size_t close = tag.find(tag[pos], pos + 1);
+               if (close == std::string_view::npos) return false;
+               pos = close + 1;
+            } else {
+               while (pos < tag.size() && !isWhitespace(tag[pos]) && tag[pos] != '>') ++pos;
+            }
+         }
+         attributes.push_back({ name, tag.substr(start, pos - start) });
+         tailStart = pos;
+      }
+   }
+
+   // --- Template syntax left unrendered ({{ x }}, ${x}, <?= x ?>), whose tokens are not class names ---
+   bool hasTemplateSyntax(std::string_view value) {
+      for (const std::string_view marker : { "{{", "${", "<?" }) {
+         if (value.find(marker) != std::string_view::npos) return true;
+      }
+      return false;
+   }
+
+   // --- class="b a b" -> class="a b": the token set is what selectors and classList see ---
+   void appendSortedClass(std::string_view text, std::string& out) {
+      const size_t equals = text.find('=');
+      if (equals == std::string_view::npos || hasTemplateSyntax(text.substr(equals + 1))) {
+         out.append(text);
+         return;
+      }
+
+      std::string_view value = text.substr(equals + 1);
+      const char quote = !value.empty() && (value[0] == '"' || value[0] == '\'') ? value[0] : '\0';
+      if (quote != '\0') value = value.substr(1, value.size() - 2);
+
+      std::vector<std::string_view> tokens;
+      size_t pos = 0;
+      while (pos < value.size()) {
+         while (pos < value.size() && isWhitespace(value[pos])) ++pos;
+         const size_t start = pos;
+         while (pos < value.size() && !isWhitespace(value[pos])) ++pos;
+         if (pos > start) tokens.push_back(value.substr(start, pos - start));
+      }
+      std::sort(tokens.begin(), tokens.end());
+      tokens.erase(std::unique(tokens.begin(), tokens.end()), tokens.end());
+
+      out.append(text.substr(0, equals + 1));
+      if (quote != '\0') out += quote;
+      for (size_t i = 0; i < tokens.size(); ++i) {
+         if (i > 0) out += ' ';
+         out.append(tokens[i]);
+      }
+      if (quote != '\0') out += quote;
+   }
+
+} // namespace
+
+void HtmlCompressor::canonicalizeAttributes(const std::string& tagContent, std::string& out) {
+   out.clear();
+
+   // --- Element start tags only: not <!DOCTYPE ...>, <![CDATA[ or <?xml ...?> ---
+   std::vector<Attribute> attributes;
+   size_t nameEnd = 0;
+   size_t tailStart = 0;
+   if (tagContent.size() < 3 || !std::isalpha(static_cast<unsigned char>(tagContent[1])) || !parseAttributes(tagContent, nameEnd, attributes, tailStart) || attributes.empty()) {
+      out = tagContent;
+      return;
+   }
+
+   // --- Stable, so of two attributes with the same name the first (the one the parser keeps) stays first ---
+   const bool sortable = std::none_of(attributes.begin(), attributes.end(), [](const Attribute& attribute) { return orderSensitive(attribute.name); });
+   if (sortable) {
+      std::stable_sort(attributes.begin(), attributes.end(), [](const Attribute& a, const Attribute& b) { return lessIgnoreCase(a.name, b.name); });
+   }
+
+   out.append(tagContent, 0, nameEnd);
+   for (const Attribute& attribute : attributes) {
+      out += ' ';
+      if (equalsLower(attribute.name, "class")) {
+         appendSortedClass(attribute.text, out);
+      } else {
+         out.append(attribute.text);
+      }
+   }
+   out.append(tagContent, tailStart, std::string::npos);
+}
@@ -0,0 +1,124 @@
+#include <cstring>
+#include "../HtmlCompressor.h"
+#include "../../utils/scan.h"
+#include "../../utils/trim.h"
+
+namespace {
+
+   struct RawTextTag {
+      const char* name;
+      size_t length;
+   };
+
+   constexpr RawTextTag kRawTextTags[] = { { "pre", 3 }, { "textarea", 8 }, { "script", 6 }, { "style", 5 }, { "code", 4 } };
+
+   // --- ASCII case-insensitive match of a lowercase name; folding with 0x20 is exact for letters ---
+   bool matchesName(const std::string& html, size_t pos, const char* name, size_t nameLength) {
+      if (pos + nameLength > html.size()) return false;
+      for (size_t i = 0; i < nameLength; ++i) {
+         if ((static_cast<unsigned char>(html[pos + i]) | 0x20) != static_cast<unsigned char>(name[i])) return false;
+      }
+      return true;
+   }
+
+   // --- Raw-text element opened by the tag at pos, or nullptr ---
+   const RawTextTag* rawTextTag(const std::string& html, size_t pos) {
+      if (pos + 1 >= html.size()) return nullptr;
+
+      const char first = static_cast<char>(html[pos + 1] | 0x20);
+      if (first != 'p' && first != 't' && first != 's' && first != 'c') return nullptr;
+
+      for (const RawTextTag& tag : kRawTextTags) {
+         if (tag.name[0] != first || !matchesName(html, pos + 1, tag.name, tag.length)) continue;
+
+         const size_t after = pos + 1 + tag.length;
+         if (after == html.size() || html[after] == '>' || html[after] == '/' || isWhitespace(html[after])) return &tag;
+      }
+      return nullptr;
+   }
+
+   // --- End of the element whose body starts at from: just past its closing tag, or the end of the input ---
+   size_t rawTextEnd(const std::string& html, size_t from, const RawTextTag& tag) {
+      for (size_t pos = html.find("</", from); pos != std::string::npos; pos = html.find("</", pos + 2)) {
+         if (!matchesName(html, pos + 2, tag.name, tag.length)) continue;
+
+         const size_t tagEnd = html.find('>', pos);
+         return tagEnd == std::string::npos ? html.size() : tagEnd + 1;
+      }
+      return html.size();
+   }
+
+} // namespace
+
+/**
+ * Text is copied in runs found by a vectorized scan for the few bytes that
+ * need a decision: '<', and whitespace other than a single space. Tags are
+ * copied as they are (no name folding, no attribute pass), and the bodies of
+ * pre/textarea/script/style/code are copied up to their closing tag.
+ *
+ * A whitespace run becomes one space, and is dropped between two tags and
+ * at the ends of the document. Comments are dropped without separating the
+ * whitespace around them.
+ */
+void HtmlCompressor::collapseWhitespace(std::string& html) {
+   const size_t length = html.size();
+   size_t readPos = 0;
+   size_t writePos = 0;
+   bool pendingSpace = false;
+
+   auto copy = [&](size_t count) {
+      if (writePos != readPos) std::memmove(&html[writePos], &html[readPos], count);
+      writePos += count;
+      readPos += count;
+   };
+
+   while (readPos < length) {
+      const size_t stop = findMarkupStop(html, readPos);
+
+      if (stop > readPos) {
+         if (pendingSpace) {
+            if (writePos > 0) html[writePos++] = ' ';
+            pendingSpace = false;
+         } else if (html[readPos] == ' ' && (writePos == 0 || html[writePos - 1] == ' ')) {
+            // --- A single space at the start, or after a dropped comment that followed one ---
+            ++readPos;
+         }
+         copy(stop - readPos);
+         continue;
+      }
+
+      if (html[readPos] != '<') {
+         while (readPos < length && isWhitespace(html[readPos])) ++readPos;
+         pendingSpace = true;
+         continue;
+      }
+
+      if (readPos + 3 < length && html[readPos + 1] == '!' && html[readPos + 2] == '-' && html[readPos + 3] == '-') {
+         const size_t commentEnd = html.find("-->", readPos + 4);
+         readPos = commentEnd == std::string::npos ? length : commentEnd + 3;
+         continue;
+      }
+
+      // --- Whitespace between two tags is dropped; after text it stays one space ---
+      if (pendingSpace) {
+         if (writePos > 0 && html[writePos - 1] != '>') html[writePos++] = ' ';
+         pendingSpace = false;
+      } else if (writePos >= 2 && html[writePos - 1] == ' ' && html[writePos - 2] == '>') {
+         --writePos;
+      }
+
+      size_t end = 0;
+      if (const RawTextTag* tag = rawTextTag(html, readPos)) {
+         const size_t tagEnd = html.find('>', readPos);
+         end = tagEnd == std::string::npos ? length : rawTextEnd(html, tagEnd + 1, *tag);
+      } else {
+         const size_t tagEnd = html.find('>', readPos);
+         end = tagEnd == std::string::npos ? length : tagEnd + 1;
+      }
+      copy(end - readPos);
+   }
+
+   // --- A space kept before a comment that turned out to end the document ---
+   if (writePos > 0 && html[writePos - 1] == ' ') --writePos;
+   html.resize(writePos);
+}
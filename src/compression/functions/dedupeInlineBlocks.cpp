@@ -0,0 +1,160 @@
+#include "../HtmlCompressor.h"
+#include "../../utils/hash.h"
+#include "../../utils/styleSheet.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+   enum class BlockKind { Style, Script };
+
+   // --- A whole element, start tag to end of the end tag ---
+   struct InlineBlock {
+      BlockKind kind;
+      size_t start;
+      size_t end;
+      size_t group = SIZE_MAX; // --- index of the run of identical blocks it belongs to ---
+   };
+
+   constexpr std::string_view kFragmentPlaceholderMark = "\x1A";
+
+   std::string lowerAttribute(std::string_view tag, std::string_view lowerName) {
+      std::string value = tagAttribute(tag, lowerName);
+      std::transform(value.begin(), value.end(), value.begin(), [](unsigned char ch) { return static_cast<char>(std::tolower(ch)); });
+      return value;
+   }
+
+   // --- Stylesheets and inline scripts that apply where they stand: not in comments, templates or raw text ---
+   std::vector<InlineBlock> findInlineBlocks(std::string_view html, bool styles, bool scripts) {
+      std::vector<InlineBlock> blocks;
+
+      for (size_t pos = html.find('<'); pos != std::string_view::npos; pos = html.find('<', pos + 1)) {
+         if (html.compare(pos, 4, "<!--") == 0) {
+            const size_t end = html.find("-->", pos + 4);
+            if (end == std::string_view::npos) break;
+            pos = end;
+            continue;
+         }
+
+         bool skipped = false;
+         for (const std::string_view inert : { "template", "noscript", "textarea", "xmp" }) {
+            if (isTagAt(html, pos, inert)) {
+               const size_t close = findTagIgnoreCase(html, std::string("</") + std::string(inert), pos + 1);
+               if (close == std::string_view::npos) return blocks;
+               pos = close;
+               skipped = true;
+               break;
+            }
+         }
+         if (skipped) continue;
+
+         const bool style = isTagAt(html, pos, "style");
+         if (!style && !isTagAt(html, pos, "script")) continue;
+
+         const size_t openEnd = html.find('>', pos);
+         const size_t close = openEnd == std::string_view::npos ? openEnd : findTagIgnoreCase(html, style ? "</style" : "</script", openEnd);
+         const size_t closeEnd = close == std::string_view::npos ? close : html.find('>', close);
+         if (closeEnd == std::string_view::npos) break;
+
+         const std::string_view openTag = html.substr(pos, openEnd - pos + 1);
+         if (style) {
+            const std::string type = lowerAttribute(openTag, "type");
+            if (styles && (type.empty() || type == "text/css")) blocks.push_back({ BlockKind::Style, pos, closeEnd + 1 });
+         } else if (scripts) {
+            // --- A script reading document.currentScript works on the copy where it stands ---
+            const std::string_view body = html.substr(openEnd + 1, close - openEnd - 1);
+            if (!hasAttribute(openTag, "src") && classifyScriptType(tagAttribute(openTag, "type")) == ScriptKind::JavaScript &&
+                body.find("currentScript") == std::string_view::npos) {
+               blocks.push_back({ BlockKind::Script, pos, closeEnd + 1 });
+            }
+         }
+         pos = closeEnd;
+      }
+      return blocks;
+   }
+
+   // --- Number the runs of byte-identical blocks of one kind; returns how many runs repeat ---
+   size_t groupIdentical(std::string_view html, std::vector<InlineBlock>& blocks, std::vector<std::vector<size_t>>& groups) {
+      std::unordered_map<uint64_t, size_t> byHash;
+      byHash.reserve(blocks.size());
+
+      for (size_t i = 0; i < blocks.size(); ++i) {
+         InlineBlock& block = blocks[i];
+         const std::string_view bytes = html.substr(block.start, block.end - block.start);
+         const auto [it, inserted] = byHash.emplace(hash64(bytes, static_cast<uint64_t>(block.kind)), groups.size());
+         if (inserted) {
+            groups.push_back({ i });
+            block.group = it->second;
+            continue;
+         }
+
+         // --- A hash collision leaves the block alone ---
+         const InlineBlock& first = blocks[groups[it->second].front()];
+         if (html.substr(first.start, first.end - first.start) != bytes) continue;
+         groups[it->second].push_back(i);
+         block.group = it->second;
+      }
+      return static_cast<size_t>(std::count_if(groups.begin(), groups.end(), [](const std::vector<size_t>& group) { return group.size() > 1; }));
+   }
+
+   /**
+    * Copy of a repeated stylesheet that can stand for all of them.
+    *
+    * Keeping the last copy never changes the cascade: the earlier copies
+    * only ever lose to it. The first copy is kept (styling the elements
+    * above the others while the page streams in) when nothing between the
+    * copies could win over it: no other stylesheet, <link> or fragment
+    * spliced in later.
+    */
+   size_t styleToKeep(std::string_view html, const std::vector<InlineBlock>& blocks, const std::vector<size_t>& copies) {
+      const size_t first = copies.front();
+      const size_t last = copies.back();
+
+      for (size_t i = first + 1; i < last; ++i) {
+         if (blocks[i].kind == BlockKind::Style && blocks[i].group != blocks[first].group) return last;
+      }
+
+      const std::string_view between = html.substr(blocks[first].end, blocks[last].start - blocks[first].end);
+      if (findTagIgnoreCase(between, "<link", 0) != std::string_view::npos || between.find(kFragmentPlaceholderMark) != std::string_view::npos) return last;
+      return first;
+   }
+
+} // namespace
+
+void HtmlCompressor::dedupeInlineBlocks(std::string& html) {
+   if (!settings.dedupeInlineStyles && !settings.dedupeInlineScripts) return;
+
+   std::vector<InlineBlock> blocks = findInlineBlocks(html, settings.dedupeInlineStyles, settings.dedupeInlineScripts);
+   if (blocks.size() < 2) return;
+
+   std::vector<std::vector<size_t>> groups;
+   if (groupIdentical(html, blocks, groups) == 0) return;
+
+   std::vector<bool> removed(blocks.size(), false);
+   for (const std::vector<size_t>& copies : groups) {
+      if (copies.size() < 2) continue;
+
+      // --- A script runs once, after the markup of every instance that repeated it ---
+      const size_t kept = blocks[copies.front()].kind == BlockKind::Style ? styleToKeep(html, blocks, copies) : copies.back();
+      for (const size_t index : copies) {
+         if (index == kept) continue;
+         removed[index] = true;
+      }
+   }
+
+   std::string deduped;
+   deduped.reserve(html.size());
+   size_t pos = 0;
+   for (size_t i = 0; i < blocks.size(); ++i) {
+      if (!removed[i]) continue;
+      deduped.append(html, pos, blocks[i].start - pos);
+      pos = blocks[i].end;
+   }
+   deduped.append(html, pos, std::string::npos);
+   html.swap(deduped);
+}
@@ -0,0 +1,65 @@
+#include "../HtmlCompressor.h"
+#include "../../utils/scan.h"
+
+namespace {
+
+   constexpr size_t kMinimumLength = 512;     // --- Small inputs are cheap to minify anyway ---
+   constexpr size_t kMinimumLineLength = 160; // --- Minifiers emit few, long lines ---
+
+   // --- Bytes inside commentOpen ... commentClose, delimiters included; an unclosed comment runs to the end ---
+   size_t commentBytes(std::string_view text, std::string_view commentOpen, std::string_view commentClose) {
+      size_t bytes = 0;
+      for (size_t pos = text.find(commentOpen); pos != std::string_view::npos; pos = text.find(commentOpen, pos)) {
+         const size_t close = text.find(commentClose, pos + commentOpen.size());
+         const size_t end = close == std::string_view::npos ? text.size() : close + commentClose.size();
+         bytes += end - pos;
+         pos = end;
+      }
+      return bytes;
+   }
+
+   /**
+    * Whether text is compact enough to pass through. A pass-through must
+    * match what minifying would give, so in markup and stylesheets any
+    * comment (even a license banner) rules it out. In scripts a comment
+    * opener can sit in strings and regex literals, so there block comments
+    * count as the bytes they span instead.
+    */
+   bool looksMinified(std::string_view text, char open, char next1, char next2, std::string_view commentOpen, std::string_view commentClose, bool commentsDisqualify) {
+      const double threshold = HtmlCompressor::settings.minifiedThreshold;
+      if (threshold > 1.0 || text.size() < kMinimumLength) {
+         return false;
+      }
+
+      const TextDensity density = measureDensity(text, open, next1, next2);
+      if (density.length / (density.newlines + 1) < kMinimumLineLength) {
+         return false;
+      }
+
+      // --- Comments are looked for only in inputs that already passed the cheap checks ---
+      size_t comments = 0;
+      if (density.commentMarkers > 0) {
+         if (commentsDisqualify) {
+            if (text.find(commentOpen) != std::string_view::npos) return false;
+         } else {
+            comments = commentBytes(text, commentOpen, commentClose);
+         }
+      }
+      const double redundant = static_cast<double>(density.whitespace + comments);
+      return 1.0 - redundant / static_cast<double>(density.length) >= threshold;
+   }
+
+} // namespace
+
+bool HtmlCompressor::isMinifiedHTML(std::string_view html) {
+   return looksMinified(html, '<', '!', '!', "<!--", "-->", true);
+}
+
+bool HtmlCompressor::isMinifiedCSS(std::string_view css) {
+   return looksMinified(css, '/', '*', '*', "/*", "*/", true);
+}
+
+bool HtmlCompressor::isMinifiedJS(std::string_view js) {
+   // --- "//" also starts URLs and regex literals; only block comments are counted ---
+   return looksMinified(js, '/', '*', '/', "/*", "*/", false);
+}
@@ -0,0 +1,576 @@
+#include "../HtmlCompressor.h"
+#include "../../utils/nameMap.h"
+#include "../../utils/trim.h"
+
+#include <algorithm>
+#include <cctype>
+#include <iterator>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+   // --- Attributes holding space-separated id references ---
+   constexpr std::string_view kIdReferenceAttributes[] = {
+      "for", "form", "list", "headers", "popovertarget", "aria-activedescendant", "aria-controls", "aria-describedby",
+      "aria-details", "aria-errormessage", "aria-flowto", "aria-labelledby", "aria-owns",
+   };
+
+   enum class ScriptArgument { ClassName, ClassNames, IdName, Selector };
+
+   struct ScriptCall {
+      std::string_view method;
+      ScriptArgument argument;
+      bool everyArgument; // --- classList.add("a", "b"): each string argument is a name ---
+      bool onClassList;
+   };
+
+   // --- DOM calls whose string literal arguments name classes or ids ---
+   constexpr ScriptCall kScriptCalls[] = {
+      { "add", ScriptArgument::ClassName, true, true },
+      { "remove", ScriptArgument::ClassName, true, true },
+      { "toggle", ScriptArgument::ClassName, false, true },
+      { "contains", ScriptArgument::ClassName, false, true },
+      { "replace", ScriptArgument::ClassName, true, true },
+      { "querySelector", ScriptArgument::Selector, false, false },
+      { "querySelectorAll", ScriptArgument::Selector, false, false },
+      { "closest", ScriptArgument::Selector, false, false },
+      { "matches", ScriptArgument::Selector, false, false },
+      { "getElementById", ScriptArgument::IdName, false, false },
+      { "getElementsByClassName", ScriptArgument::ClassNames, false, false },
+   };
+
+   std::string_view trimSpace(std::string_view value) {
+      while (!value.empty() && isWhitespace(value.front())) value.remove_prefix(1);
+      while (!value.empty() && isWhitespace(value.back())) value.remove_suffix(1);
+      return value;
+   }
+
+   bool equalsLower(std::string_view value, std::string_view lower) {
+      if (value.size() != lower.size()) return false;
+      for (size_t i = 0; i < value.size(); ++i) {
+         if (std::tolower(static_cast<unsigned char>(value[i])) != lower[i]) return false;
+      }
+      return true;
+   }
+
+   // --- "name", ".name", "#id" and "prefix-*" entries, as in the CSS allowlist ---
+   bool allowlisted(NameKind kind, std::string_view name, const std::vector<std::string>* allowlist) {
+      if (allowlist == nullptr) return false;
+
+      for (const std::string& entry : *allowlist) {
+         std::string_view pattern = entry;
+         if (pattern.empty()) continue;
+
+         if (pattern.back() == '*') {
+            pattern.remove_suffix(1);
+            if (!pattern.empty() && (pattern.front() == '#' || pattern.front() == '.')) pattern.remove_prefix(1);
+            if (name.compare(0, pattern.size(), pattern) == 0) return true;
+         } else if (pattern.front() == '#') {
+            if (kind == NameKind::Id && pattern.substr(1) == name) return true;
+         } else {
+            if (pattern.front() == '.') pattern.remove_prefix(1);
+            if (kind == NameKind::Class && pattern == name) return true;
+         }
+      }
+      return false;
+   }
+
+   // --- Short name for name; false when it stays as written (allowlisted, or unknown to a loaded map) ---
+   bool mangleName(NameKind kind, std::string_view name, std::string& out) {
+      // --- Names added at runtime by code the compressor never sees ---
+      if (allowlisted(kind, name, HtmlCompressor::settings.cssAllowlist) || allowlisted(kind, name, HtmlCompressor::settings.mangleAllowlist)) {
+         keepName(kind, name);
+         return false;
+      }
+      return shortNameFor(kind, name, out);
+   }
+
+   void mangleTokens(NameKind kind, std::string_view value, std::string& out) {
+      std::string shortName;
+      size_t pos = 0;
+      while (pos < value.size()) {
+         if (isWhitespace(value[pos])) {
+            out += value[pos++];
+            continue;
+         }
+
+         size_t end = pos;
+         while (end < value.size() && !isWhitespace(value[end])) ++end;
+         const std::string_view token = value.substr(pos, end - pos);
+
+         // --- A character reference would have to be decoded to find the name ---
+         if (token.find('&') == std::string_view::npos && mangleName(kind, token, shortName)) {
+            out += shortName;
+         } else {
+            out += token;
+         }
+         pos = end;
+      }
+   }
+
+   bool isNameStart(char ch) {
+      return std::isalpha(static_cast<unsigned char>(ch)) || ch == '_' || ch == '-' || ch == '\\' || static_cast<unsigned char>(ch) >= 0x80;
+   }
+
+   bool isNameChar(char ch) {
+      return isNameStart(ch) || std::isdigit(static_cast<unsigned char>(ch));
+   }
+
+   void appendUtf8(std::string& out, unsigned long code) {
+      if (code == 0 || code > 0x10FFFF || (code >= 0xD800 && code <= 0xDFFF)) code = 0xFFFD;
+      if (code < 0x80) {
+         out += static_cast<char>(code);
+      } else if (code < 0x800) {
+         out += static_cast<char>(0xC0 | (code >> 6));
+         out += static_cast<char>(0x80 | (code & 0x3F));
+      } else if (code < 0x10000) {
+         out += static_cast<char>(0xE0 | (code >> 12));
+         out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+         out += static_cast<char>(0x80 | (code & 0x3F));
+      } else {
+         out += static_cast<char>(0xF0 | (code >> 18));
+         out += static_cast<char>(0x80 | ((code >> 12) & 0x3F));
+         out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+         out += static_cast<char>(0x80 | (code & 0x3F));
+      }
+   }
+
+   // --- Reads a CSS identifier at pos, resolving escapes ("md\:flex" -> "md:flex") ---
+   void readCssName(std::string_view text, size_t& pos, std::string& name) {
+      name.clear();
+      while (pos < text.size()) {
+         const char ch = text[pos];
+         if (ch == '\\') {
+            if (pos + 1 >= text.size() || text[pos + 1] == '\n') break;
+            ++pos;
+            if (std::isxdigit(static_cast<unsigned char>(text[pos]))) {
+               unsigned long code = 0;
+               const size_t start = pos;
+               while (pos < text.size() && pos - start < 6 && std::isxdigit(static_cast<unsigned char>(text[pos]))) {
+                  code = code * 16 + static_cast<unsigned long>(std::isdigit(static_cast<unsigned char>(text[pos])) ? text[pos] - '0' : (std::tolower(static_cast<unsigned char>(text[pos])) - 'a' + 10));
+                  ++pos;
+               }
+               appendUtf8(name, code);
+               if (pos < text.size() && isWhitespace(text[pos])) ++pos;
+            } else {
+               name += text[pos++];
+            }
+            continue;
+         }
+         if (!isNameChar(ch)) break;
+         name += ch;
+         ++pos;
+      }
+   }
+
+   // --- End of the string literal opened at pos (after its closing quote) ---
+   size_t skipString(std::string_view text, size_t pos) {
+      const char quote = text[pos++];
+      while (pos < text.size()) {
+         const char ch = text[pos++];
+         if (ch == '\\' && pos < text.size()) {
+            ++pos;
+         } else if (ch == quote) {
+            break;
+         }
+      }
+      return pos;
+   }
+
+   // --- [id=x] and [class~=x] compare whole names; other attribute selectors are copied as written ---
+   void mangleAttributeSelector(std::string_view selector, size_t& pos, std::string& out) {
+      size_t close = pos + 1;
+      while (close < selector.size() && selector[close] != ']') {
+         close = selector[close] == '"' || selector[close] == '\'' ? skipString(selector, close) : close + 1;
+      }
+      if (close >= selector.size()) {
+         out.append(selector.substr(pos));
+         pos = selector.size();
+         return;
+      }
+
+      const std::string_view inner = selector.substr(pos + 1, close - pos - 1);
+      const size_t operatorStart = inner.find_first_of("~|^$*=");
+      size_t valueStart = operatorStart == std::string_view::npos ? operatorStart : inner.find('=', operatorStart);
+      const std::string_view name = trimSpace(inner.substr(0, operatorStart == std::string_view::npos ? inner.size() : operatorStart));
+      const std::string_view op = operatorStart == std::string_view::npos ? std::string_view() : inner.substr(operatorStart, valueStart - operatorStart + 1);
+
+      const bool idMatch = equalsLower(name, "id") && op == "=";
+      const bool classMatch = equalsLower(name, "class") && op == "~=";
+      if (idMatch || classMatch) {
+         ++valueStart;
+         while (valueStart < inner.size() && isWhitespace(inner[valueStart])) ++valueStart;
+
+         const char quote = valueStart < inner.size() && (inner[valueStart] == '"' || inner[valueStart] == '\'') ? inner[valueStart] : '\0';
+         const size_t nameStart = valueStart + (quote != '\0' ? 1 : 0);
+         size_t nameEnd = nameStart;
+         while (nameEnd < inner.size() && (quote != '\0' ? inner[nameEnd] != quote : !isWhitespace(inner[nameEnd]))) ++nameEnd;
+         const std::string_view value = inner.substr(nameStart, nameEnd - nameStart);
+
+         std::string shortName;
+         if (!value.empty() && value.find('\\') == std::string_view::npos && (quote == '\0' || nameEnd < inner.size()) &&
+             mangleName(idMatch ? NameKind::Id : NameKind::Class, value, shortName)) {
+            out.append(selector.substr(pos, 1 + nameStart));
+            out += shortName;
+            out.append(inner.substr(nameEnd));
+            out += ']';
+            pos = close + 1;
+            return;
+         }
+      }
+
+      out.append(selector.substr(pos, close + 1 - pos));
+      pos = close + 1;
+   }
+
+   // --- Rewrites .class and #id in a selector list, leaving strings, comments and other attribute selectors alone ---
+   void mangleSelector(std::string_view selector, std::string& out) {
+      std::string name;
+      std::string shortName;
+      size_t pos = 0;
+
+      while (pos < selector.size()) {
+         const char ch = selector[pos];
+
+         if (ch == '"' || ch == '\'') {
+            const size_t end = skipString(selector, pos);
+            out.append(selector.substr(pos, end - pos));
+            pos = end;
+            continue;
+         }
+         if (ch == '/' && pos + 1 < selector.size() && selector[pos + 1] == '*') {
+            const size_t close = selector.find("*/", pos + 2);
+            const size_t end = close == std::string_view::npos ? selector.size() : close + 2;
+            out.append(selector.substr(pos, end - pos));
+            pos = end;
+            continue;
+         }
+         if (ch == '\\' && pos + 1 < selector.size()) {
+            out.append(selector.substr(pos, 2));
+            pos += 2;
+            continue;
+         }
+         if (ch == '[') {
+            mangleAttributeSelector(selector, pos, out);
+            continue;
+         }
+
+         // --- ".5" in a keyframe selector is a number, not a class ---
+         const bool startsName = pos + 1 < selector.size() && isNameStart(selector[pos + 1]) &&
+                                 !(selector[pos + 1] == '-' && pos + 2 < selector.size() && std::isdigit(static_cast<unsigned char>(selector[pos + 2])));
+         if ((ch == '.' || ch == '#') && startsName) {
+            size_t end = pos + 1;
+            readCssName(selector, end, name);
+            if (!name.empty() && mangleName(ch == '.' ? NameKind::Class : NameKind::Id, name, shortName)) {
+               out += ch;
+               out += shortName;
+            } else {
+               out.append(selector.substr(pos, end - pos));
+            }
+            pos = end;
+            continue;
+         }
+
+         out += ch;
+         ++pos;
+      }
+   }
+
+   // --- url(#id) references (SVG gradients, clip paths, masks, filters, markers) ---
+   void mangleUrlReferences(std::string_view text, std::string& out) {
+      std::string shortName;
+      size_t pos = 0;
+
+      while (pos < text.size()) {
+         const size_t found = text.find("url(", pos);
+         if (found == std::string_view::npos) break;
+
+         size_t hash = found + 4;
+         const char quote = hash < text.size() && (text[hash] == '"' || text[hash] == '\'') ? text[hash] : '\0';
+         if (quote != '\0') ++hash;
+
+         if (hash < text.size() && text[hash] == '#') {
+            size_t end = hash + 1;
+            while (end < text.size() && text[end] != ')' && text[end] != quote && !isWhitespace(text[end]) && text[end] != '\\') ++end;
+            const std::string_view id = text.substr(hash + 1, end - hash - 1);
+            if (!id.empty() && end < text.size() && text[end] != '\\' && mangleName(NameKind::Id, id, shortName)) {
+               out.append(text.substr(pos, hash + 1 - pos));
+               out += shortName;
+               pos = end;
+               continue;
+            }
+         }
+
+         out.append(text.substr(pos, hash - pos));
+         pos = hash;
+      }
+      out.append(text.substr(pos));
+   }
+
+   void mangleScriptArgument(ScriptArgument argument, std::string_view literal, std::string& out) {
+      std::string shortName;
+      switch (argument) {
+         case ScriptArgument::ClassName:
+         case ScriptArgument::IdName: {
+            const NameKind kind = argument == ScriptArgument::ClassName ? NameKind::Class : NameKind::Id;
+            if (!literal.empty() && mangleName(kind, literal, shortName)) {
+               out += shortName;
+            } else {
+               out += literal;
+            }
+            break;
+         }
+         case ScriptArgument::ClassNames: mangleTokens(NameKind::Class, literal, out); break;
+         case ScriptArgument::Selector: mangleSelector(literal, out); break;
+      }
+   }
+
+   // --- A '/' after an operator, an opening bracket or nothing starts a regex literal rather than a division ---
+   bool startsRegex(std::string_view js, size_t pos) {
+      while (pos > 0 && isWhitespace(js[pos - 1])) --pos;
+      if (pos == 0) return true;
+      const char previous = js[pos - 1];
+      return std::string_view("(,=:[!&|?{};+-*%<>~^").find(previous) != std::string_view::npos;
+   }
+
+   // --- End of the regex literal at pos (after its flags) ---
+   size_t skipRegex(std::string_view js, size_t pos) {
+      bool inClass = false;
+      for (++pos; pos < js.size(); ++pos) {
+         const char ch = js[pos];
+         if (ch == '\\') {
+            ++pos;
+         } else if (ch == '\n') {
+            return pos;
+         } else if (ch == '[') {
+            inClass = true;
+         } else if (ch == ']') {
+            inClass = false;
+         } else if (ch == '/' && !inClass) {
+            ++pos;
+            break;
+         }
+      }
+      while (pos < js.size() && std::isalpha(static_cast<unsigned char>(js[pos]))) ++pos;
+      return pos;
+   }
+
+   const ScriptCall* scriptCallAt(std::string_view js, size_t dot, std::string_view method) {
+      for (const ScriptCall& call : kScriptCalls) {
+         if (call.method != method) continue;
+         if (call.onClassList && (dot < 9 || js.compare(dot - 9, 9, "classList") != 0)) continue;
+         return &call;
+      }
+      return nullptr;
+   }
+
+} // namespace
+
+bool HtmlCompressor::manglingNames() {
+   return currentLevel == EXTREME && settings.mangleNames;
+}
+
+void HtmlCompressor::reserveKeptNames() {
+   for (const std::vector<std::string>* allowlist : { settings.cssAllowlist, settings.mangleAllowlist }) {
+      if (allowlist == nullptr) continue;
+
+      // --- Same syntax as allowlisted(): "prefix*" (either kind), "#id", "name" or ".name" ---
+      for (const std::string& entry : *allowlist) {
+         std::string_view pattern = entry;
+         if (pattern.empty()) continue;
+
+         if (pattern.back() == '*') {
+            pattern.remove_suffix(1);
+            if (!pattern.empty() && (pattern.front() == '#' || pattern.front() == '.')) pattern.remove_prefix(1);
+            keepPrefix(NameKind::Class, pattern);
+            keepPrefix(NameKind::Id, pattern);
+         } else if (pattern.front() == '#') {
+            keepName(NameKind::Id, pattern.substr(1));
+         } else {
+            if (pattern.front() == '.') pattern.remove_prefix(1);
+            keepName(NameKind::Class, pattern);
+         }
+      }
+   }
+}
+
+void HtmlCompressor::mangleAttributes(const std::string& tagContent, std::string& out) {
+   out.clear();
+   size_t pos = 1;
+   while (pos < tagContent.size() && !isWhitespace(tagContent[pos]) && tagContent[pos] != '>' && tagContent[pos] != '/') ++pos;
+   out.append(tagContent, 0, pos);
+
+   std::string shortName;
+   std::string script;
+   while (pos < tagContent.size()) {
+      const char ch = tagContent[pos];
+      if (isWhitespace(ch) || ch == '/' || ch == '>') {
+         out += ch;
+         ++pos;
+         continue;
+      }
+
+      const size_t nameStart = pos;
+      while (pos < tagContent.size() && !isWhitespace(tagContent[pos]) && tagContent[pos] != '=' && tagContent[pos] != '>' && tagContent[pos] != '/') ++pos;
+      const std::string_view name(tagContent.data() + nameStart, pos - nameStart);
+      out.append(name);
+      if (pos >= tagContent.size() || tagContent[pos] != '=') continue;
+
+      out += '=';
+      ++pos;
+      const char quote = pos < tagContent.size() && (tagContent[pos] == '"' || tagContent[pos] == '\'') ? tagContent[pos] : '\0';
+      const size_t valueStart = pos + (quote != '\0' ? 1 : 0);
+      size_t valueEnd = valueStart;
+      if (quote != '\0') {
+         valueEnd = tagContent.find(quote, valueStart);
+         if (valueEnd == std::string::npos) {
+            out.append(tagContent, pos, std::string::npos);
+            return;
+         }
+      } else {
+         while (valueEnd < tagContent.size() && !isWhitespace(tagContent[valueEnd]) && tagContent[valueEnd] != '>') ++valueEnd;
+      }
+      const std::string_view value(tagContent.data() + valueStart, valueEnd - valueStart);
+
+      if (quote != '\0') out += quote;
+      if (equalsLower(name, "class")) {
+         mangleTokens(NameKind::Class, value, out);
+      } else if (equalsLower(name, "id") || std::any_of(std::begin(kIdReferenceAttributes), std::end(kIdReferenceAttributes), [&](std::string_view attribute) { return equalsLower(name, attribute); })) {
+         mangleTokens(NameKind::Id, value, out);
+      } else if (equalsLower(name, "href") || equalsLower(name, "xlink:href")) {
+         // --- "#top" scrolls to the top of the page even without such an element ---
+         const std::string_view fragment = value.size() > 1 && value[0] == '#' ? value.substr(1) : std::string_view();
+         if (!fragment.empty() && !equalsLower(fragment, "top") && fragment.find_first_of("%&") == std::string_view::npos && mangleName(NameKind::Id, fragment, shortName)) {
+            out += '#';
+            out += shortName;
+         } else {
+            out += value;
+         }
+      } else if (name.size() > 2 && equalsLower(name.substr(0, 2), "on")) {
+         script.assign(value.data(), value.size());
+         mangleScript(script);
+         out += script;
+      } else {
+         mangleUrlReferences(value, out);
+      }
+      if (quote != '\0') out += quote;
+
+      pos = valueEnd + (quote != '\0' ? 1 : 0);
+   }
+}
+
+void HtmlCompressor::mangleStyleSheet(std::string& css) {
+   std::string out;
+   out.reserve(css.size());
+   size_t pos = 0;
+
+   while (pos < css.size()) {
+      // --- A segment ends at a '{', ';' or '}' outside strings, comments and parentheses ---
+      size_t end = pos;
+      int depth = 0;
+      while (end < css.size()) {
+         const char ch = css[end];
+         if (ch == '"' || ch == '\'') {
+            end = skipString(css, end);
+            continue;
+         }
+         if (ch == '/' && end + 1 < css.size() && css[end + 1] == '*') {
+            const size_t close = css.find("*/", end + 2);
+            end = close == std::string::npos ? css.size() : close + 2;
+            continue;
+         }
+         if (ch == '\\') {
+            end += 2;
+            continue;
+         }
+         if (ch == '(') {
+            ++depth;
+         } else if (ch == ')') {
+            if (depth > 0) --depth;
+         } else if (depth == 0 && (ch == '{' || ch == ';' || ch == '}')) {
+            break;
+         }
+         ++end;
+      }
+      end = std::min(end, css.size());
+
+      // --- Selectors before '{' (at-rule preludes excepted); declarations otherwise ---
+      const std::string_view segment(css.data() + pos, end - pos);
+      const size_t first = segment.find_first_not_of(" \t\n\r\f");
+      if (end < css.size() && css[end] == '{' && first != std::string_view::npos && segment[first] != '@') {
+         mangleSelector(segment, out);
+      } else {
+         mangleUrlReferences(segment, out);
+      }
+
+      if (end < css.size()) out += css[end];
+      pos = end + 1;
+   }
+   css.swap(out);
+}
+
+void HtmlCompressor::mangleScript(std::string& js) {
+   std::string out;
+   size_t copied = 0;
+   size_t pos = 0;
+
+   while (pos < js.size()) {
+      const char ch = js[pos];
+
+      // --- Calls are only looked for in code: strings, comments and regex literals are skipped ---
+      if (ch == '"' || ch == '\'' || ch == '`') {
+         pos = skipString(js, pos);
+         continue;
+      }
+      if (ch == '/' && pos + 1 < js.size() && (js[pos + 1] == '/' || js[pos + 1] == '*')) {
+         const size_t close = js[pos + 1] == '/' ? js.find('\n', pos) : js.find("*/", pos + 2);
+         pos = close == std::string::npos ? js.size() : close + (js[pos + 1] == '/' ? 1 : 2);
+         continue;
+      }
+      if (ch == '/' && startsRegex(js, pos)) {
+         pos = skipRegex(js, pos);
+         continue;
+      }
+      if (ch != '.') {
+         ++pos;
+         continue;
+      }
+
+      const size_t dot = pos++;
+      size_t nameEnd = pos;
+      while (nameEnd < js.size() && (std::isalnum(static_cast<unsigned char>(js[nameEnd])) || js[nameEnd] == '_' || js[nameEnd] == '$')) ++nameEnd;
+      if (nameEnd >= js.size() || js[nameEnd] != '(') continue;
+
+      const ScriptCall* call = scriptCallAt(js, dot, std::string_view(js.data() + dot + 1, nameEnd - dot - 1));
+      if (call == nullptr) continue;
+
+      pos = nameEnd + 1;
+      while (true) {
+         while (pos < js.size() && isWhitespace(js[pos])) ++pos;
+         if (pos >= js.size() || (js[pos] != '"' && js[pos] != '\'' && js[pos] != '`')) break;
+
+         // --- Only plain literals passed whole: escapes, substitutions and concatenation leave the name unknown ---
+         const char quote = js[pos];
+         size_t close = pos + 1;
+         while (close < js.size() && js[close] != quote && js[close] != '\\' && js[close] != '\n' && !(quote == '`' && js[close] == '$')) ++close;
+         if (close >= js.size() || js[close] != quote) break;
+
+         size_t after = close + 1;
+         while (after < js.size() && isWhitespace(js[after])) ++after;
+         if (after >= js.size() || (js[after] != ',' && js[after] != ')')) break;
+
+         out.append(js, copied, pos + 1 - copied);
+         mangleScriptArgument(call->argument, std::string_view(js.data() + pos + 1, close - pos - 1), out);
+         copied = close;
+         pos = after;
+
+         if (!call->everyArgument || js[after] != ',') break;
+         ++pos;
+      }
+   }
+
+   if (copied == 0) return;
+   out.append(js, copied, std::string::npos);
+   js.swap(out);
+}
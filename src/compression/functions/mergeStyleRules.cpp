@@ -0,0 +1,224 @@
+#include "../HtmlCompressor.h"
+#include "../../utils/styleSheet.h"
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+   // --- A rule in document order, with its at-rule context ---
+   struct RuleRef {
+      CssNode* node;
+      std::string context;
+      std::vector<std::string> families;
+   };
+
+   // --- Longhands that a differently named shorthand also sets ---
+   constexpr std::array<std::pair<std::string_view, std::string_view>, 10> kFamilyAliases{ {
+      { "align", "place" }, { "bottom", "inset" }, { "column", "gap" }, { "columns", "gap" }, { "justify", "place" },
+      { "left", "inset" }, { "line", "font" }, { "right", "inset" }, { "row", "gap" }, { "top", "inset" },
+   } };
+
+   // --- Legacy names the standard property replaced; both set the same value ---
+   constexpr std::array<std::pair<std::string_view, std::string_view>, 4> kLegacyNames{ {
+      { "grid-column-gap", "column-gap" }, { "grid-gap", "gap" }, { "grid-row-gap", "row-gap" }, { "word-wrap", "overflow-wrap" },
+   } };
+
+   // --- Pseudo-classes every supported browser parses, so a merged selector list cannot be dropped ---
+   constexpr std::array<std::string_view, 16> kSafePseudos{
+      "active", "after", "before", "checked", "disabled", "empty", "enabled", "first-child",
+      "first-letter", "first-line", "focus", "hover", "last-child", "link", "root", "visited",
+   };
+
+   std::string toLower(std::string_view value) {
+      std::string lower(value);
+      for (char& ch : lower) ch = static_cast<char>(std::tolower(static_cast<unsigned char>(ch)));
+      return lower;
+   }
+
+   std::string_view trimView(std::string_view value) {
+      while (!value.empty() && std::isspace(static_cast<unsigned char>(value.front()))) value.remove_prefix(1);
+      while (!value.empty() && std::isspace(static_cast<unsigned char>(value.back()))) value.remove_suffix(1);
+      return value;
+   }
+
+   std::string_view valueOf(const CssDeclaration& declaration) {
+      std::string_view value = std::string_view(declaration.text).substr(declaration.text.find(':') + 1);
+      if (declaration.important) value = value.substr(0, value.rfind('!'));
+      return trimView(value);
+   }
+
+   // --- Drops declarations that a later one in the same rule repeats; a different value may be its fallback ---
+   bool dropOverridden(std::vector<CssDeclaration>& declarations) {
+      std::unordered_map<std::string, size_t> winners;
+      for (size_t i = 0; i < declarations.size(); ++i) {
+         const auto it = winners.find(declarations[i].property);
+         if (it == winners.end() || declarations[i].important || !declarations[it->second].important) {
+            winners[declarations[i].property] = i;
+         }
+      }
+
+      std::vector<CssDeclaration> kept;
+      kept.reserve(declarations.size());
+      for (size_t i = 0; i < declarations.size(); ++i) {
+         const CssDeclaration& winner = declarations[winners[declarations[i].property]];
+         const bool overridden = &winner != &declarations[i] && valueOf(winner) == valueOf(declarations[i]);
+         if (!overridden) kept.push_back(std::move(declarations[i]));
+      }
+
+      const bool changed = kept.size() != declarations.size();
+      declarations.swap(kept);
+      return changed;
+   }
+
+   std::string familyOf(std::string_view property) {
+      if (property.starts_with("--")) return std::string(property);
+      for (const std::string_view prefix : { "-webkit-", "-moz-", "-ms-", "-o-" }) {
+         if (property.starts_with(prefix)) {
+            property.remove_prefix(prefix.size());
+            break;
+         }
+      }
+      for (const auto& legacy : kLegacyNames) {
+         if (legacy.first == property) {
+            property = legacy.second;
+            break;
+         }
+      }
+
+      const std::string_view root = property.substr(0, property.find('-'));
+      for (const auto& alias : kFamilyAliases) {
+         if (alias.first == root) return std::string(alias.second);
+      }
+      return std::string(root);
+   }
+
+   bool familiesOverlap(const std::vector<std::string>& a, const std::vector<std::string>& b) {
+      for (const std::string& family : a) {
+         if (family == "all") return true;
+         for (const std::string& other : b) {
+            if (other == "all" || other == family) return true;
+         }
+      }
+      return false;
+   }
+
+   bool isSafeSelector(std::string_view selector) {
+      if (selector.find_first_of("()\\") != std::string_view::npos) return false;
+
+      for (size_t pos = selector.find(':'); pos != std::string_view::npos; pos = selector.find(':', pos)) {
+         while (pos < selector.size() && selector[pos] == ':') ++pos;
+         size_t end = pos;
+         while (end < selector.size() && (std::isalnum(static_cast<unsigned char>(selector[end])) || selector[end] == '-')) ++end;
+         if (!std::binary_search(kSafePseudos.begin(), kSafePseudos.end(), toLower(selector.substr(pos, end - pos)))) return false;
+         pos = end;
+      }
+      return true;
+   }
+
+   void collectRules(std::vector<CssNode>& nodes, const std::string& context, std::vector<RuleRef>& rules) {
+      for (CssNode& node : nodes) {
+         if (node.kind == CssNode::Kind::Rule) {
+            RuleRef ref{ &node, context, {} };
+            for (const CssDeclaration& declaration : node.declarations) ref.families.push_back(familyOf(declaration.property));
+            rules.push_back(std::move(ref));
+         } else if (node.kind == CssNode::Kind::Group) {
+            collectRules(node.children, context + '\n' + node.prelude, rules);
+         } else {
+            // --- An at-rule or nested rule kept as written (@scope, @starting-style, ...) may set anything ---
+            rules.push_back({ &node, context, { "all" } });
+         }
+      }
+   }
+
+   // --- Merges neighbouring rules with the same selector or the same declarations ---
+   bool mergeAdjacent(std::vector<CssNode>& nodes) {
+      bool changed = false;
+      CssNode* previous = nullptr;
+
+      for (CssNode& node : nodes) {
+         if (node.removed) continue;
+
+         if (node.kind == CssNode::Kind::Group) {
+            changed = mergeAdjacent(node.children) || changed;
+         }
+
+         if (previous && node.kind == CssNode::Kind::Rule) {
+            if (previous->prelude == node.prelude) {
+               previous->declarations.insert(previous->declarations.end(), node.declarations.begin(), node.declarations.end());
+               dropOverridden(previous->declarations);
+               node.removed = true;
+               changed = true;
+               continue;
+            }
+
+            std::string previousBody;
+            std::string body;
+            serializeDeclarations(previous->declarations, previousBody);
+            serializeDeclarations(node.declarations, body);
+            if (previousBody == body && isSafeSelector(previous->prelude) && isSafeSelector(node.prelude)) {
+               previous->prelude += ',';
+               previous->prelude += node.prelude;
+               node.removed = true;
+               changed = true;
+               continue;
+            }
+         }
+
+         previous = node.kind == CssNode::Kind::Rule ? &node : nullptr;
+      }
+      return changed;
+   }
+
+} // namespace
+
+bool HtmlCompressor::mergeStyleRules(std::vector<StyleBlock>& blocks) {
+   std::vector<RuleRef> rules;
+   for (size_t index = 0; index < blocks.size(); ++index) {
+      // --- Rules of other blocks only count as copies when every block in between is in view ---
+      const std::string scope = settings.dedupeAcrossStyleBlocks ? std::string() : "block:" + std::to_string(index) + '\n';
+      collectRules(blocks[index].nodes, scope + "media:" + blocks[index].media, rules);
+   }
+
+   bool changed = false;
+   for (RuleRef& rule : rules) {
+      if (rule.node->kind == CssNode::Kind::Rule) changed = dropOverridden(rule.node->declarations) || changed;
+   }
+
+   // --- A later copy of a rule is redundant unless something in between sets the same properties ---
+   std::unordered_map<std::string, size_t> firstSeen;
+   for (size_t index = 0; index < rules.size(); ++index) {
+      CssNode& node = *rules[index].node;
+      if (node.kind != CssNode::Kind::Rule) continue;
+
+      std::string key = rules[index].context + '\n' + node.prelude + '{';
+      serializeDeclarations(node.declarations, key);
+
+      const auto it = firstSeen.find(key);
+      if (it == firstSeen.end()) {
+         firstSeen.emplace(std::move(key), index);
+         continue;
+      }
+
+      bool overridden = false;
+      for (size_t between = it->second + 1; between < index && !overridden; ++between) {
+         overridden = !rules[between].node->removed && familiesOverlap(rules[between].families, rules[index].families);
+      }
+
+      if (overridden) {
+         it->second = index;
+      } else {
+         node.removed = true;
+         changed = true;
+      }
+   }
+
+   for (StyleBlock& block : blocks) {
+      changed = mergeAdjacent(block.nodes) || changed;
+   }
+   return changed;
+}
@@ -1,4 +1,5 @@
 #include "../HtmlCompressor.h"
+#include "../../utils/trim.h"
 
 #include <algorithm>
 #include <cctype>
@@ -8,6 +9,13 @@
 void HtmlCompressor::minifyCSS(std::string& css) {
    if (currentLevel < AGGRESSIVE) return;
 
+   // --- Vendor bundles and cached output: only trim ---
+   if (isMinifiedCSS(css)) {
+      css = trim(css);
+      if (manglingNames()) mangleStyleSheet(css);
+      return;
+   }
+
    const std::string placeholderPrefix = "___CSS_PH_";
    std::vector<std::string> placeholders;
    placeholders.reserve(16);
@@ -160,9 +168,6 @@ void HtmlCompressor::minifyCSS(std::string& css) {
 
    stripSemicolonBeforeBrace(compressed);
 
-   const std::regex zeroUnits(R"(\b0+(px|em|rem|%|pt|pc|in|cm|mm|ex|ch|vw|vh|vmin|vmax)\b)", std::regex_constants::icase);
-   compressed = std::regex_replace(compressed, zeroUnits, "0");
-
    const std::regex leadingZeroDecimals(R"(\b0+(\.\d+))");
    compressed = std::regex_replace(compressed, leadingZeroDecimals, "$1");
 
@@ -209,6 +214,8 @@ void HtmlCompressor::minifyCSS(std::string& css) {
    rgbProcessed.append(searchStart, compressed.cend());
    compressed.swap(rgbProcessed);
 
+   optimizeCSSValues(compressed);
+
    for (size_t idx = 0; idx < placeholders.size(); ++idx) {
       const std::string placeholder = placeholderPrefix + std::to_string(idx) + "___";
       size_t pos = 0;
@@ -218,5 +225,6 @@ void HtmlCompressor::minifyCSS(std::string& css) {
       }
    }
 
+   if (manglingNames()) mangleStyleSheet(compressed);
    css = compressed;
 }
@@ -1,9 +1,14 @@
 #include <algorithm>
 #include <cctype>
 #include <cstring>
+#include <exception>
+#include <system_error>
+#include <thread>
 #include <vector>
 #include "../HtmlCompressor.h"
 #include "../../helper/explode.h"
+#include "../../utils/styleSheet.h"
+#include "../../utils/trace.h"
 #include "../../utils/trim.h"
 
 namespace {
@@ -18,7 +23,7 @@ namespace {
       });
    }
 
-   bool isSelfClosing(const std::string& tagContent) {
+   bool isSelfClosing(std::string_view tagContent) {
       for (size_t i = tagContent.size(); i > 0; --i) {
          const char ch = tagContent[i - 1];
          if (ch == '>') {
@@ -32,6 +37,118 @@ namespace {
       return false;
    }
 
+   // --- Lowercased name of a closing tag ("</ name ...>") ---
+   void readClosingName(std::string_view tagContent, std::string& tagName) {
+      size_t nameStart = 2;
+      while (nameStart < tagContent.size() && std::isspace(static_cast<unsigned char>(tagContent[nameStart]))) {
+         ++nameStart;
+      }
+
+      size_t nameEnd = nameStart;
+      while (nameEnd < tagContent.size() && !std::isspace(static_cast<unsigned char>(tagContent[nameEnd])) && tagContent[nameEnd] != '>') {
+         ++nameEnd;
+      }
+
+      tagName.assign(tagContent.begin() + nameStart, tagContent.begin() + nameEnd);
+      toLowerInPlace(tagName);
+   }
+
+   // --- Lowercased name of an opening tag ("< name ...>" or "<name/>") ---
+   void readOpeningName(std::string_view tagContent, std::string& tagName) {
+      size_t nameStart = 1;
+      while (nameStart < tagContent.size() && std::isspace(static_cast<unsigned char>(tagContent[nameStart]))) {
+         ++nameStart;
+      }
+
+      size_t nameEnd = nameStart;
+      while (nameEnd < tagContent.size() && !std::isspace(static_cast<unsigned char>(tagContent[nameEnd])) && tagContent[nameEnd] != '>' && tagContent[nameEnd] != '/') {
+         ++nameEnd;
+      }
+
+      tagName.assign(tagContent.begin() + nameStart, tagContent.begin() + nameEnd);
+      toLowerInPlace(tagName);
+   }
+
+   // --- A closing tag closes the innermost open element of its name and everything opened inside it ---
+   void closeElement(std::vector<std::string>& tagStack, const std::string& tagName) {
+      const auto it = std::find(tagStack.rbegin(), tagStack.rend(), tagName);
+      if (it == tagStack.rend()) return;
+
+      const size_t removeCount = static_cast<size_t>(std::distance(tagStack.rbegin(), it)) + 1;
+      tagStack.resize(tagStack.size() - removeCount);
+   }
+
+   bool hasSpecialTag(const std::vector<std::string>& tagStack) {
+      return std::any_of(tagStack.begin(), tagStack.end(), [](const std::string& tag) { return isSpecialTag(tag); });
+   }
+
+   // --- Documents at least this large are minified in chunks on several threads ---
+   constexpr size_t kParallelMinBytes = 1024 * 1024;
+   constexpr size_t kMinChunkBytes = 256 * 1024;
+   constexpr size_t kMaxChunks = 8;
+
+   // --- Where a chunk starts, and the open elements the serial pass would have there ---
+   struct ChunkStart {
+      size_t pos;
+      std::vector<std::string> tagStack;
+   };
+
+   /**
+    * Tag-only replay of minifyHTML's state machine, cutting the document
+    * into up to chunkCount pieces of similar size. A cut is placed only at a
+    * "<" outside pre/code/textarea/script/style: there the serial pass drops
+    * pending whitespace and writes the tag, so its only carried state is the
+    * tag stack, which the cut records.
+    */
+   std::vector<ChunkStart> findChunkStarts(std::string_view html, size_t chunkCount) {
+      std::vector<ChunkStart> starts{ { 0, {} } };
+      const size_t chunkBytes = html.size() / chunkCount;
+      std::vector<std::string> tagStack;
+      std::string tagName;
+      bool insideSpecial = false;
+      size_t pos = 0;
+
+      while (pos < html.size() && starts.size() < chunkCount) {
+         if (html[pos] == '<') {
+            if (!insideSpecial && pos >= starts.back().pos + chunkBytes) starts.push_back({ pos, tagStack });
+
+            const size_t tagEnd = html.find('>', pos);
+            if (tagEnd == std::string_view::npos) break;
+
+            const std::string_view tagContent = html.substr(pos, tagEnd - pos + 1);
+            pos = tagEnd + 1;
+
+            if (tagContent.size() >= 4 && tagContent[1] == '!' && tagContent[2] == '-' && tagContent[3] == '-') continue;
+
+            if (tagContent.size() >= 3 && tagContent[1] == '/') {
+               readClosingName(tagContent, tagName);
+               closeElement(tagStack, tagName);
+               insideSpecial = hasSpecialTag(tagStack);
+            } else {
+               readOpeningName(tagContent, tagName);
+               if (!isSelfClosing(tagContent)) {
+                  tagStack.push_back(tagName);
+                  if (isSpecialTag(tagName)) insideSpecial = true;
+               }
+            }
+            continue;
+         }
+
+         // --- Script and style bodies are skipped whole, up to their closing tag ---
+         if (insideSpecial && !tagStack.empty() && (tagStack.back() == "script" || tagStack.back() == "style")) {
+            const size_t closingPos = html.find("</" + tagStack.back(), pos);
+            if (closingPos != std::string_view::npos) {
+               pos = closingPos;
+               continue;
+            }
+         }
+
+         // --- Text never changes the state ---
+         pos = html.find('<', pos);
+      }
+      return starts;
+   }
+
    void writeChunk(std::string& html, const std::string& chunk, size_t& writePos) {
       const size_t needed = writePos + chunk.size();
       if (needed > html.size()) {
@@ -41,6 +158,16 @@ namespace {
       writePos = needed;
    }
 
+   // --- Output runs behind the input; a chunk longer than what it replaces (a mangled name longer than the original) moves the unread input first ---
+   void makeRoom(std::string& html, size_t writePos, size_t size, size_t& readPos, size_t& inputLength) {
+      if (writePos + size <= readPos) return;
+
+      const size_t shift = writePos + size - readPos;
+      html.insert(readPos, shift, '\0');
+      readPos += shift;
+      inputLength += shift;
+   }
+
    void writeChar(std::string& html, char ch, size_t& writePos) {
       if (writePos == html.size()) {
          html.push_back(ch);
@@ -52,32 +179,110 @@ namespace {
 
 } // namespace
 
-void HtmlCompressor::minifyHTML(std::string& html) {
+void HtmlCompressor::minifyHTML(std::string& html, Workspace& workspace) {
+   if (html.size() >= kParallelMinBytes && minifyHTMLParallel(html)) return;
+
+   workspace.tagStack.clear();
+   switch (currentLevel) {
+      case WHITESPACE: collapseWhitespace(html); break;
+      case BASIC: minifyHTMLAt<BASIC>(html, workspace); break;
+      case AGGRESSIVE: minifyHTMLAt<AGGRESSIVE>(html, workspace); break;
+      case EXTREME: minifyHTMLAt<EXTREME>(html, workspace); break;
+   }
+}
+
+bool HtmlCompressor::minifyHTMLParallel(std::string& html) {
+   // --- Collapsing whitespace is a single linear pass: not worth the threads ---
+   if (currentLevel == WHITESPACE) return false;
+
+   // --- New names are handed out in the order they are first seen, which only a serial run keeps ---
+   if (manglingNames()) return false;
+
+   const size_t chunkCount = std::min({ static_cast<size_t>(std::thread::hardware_concurrency()), kMaxChunks, html.size() / kMinChunkBytes });
+   if (chunkCount < 2) return false;
+
+   std::vector<ChunkStart> starts;
+   {
+      TraceSpan span("minifyHTML prescan", static_cast<int64_t>(html.size()));
+      starts = findChunkStarts(html, chunkCount);
+   }
+   if (starts.size() < 2) return false;
+
+   // --- Worker threads start with default thread_local settings: hand them the caller's ---
+   const Level level = currentLevel;
+   const Settings callerSettings = settings;
+   std::vector<std::string> outputs(starts.size());
+   std::vector<std::exception_ptr> errors(starts.size());
+   std::vector<char> degraded(starts.size(), 0);
+
+   auto minifyChunk = [&](size_t index) {
+      currentLevel = level;
+      settings = callerSettings;
+
+      const size_t end = index + 1 < starts.size() ? starts[index + 1].pos : html.size();
+      TraceSpan span("minifyHTML chunk", static_cast<int64_t>(end - starts[index].pos));
+      try {
+         Workspace workspace;
+         workspace.tagStack = std::move(starts[index].tagStack);
+         outputs[index].assign(html, starts[index].pos, end - starts[index].pos);
+
+         switch (level) {
+            case WHITESPACE: collapseWhitespace(outputs[index]); break;
+            case BASIC: minifyHTMLAt<BASIC>(outputs[index], workspace); break;
+            case AGGRESSIVE: minifyHTMLAt<AGGRESSIVE>(outputs[index], workspace); break;
+            case EXTREME: minifyHTMLAt<EXTREME>(outputs[index], workspace); break;
+         }
+         degraded[index] = settings.degraded;
+      } catch (...) {
+         errors[index] = std::current_exception();
+      }
+   };
+
+   std::vector<std::thread> workers;
+   workers.reserve(starts.size() - 1);
+   std::vector<size_t> unstarted;
+   for (size_t index = 1; index < starts.size(); ++index) {
+      try {
+         workers.emplace_back(minifyChunk, index);
+      } catch (const std::system_error&) {
+         unstarted.push_back(index);
+      }
+   }
+   minifyChunk(0);
+   for (const size_t index : unstarted) minifyChunk(index);
+   for (std::thread& worker : workers) worker.join();
+
+   for (const std::exception_ptr& error : errors) {
+      if (error) std::rethrow_exception(error);
+   }
+   settings.degraded = std::find(degraded.begin(), degraded.end(), 1) != degraded.end();
+
+   // --- Each chunk's output starts with its first tag, so the pieces join without fixups ---
+   html.clear();
+   for (const std::string& output : outputs) html += output;
+   return true;
+}
+
+template <HtmlCompressor::Level level>
+void HtmlCompressor::minifyHTMLAt(std::string& html, Workspace& workspace) {
    if (html.empty()) {
       return;
    }
 
-   const size_t originalLength = html.length();
+   size_t inputLength = html.length();
    size_t readPos = 0;
    size_t writePos = 0;
-   std::vector<std::string> tagStack;
+   std::vector<std::string>& tagStack = workspace.tagStack; // --- empty, or the open elements where a chunk starts ---
    tagStack.reserve(16);
-   bool insideSpecial = false;
+   bool insideSpecial = hasSpecialTag(tagStack);
    bool pendingSpace = false;
-   std::string tagContent;
-   std::string tagName;
-
-   auto refreshInsideSpecial = [&]() {
-      insideSpecial = false;
-      for (auto it = tagStack.rbegin(); it != tagStack.rend(); ++it) {
-         if (isSpecialTag(*it)) {
-            insideSpecial = true;
-            break;
-         }
-      }
-   };
+   std::string& tagContent = workspace.tagContent;
+   std::string& tagName = workspace.tagName;
+   ScriptKind scriptKind = ScriptKind::JavaScript;
 
-   while (readPos < originalLength) {
+   auto refreshInsideSpecial = [&]() { insideSpecial = hasSpecialTag(tagStack); };
+
+   while (readPos < inputLength) {
       char current = html[readPos];
 
       if (current == '<') {
@@ -91,65 +296,38 @@ void HtmlCompressor::minifyHTML(std::string& html) {
          const bool isClosingTag = tagContent.size() >= 3 && tagContent[1] == '/';
 
          if (isComment) {
-            writeChunk(html, tagContent, writePos);
             readPos = tagEnd + 1;
+            makeRoom(html, writePos, tagContent.size(), readPos, inputLength);
+            writeChunk(html, tagContent, writePos);
             pendingSpace = false;
             continue;
          }
 
          if (isClosingTag) {
-            size_t nameStart = 2;
-            while (nameStart < tagContent.size() && std::isspace(static_cast<unsigned char>(tagContent[nameStart]))) {
-               ++nameStart;
-            }
-
-            size_t nameEnd = nameStart;
-            while (nameEnd < tagContent.size() && !std::isspace(static_cast<unsigned char>(tagContent[nameEnd])) && tagContent[nameEnd] != '>') {
-               ++nameEnd;
-            }
-
-            tagName.assign(tagContent.begin() + nameStart, tagContent.begin() + nameEnd);
-            toLowerInPlace(tagName);
-
-            if (!tagStack.empty()) {
-               auto it = std::find(tagStack.rbegin(), tagStack.rend(), tagName);
-               if (it != tagStack.rend()) {
-                  const size_t removeCount = static_cast<size_t>(std::distance(tagStack.rbegin(), it)) + 1;
-                  for (size_t count = 0; count < removeCount && !tagStack.empty(); ++count) {
-                     tagStack.pop_back();
-                  }
-               }
-            }
-
+            readClosingName(tagContent, tagName);
+            closeElement(tagStack, tagName);
             refreshInsideSpecial();
          } else {
-            size_t nameStart = 1;
-            while (nameStart < tagContent.size() && std::isspace(static_cast<unsigned char>(tagContent[nameStart]))) {
-               ++nameStart;
-            }
-
-            size_t nameEnd = nameStart;
-            while (nameEnd < tagContent.size() && !std::isspace(static_cast<unsigned char>(tagContent[nameEnd])) && tagContent[nameEnd] != '>' && tagContent[nameEnd] != '/') {
-               ++nameEnd;
-            }
-
-            tagName.assign(tagContent.begin() + nameStart, tagContent.begin() + nameEnd);
-            toLowerInPlace(tagName);
+            readOpeningName(tagContent, tagName);
 
             const bool selfClosing = isSelfClosing(tagContent);
             if (!selfClosing) {
                tagStack.push_back(tagName);
+               if (tagName == "script") {
+                  scriptKind = classifyScriptType(tagAttribute(tagContent, "type"));
+               }
                if (isSpecialTag(tagName)) {
                   insideSpecial = true;
                }
             }
          }
 
-         optimizeAttributes(tagContent);
+         if constexpr (level >= AGGRESSIVE) optimizeAttributes<level>(tagContent, workspace.attributes);
+         readPos = tagEnd + 1;
+         makeRoom(html, writePos, tagContent.size(), readPos, inputLength);
          writeChunk(html, tagContent, writePos);
 
          pendingSpace = false;
-         readPos = tagEnd + 1;
          continue;
       }
 
@@ -160,14 +338,33 @@ void HtmlCompressor::minifyHTML(std::string& html) {
                std::string closingTag = "</" + currentTag;
                const size_t closingPos = html.find(closingTag, readPos);
                if (closingPos != std::string::npos) {
-                  std::string content = html.substr(readPos, closingPos - readPos);
-                  if (currentTag == "script") {
-                     minifyJS(content);
-                  } else {
+                  std::string& content = workspace.block;
+                  content.assign(html, readPos, closingPos - readPos);
+                  TraceSpan span(currentTag == "script" ? "script block" : "style block", static_cast<int64_t>(content.size()));
+                  if (overDeadline(settings.deadline)) {
+                     // --- Out of time: the block is kept as written, but its names must still match the markup ---
+                     if constexpr (level == EXTREME) {
+                        if (settings.mangleNames) {
+                           if (currentTag == "style") {
+                              mangleStyleSheet(content);
+                           } else if (scriptKind == ScriptKind::JavaScript) {
+                              mangleScript(content);
+                           }
+                        }
+                     }
+                  } else if (currentTag == "script") {
+                     // --- Data blocks (templates, shaders, ...) are kept verbatim; invalid JSON too ---
+                     if (scriptKind == ScriptKind::JavaScript) {
+                        minifyJS(content);
+                     } else if (scriptKind == ScriptKind::Json) {
+                        minifyJSON(content);
+                     }
+                  } else if constexpr (level >= AGGRESSIVE) {
                      minifyCSS(content);
                   }
-                  writeChunk(html, content, writePos);
                   readPos = closingPos;
+                  makeRoom(html, writePos, content.size(), readPos, inputLength);
+                  writeChunk(html, content, writePos);
                   continue;
                }
             }
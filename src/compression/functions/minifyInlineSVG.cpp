@@ -0,0 +1,392 @@
+#include "../HtmlCompressor.h"
+#include "../../utils/pathData.h"
+#include "../../utils/styleSheet.h"
+
+#include <algorithm>
+#include <cctype>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+namespace {
+
+   struct Attribute {
+      std::string_view name; // --- as written ---
+      std::string lowerName;
+      std::string_view value;
+      std::string compacted; // --- replaces value when rewritten ---
+      bool rewritten = false;
+      char quote = '"';
+      bool hasValue = false;
+   };
+
+   struct Tag {
+      std::string_view name;
+      std::string lowerName;
+      std::vector<Attribute> attributes;
+      bool selfClosing = false;
+      size_t end = 0; // --- one past the ">" ---
+   };
+
+   /**
+    * Defaults of attributes that are not inherited. Inherited properties
+    * (fill, stroke, stroke-width, ...) are kept even at their initial value:
+    * page CSS may set them on an ancestor, and the attribute overrides that.
+    * An empty element applies to every element.
+    */
+   struct DefaultValue {
+      std::string_view element;
+      std::string_view attribute;
+      std::string_view value;
+   };
+
+   constexpr DefaultValue kDefaults[] = {
+      { "", "opacity", "1" },
+      { "", "clip-path", "none" },
+      { "", "mask", "none" },
+      { "", "filter", "none" },
+      { "", "preserveaspectratio", "xMidYMid meet" },
+      { "svg", "x", "0" }, { "svg", "y", "0" },
+      { "rect", "x", "0" }, { "rect", "y", "0" },
+      { "use", "x", "0" }, { "use", "y", "0" },
+      { "image", "x", "0" }, { "image", "y", "0" },
+      { "circle", "cx", "0" }, { "circle", "cy", "0" },
+      { "ellipse", "cx", "0" }, { "ellipse", "cy", "0" },
+      { "line", "x1", "0" }, { "line", "y1", "0" }, { "line", "x2", "0" }, { "line", "y2", "0" },
+      { "stop", "offset", "0" }, { "stop", "stop-opacity", "1" },
+      { "stop", "stop-color", "black" }, { "stop", "stop-color", "#000" }, { "stop", "stop-color", "#000000" },
+      { "feflood", "flood-opacity", "1" }, { "feflood", "flood-color", "black" }, { "feflood", "flood-color", "#000" },
+      { "lineargradient", "x1", "0%" }, { "lineargradient", "y1", "0%" }, { "lineargradient", "x2", "100%" }, { "lineargradient", "y2", "0%" },
+      { "lineargradient", "gradientunits", "objectBoundingBox" }, { "lineargradient", "spreadmethod", "pad" },
+      { "radialgradient", "cx", "50%" }, { "radialgradient", "cy", "50%" }, { "radialgradient", "r", "50%" },
+      { "radialgradient", "gradientunits", "objectBoundingBox" }, { "radialgradient", "spreadmethod", "pad" },
+      { "pattern", "x", "0" }, { "pattern", "y", "0" },
+      { "pattern", "patternunits", "objectBoundingBox" }, { "pattern", "patterncontentunits", "userSpaceOnUse" },
+      { "clippath", "clippathunits", "userSpaceOnUse" },
+      { "mask", "maskunits", "objectBoundingBox" }, { "mask", "maskcontentunits", "userSpaceOnUse" },
+      { "mask", "x", "-10%" }, { "mask", "y", "-10%" }, { "mask", "width", "120%" }, { "mask", "height", "120%" },
+      { "filter", "filterunits", "objectBoundingBox" }, { "filter", "primitiveunits", "userSpaceOnUse" },
+      { "filter", "x", "-10%" }, { "filter", "y", "-10%" }, { "filter", "width", "120%" }, { "filter", "height", "120%" },
+      { "marker", "markerunits", "strokeWidth" }, { "marker", "refx", "0" }, { "marker", "refy", "0" },
+      { "marker", "markerwidth", "3" }, { "marker", "markerheight", "3" },
+      { "fecolormatrix", "type", "matrix" }, { "fecomposite", "operator", "over" }, { "feblend", "mode", "normal" },
+   };
+
+   // --- Plain numbers that can be rewritten without their redundant zeros ---
+   constexpr std::string_view kNumericAttributes[] = {
+      "cx", "cy", "fx", "fy", "height", "offset", "opacity", "fill-opacity", "r", "rx", "ry", "stop-opacity",
+      "stroke-dashoffset", "stroke-miterlimit", "stroke-opacity", "stroke-width", "width", "x", "x1", "x2", "y", "y1", "y2",
+   };
+
+   // --- Namespaces of editor metadata, meaningless once their elements and attributes are gone ---
+   constexpr std::string_view kEditorPrefixes[] = { "cc", "dc", "inkscape", "rdf", "sodipodi" };
+
+   // --- Raw text outside <svg>: markup inside is not markup ---
+   constexpr std::string_view kRawTextElements[] = {
+      "iframe", "noembed", "noframes", "noscript", "script", "style", "textarea", "title", "xmp",
+   };
+
+   // --- Inside <svg>: HTML integration points and scripts, copied as written ---
+   constexpr std::string_view kVerbatimElements[] = { "desc", "foreignobject", "script", "style", "title" };
+
+   template <typename Container>
+   bool contains(const Container& names, std::string_view name) {
+      return std::find(std::begin(names), std::end(names), name) != std::end(names);
+   }
+
+   std::string toLower(std::string_view value) {
+      std::string lower(value);
+      for (char& ch : lower) ch = static_cast<char>(std::tolower(static_cast<unsigned char>(ch)));
+      return lower;
+   }
+
+   std::string_view trimView(std::string_view value) {
+      while (!value.empty() && std::isspace(static_cast<unsigned char>(value.front()))) value.remove_prefix(1);
+      while (!value.empty() && std::isspace(static_cast<unsigned char>(value.back()))) value.remove_suffix(1);
+      return value;
+   }
+
+   bool isEditorName(std::string_view lowerName) {
+      return lowerName.starts_with("sodipodi:") || lowerName.starts_with("inkscape:");
+   }
+
+   std::string_view prefixOf(std::string_view lowerName) {
+      const size_t colon = lowerName.find(':');
+      return colon == std::string_view::npos ? std::string_view() : lowerName.substr(0, colon);
+   }
+
+   // --- Start tag at pos, attributes tokenized the way the HTML parser does ---
+   bool parseStartTag(std::string_view html, size_t pos, Tag& tag) {
+      tag.attributes.clear();
+      tag.selfClosing = false;
+
+      auto isSpace = [](char ch) { return std::isspace(static_cast<unsigned char>(ch)) != 0; };
+
+      size_t cursor = pos + 1;
+      while (cursor < html.size() && !isSpace(html[cursor]) && html[cursor] != '/' && html[cursor] != '>') ++cursor;
+      tag.name = html.substr(pos + 1, cursor - pos - 1);
+      tag.lowerName = toLower(tag.name);
+
+      while (cursor < html.size()) {
+         while (cursor < html.size() && isSpace(html[cursor])) ++cursor;
+         if (cursor >= html.size()) return false;
+
+         if (html[cursor] == '>') {
+            tag.end = cursor + 1;
+            return true;
+         }
+         if (html[cursor] == '/') {
+            if (cursor + 1 < html.size() && html[cursor + 1] == '>') {
+               tag.selfClosing = true;
+               tag.end = cursor + 2;
+               return true;
+            }
+            ++cursor;
+            continue;
+         }
+
+         Attribute attribute;
+         const size_t nameStart = cursor++;
+         while (cursor < html.size() && !isSpace(html[cursor]) && html[cursor] != '/' && html[cursor] != '>' && html[cursor] != '=') ++cursor;
+         attribute.name = html.substr(nameStart, cursor - nameStart);
+         attribute.lowerName = toLower(attribute.name);
+
+         size_t afterName = cursor;
+         while (afterName < html.size() && isSpace(html[afterName])) ++afterName;
+         if (afterName < html.size() && html[afterName] == '=') {
+            cursor = afterName + 1;
+            while (cursor < html.size() && isSpace(html[cursor])) ++cursor;
+            if (cursor >= html.size()) return false;
+
+            attribute.hasValue = true;
+            if (html[cursor] == '"' || html[cursor] == '\'') {
+               attribute.quote = html[cursor];
+               const size_t close = html.find(attribute.quote, cursor + 1);
+               if (close == std::string_view::npos) return false;
+               attribute.value = html.substr(cursor + 1, close - cursor - 1);
+               cursor = close + 1;
+            } else {
+               const size_t valueStart = cursor;
+               while (cursor < html.size() && !isSpace(html[cursor]) && html[cursor] != '>') ++cursor;
+               attribute.value = html.substr(valueStart, cursor - valueStart);
+            }
+         }
+         tag.attributes.push_back(std::move(attribute));
+      }
+      return false;
+   }
+
+   bool sameValue(std::string_view value, std::string_view defaultValue) {
+      value = trimView(value);
+      if (value == defaultValue) return true;
+
+      // --- Numbers compare by value; a percentage only equals a percentage, except for zero ---
+      const bool percent = !value.empty() && value.back() == '%';
+      const bool defaultPercent = defaultValue.back() == '%';
+      if (percent) value.remove_suffix(1);
+      if (defaultPercent) defaultValue.remove_suffix(1);
+
+      std::string left;
+      std::string right;
+      if (!compactNumber(value, left) || !compactNumber(defaultValue, right) || left != right) return false;
+      return percent == defaultPercent || left == "0";
+   }
+
+   bool isDefault(const Tag& tag, const Attribute& attribute, bool referencesTemplate) {
+      for (const DefaultValue& entry : kDefaults) {
+         if (entry.attribute != attribute.lowerName) continue;
+
+         // --- Gradients and patterns with href inherit unset attributes from the referenced element ---
+         if (!entry.element.empty() && (entry.element != tag.lowerName || referencesTemplate)) continue;
+         if (sameValue(attribute.value, entry.value)) return true;
+      }
+      return false;
+   }
+
+   /**
+    * Drops editor and default attributes, compacts geometry in place.
+    * Character references are left alone rather than decoded.
+    */
+   void rewriteAttributes(Tag& tag, int precision) {
+      const bool referencesTemplate = std::any_of(tag.attributes.begin(), tag.attributes.end(), [](const Attribute& attribute) {
+         return attribute.lowerName == "href" || attribute.lowerName == "xlink:href";
+      });
+
+      std::erase_if(tag.attributes, [&](Attribute& attribute) {
+         if (isEditorName(attribute.lowerName)) return true;
+         if (attribute.lowerName == "xmlns:sodipodi" || attribute.lowerName == "xmlns:inkscape") return true;
+         if (!attribute.hasValue || attribute.value.find('&') != std::string_view::npos) return false;
+         if (isDefault(tag, attribute, referencesTemplate)) return true;
+
+         const std::string_view name = attribute.lowerName;
+         if (name == "d" && tag.lowerName == "path") {
+            attribute.rewritten = compactPathData(attribute.value, precision, attribute.compacted);
+         } else if (name == "points" && (tag.lowerName == "polygon" || tag.lowerName == "polyline")) {
+            attribute.rewritten = compactPointList(attribute.value, precision, attribute.compacted);
+         } else if (name == "viewbox" || name == "stroke-dasharray") {
+            attribute.rewritten = compactNumberList(attribute.value, attribute.compacted);
+         } else if (contains(kNumericAttributes, name)) {
+            attribute.rewritten = compactNumber(trimView(attribute.value), attribute.compacted);
+         }
+         return false;
+      });
+   }
+
+   void writeTag(const Tag& tag, std::string& out) {
+      out += '<';
+      out += tag.name;
+      for (const Attribute& attribute : tag.attributes) {
+         out += ' ';
+         out += attribute.name;
+         if (!attribute.hasValue) continue;
+
+         out += '=';
+         out += attribute.quote;
+         out += attribute.rewritten ? std::string_view(attribute.compacted) : attribute.value;
+         out += attribute.quote;
+      }
+      out += tag.selfClosing ? "/>" : ">";
+   }
+
+   void collectPrefixes(const Tag& tag, std::unordered_set<std::string>& prefixes) {
+      prefixes.emplace(prefixOf(tag.lowerName));
+      for (const Attribute& attribute : tag.attributes) {
+         if (!attribute.lowerName.starts_with("xmlns")) prefixes.emplace(prefixOf(attribute.lowerName));
+      }
+   }
+
+   /**
+    * Rewrites the <svg> element at pos into out and sets end past its end
+    * tag. False (out unspecified) when the subtree is not plain SVG markup
+    * the HTML parser would keep in foreign content.
+    */
+   bool rewriteSvg(std::string_view html, size_t pos, int precision, std::string& out, size_t& end) {
+      Tag root;
+      if (!parseStartTag(html, pos, root)) return false;
+      rewriteAttributes(root, precision);
+
+      std::unordered_set<std::string> prefixes;
+      collectPrefixes(root, prefixes);
+
+      std::string body;
+      body.reserve(html.size() - pos < 4096 ? html.size() - pos : 4096);
+      std::vector<std::string> stack{ root.lowerName };
+      Tag tag;
+      size_t dropDepth = 0; // --- stack depth of the editor element being skipped, 0 when none ---
+      size_t cursor = root.end;
+
+      while (!root.selfClosing) {
+         const size_t open = html.find('<', cursor);
+         if (open == std::string_view::npos) return false;
+         if (!dropDepth) body.append(html.substr(cursor, open - cursor));
+
+         // --- Comments and CDATA sections ---
+         for (const auto& [opener, closer] : { std::pair<std::string_view, std::string_view>{ "<!--", "-->" }, { "<![CDATA[", "]]>" } }) {
+            if (html.compare(open, opener.size(), opener) != 0) continue;
+            const size_t close = html.find(closer, open + opener.size());
+            if (close == std::string_view::npos) return false;
+            cursor = close + closer.size();
+            if (!dropDepth) body.append(html.substr(open, cursor - open));
+            break;
+         }
+         if (cursor > open) continue;
+
+         if (open + 1 < html.size() && html[open + 1] == '/') {
+            const size_t close = html.find('>', open);
+            if (close == std::string_view::npos) return false;
+
+            const std::string name = toLower(trimView(html.substr(open + 2, close - open - 2)));
+            if (name != stack.back()) return false;
+
+            if (!dropDepth) body.append(html.substr(open, close + 1 - open));
+            if (stack.size() == dropDepth) dropDepth = 0;
+            stack.pop_back();
+            cursor = close + 1;
+
+            if (stack.empty()) break;
+            continue;
+         }
+
+         // --- "<" not starting a tag is text ---
+         if (open + 1 >= html.size() || !std::isalpha(static_cast<unsigned char>(html[open + 1]))) {
+            if (!dropDepth) body += '<';
+            cursor = open + 1;
+            continue;
+         }
+
+         if (!parseStartTag(html, open, tag)) return false;
+         if (isForeignBreakout(tag.lowerName) || tag.lowerName == "font") return false;
+         cursor = tag.end;
+
+         const bool drop = dropDepth || tag.lowerName == "metadata" || isEditorName(tag.lowerName);
+         if (!tag.selfClosing) {
+            stack.push_back(tag.lowerName);
+            if (drop && !dropDepth) dropDepth = stack.size();
+         }
+         if (drop) continue;
+
+         rewriteAttributes(tag, precision);
+         collectPrefixes(tag, prefixes);
+         writeTag(tag, body);
+
+         if (!tag.selfClosing && contains(kVerbatimElements, tag.lowerName)) {
+            const size_t close = findTagIgnoreCase(html, "</" + tag.lowerName, cursor);
+            if (close == std::string_view::npos) return false;
+            body.append(html.substr(cursor, close - cursor));
+            cursor = close;
+         }
+      }
+
+      // --- Editor namespace declarations nothing refers to anymore ---
+      std::erase_if(root.attributes, [&](const Attribute& attribute) {
+         const std::string_view prefix = attribute.lowerName.starts_with("xmlns:") ? std::string_view(attribute.lowerName).substr(6) : std::string_view();
+         return contains(kEditorPrefixes, prefix) && !prefixes.contains(std::string(prefix));
+      });
+
+      writeTag(root, out);
+      out += body;
+      end = cursor;
+      return true;
+   }
+
+} // namespace
+
+void HtmlCompressor::minifyInlineSVG(std::string& html) {
+   std::string out;
+   size_t copied = 0;
+   bool rewritten = false;
+
+   for (size_t pos = html.find('<'); pos != std::string::npos; pos = html.find('<', pos + 1)) {
+      if (html.compare(pos, 4, "<!--") == 0) {
+         pos = html.find("-->", pos + 4);
+         if (pos == std::string::npos) break;
+         continue;
+      }
+
+      const auto rawText = std::find_if(std::begin(kRawTextElements), std::end(kRawTextElements), [&](std::string_view name) {
+         return isTagAt(html, pos, name);
+      });
+      if (rawText != std::end(kRawTextElements)) {
+         pos = findTagIgnoreCase(html, "</" + std::string(*rawText), pos + 1);
+         if (pos == std::string::npos) break;
+         continue;
+      }
+
+      if (!isTagAt(html, pos, "svg")) continue;
+
+      std::string svg;
+      size_t end = 0;
+      if (!rewriteSvg(html, pos, settings.svgPrecision, svg, end)) continue;
+
+      if (!rewritten) out.reserve(html.size());
+      out.append(html, copied, pos - copied);
+      out += svg;
+      copied = end;
+      rewritten = true;
+      pos = end - 1;
+   }
+
+   if (!rewritten) return;
+   out.append(html, copied, std::string::npos);
+   html.swap(out);
+}
@@ -1,4 +1,6 @@
+#include <atomic>
 #include <cctype>
+#include <cstdint>
 #include <string_view>
 #include <filesystem>
 #include <fstream>
@@ -10,6 +12,9 @@
 #endif
 #include <chrono>
 #include "../HtmlCompressor.h"
+#include "../../utils/bundlerModel.h"
+#include "../../utils/trace.h"
+#include "../../utils/trim.h"
 
 namespace {
 
@@ -97,6 +102,17 @@ namespace {
       return keyword == "else" || keyword == "catch" || keyword == "finally" || keyword == "while";
    }
 
+   // --- Scoped scripts run inside an arrow IIFE so their declarations stay local ---
+   void wrapScoped(std::string& js) {
+      if (js.empty()) return;
+
+      // trim the trailing ";" and whitespace
+      while (!js.empty() && (std::isspace(static_cast<unsigned char>(js.back())) || js.back() == ';')) {
+         js.pop_back();
+      }
+      js = "(()=>{" + js + ";})();";
+   }
+
    std::string toLower(std::string value) {
       for (auto& ch : value) {
          ch = static_cast<char>(std::tolower(static_cast<unsigned char>(ch)));
@@ -104,8 +120,10 @@ namespace {
       return value;
    }
    std::string makeTempFilename(const std::string& prefix, const std::string& extension) {
+      // --- Background bundle jobs run concurrently: the clock alone can repeat ---
+      static std::atomic<uint64_t> sequence{ 0 };
       const auto now = std::chrono::high_resolution_clock::now().time_since_epoch().count();
-      return prefix + std::to_string(now) + extension;
+      return prefix + std::to_string(now) + "_" + std::to_string(sequence.fetch_add(1)) + extension;
    }
 
    void appendDebug(char* buffer, const std::string& message) {
@@ -119,6 +137,7 @@ namespace {
    }
 
    std::string getBundlerPath(char* debugOutput) {
+      TraceSpan span("bundler lookup");
       #if defined(_WIN32)
             char* envPath = nullptr;
             size_t length = 0;
@@ -161,27 +180,48 @@ namespace {
    }
 
 
-   bool runBundler(const std::string& input, const std::string& scope, int level, std::string& output, char* debugOutput) {
-      std::filesystem::path tempDir = std::filesystem::temp_directory_path();
-      std::filesystem::path inputPath = tempDir / makeTempFilename("phpspa_js_", ".js");
-      std::filesystem::path outputPath = tempDir / makeTempFilename("phpspa_js_out_", ".js");
+   /**
+    * Minify several sources with one bundler process (one entry point each).
+    * All sources share the scope's flags; outputs[i] corresponds to inputs[i].
+    */
+   bool runBundlerBatch(const std::vector<std::string>& inputs, const std::string& scope, int level, std::vector<std::string>& outputs, char* debugOutput) {
+      const std::filesystem::path workDir = std::filesystem::temp_directory_path() / makeTempFilename("phpspa_js_", "");
+      const std::filesystem::path outDir = workDir / "out";
 
-      {
+      auto cleanup = [&]() {
+         std::error_code ec;
+         std::filesystem::remove_all(workDir, ec);
+      };
+
+      TraceSpan span("runBundler");
+      span.arg("scripts", static_cast<int64_t>(inputs.size()));
+
+      std::error_code created;
+      if (!std::filesystem::create_directories(outDir, created)) {
+         return false;
+      }
+
+      std::string entryPoints;
+      int64_t inputBytes = 0;
+      for (size_t i = 0; i < inputs.size(); ++i) {
+         inputBytes += static_cast<int64_t>(inputs[i].size());
+         const std::filesystem::path inputPath = workDir / ("s" + std::to_string(i) + ".js");
          std::ofstream out(inputPath, std::ios::binary);
          if (!out.is_open()) {
+            cleanup();
             return false;
          }
-         out << input;
-         out.flush();
+         out << inputs[i];
          out.close();
+         entryPoints += " \"" + inputPath.string() + "\"";
       }
 
       const std::string bundler = getBundlerPath(debugOutput);
       const std::string normalizedScope = toLower(scope);
 
       std::string command = bundler;
-      command += " \"" + inputPath.string() + "\"";
-      command += " --outfile=\"" + outputPath.string() + "\"";
+      command += entryPoints;
+      command += " --outdir=\"" + outDir.string() + "\"";
       command += " --platform=browser --log-level=error";
 
       if (normalizedScope == "scoped") {
@@ -199,245 +239,272 @@ namespace {
       }
 
       appendDebug(debugOutput, "Running: " + command);
+      span.arg("bytes", inputBytes);
 
-      std::filesystem::path errorPath = tempDir / makeTempFilename("phpspa_js_err_", ".txt");
+      const std::filesystem::path errorPath = workDir / "error.txt";
 
       // Run bundler
+      int status = 0;
+      const auto spawnStart = std::chrono::steady_clock::now();
+      {
+         TraceSpan spawn("bundler spawn", inputBytes);
       #ifdef _WIN32
          command += " 2>\"" + errorPath.string() + "\"";
-         int status = runCommandHiddenWindows(command, 20000); // 20 second timeout
+         status = runCommandHiddenWindows(command, 20000); // 20 second timeout
       #else
          command = "timeout 20s " + command + " 2>\"" + errorPath.string() + "\"";
-         int status = std::system(command.c_str());
+         status = std::system(command.c_str());
       #endif
+         spawn.arg("status", status);
+      }
+      recordBundlerSpawn(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - spawnStart).count(), status == 0);
+
+      std::vector<std::string> bundled(inputs.size());
+      bool complete = status == 0;
+      for (size_t i = 0; complete && i < inputs.size(); ++i) {
+         std::ifstream in(outDir / ("s" + std::to_string(i) + ".js"), std::ios::binary);
+         complete = in.is_open();
+         if (complete) bundled[i].assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+      }
 
-      if (status != 0 || !std::filesystem::exists(outputPath)) {
+      if (!complete) {
          std::string errorMsg;
-         if (std::filesystem::exists(errorPath)) {
-            std::ifstream errFile(errorPath, std::ios::binary);
-            if (errFile.is_open()) {
-               errorMsg = std::string((std::istreambuf_iterator<char>(errFile)), std::istreambuf_iterator<char>());
-               errFile.close();
-            }
+         std::ifstream errFile(errorPath, std::ios::binary);
+         if (errFile.is_open()) {
+            errorMsg = std::string((std::istreambuf_iterator<char>(errFile)), std::istreambuf_iterator<char>());
          }
          std::string reason = (status != 0) ? "Status code: " + std::to_string(status) : "Output file not found";
          appendDebug(debugOutput, "Bundler failed! " + reason + ". Error: " + errorMsg);
-
-         std::error_code ec;
-         std::filesystem::remove(inputPath, ec);
-         std::filesystem::remove(outputPath, ec);
-         std::filesystem::remove(errorPath, ec);
+         cleanup();
          return false;
       }
 
-      std::error_code ec_clean;
-      std::filesystem::remove(errorPath, ec_clean);
-
-      std::ifstream in(outputPath, std::ios::binary);
-      if (!in.is_open()) {
-         std::error_code ec;
-         std::filesystem::remove(inputPath, ec);
-         std::filesystem::remove(outputPath, ec);
-         return false;
-      }
-
-      std::string bundled((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
-      in.close();
-      
-      output = bundled;
+      cleanup();
+      outputs = std::move(bundled);
+      return true;
+   }
 
-      std::error_code ec;
-      std::filesystem::remove(inputPath, ec);
-      std::filesystem::remove(outputPath, ec);
+   bool runBundler(const std::string& input, const std::string& scope, int level, std::string& output, char* debugOutput) {
+      std::vector<std::string> outputs;
+      if (!runBundlerBatch({ input }, scope, level, outputs, debugOutput)) return false;
 
+      output = std::move(outputs.front());
       return true;
    }
 
-} // namespace
-
-void HtmlCompressor::minifyJS(std::string& js, const std::string& scope) {
-   std::string result;
-   result.reserve(js.length());
-
-   bool inString = false;
-   bool inRegex = false;
-   bool inSingleComment = false;
-   bool inMultiComment = false;
-   bool pendingSpace = false;
-   bool pendingLinebreak = false;
-   bool controlKeywordActive = false;
-   bool forceSpaceBeforeNextToken = false;
-   char stringChar = '\0';
-   char lastSignificant = '\0';
-   size_t controlKeywordLength = 0;
-   size_t controlKeywordProgress = 0;
-   size_t i = 0;
-
-   // --- append helpers keep spacing + keyword state in sync ---
-   auto appendChar = [&](char ch) {
-      if (forceSpaceBeforeNextToken && !std::isspace(static_cast<unsigned char>(ch))) {
-         result += ' ';
-         forceSpaceBeforeNextToken = false;
-      }
+   /**
+    * The internal minifier's per-character loop, compiled once per comment
+    * mode so the level is read once per script rather than per character.
+    */
+   template <bool stripBlockComments>
+   void minifyScript(std::string& js) {
+      std::string result;
+      result.reserve(js.length());
+
+      bool inString = false;
+      bool inRegex = false;
+      bool inSingleComment = false;
+      bool inMultiComment = false;
+      bool pendingSpace = false;
+      bool pendingLinebreak = false;
+      bool controlKeywordActive = false;
+      bool forceSpaceBeforeNextToken = false;
+      char stringChar = '\0';
+      char lastSignificant = '\0';
+      size_t controlKeywordLength = 0;
+      size_t controlKeywordProgress = 0;
+      size_t i = 0;
+
+      // --- append helpers keep spacing + keyword state in sync ---
+      auto appendChar = [&](char ch) {
+         if (forceSpaceBeforeNextToken && !std::isspace(static_cast<unsigned char>(ch))) {
+            result += ' ';
+            forceSpaceBeforeNextToken = false;
+         }
 
-      result += ch;
-      if (!std::isspace(static_cast<unsigned char>(ch))) {
-         lastSignificant = ch;
-         if (controlKeywordActive) {
-            ++controlKeywordProgress;
-            if (controlKeywordProgress >= controlKeywordLength) {
-               controlKeywordActive = false;
-               forceSpaceBeforeNextToken = true;
+         result += ch;
+         if (!std::isspace(static_cast<unsigned char>(ch))) {
+            lastSignificant = ch;
+            if (controlKeywordActive) {
+               ++controlKeywordProgress;
+               if (controlKeywordProgress >= controlKeywordLength) {
+                  controlKeywordActive = false;
+                  forceSpaceBeforeNextToken = true;
+               }
             }
          }
-      }
-   };
+      };
 
-   // --- treat alnum juxtaposition as identifiers needing space ---
-   auto needsSpaceBetween = [&](char prev, char current) {
-      return isIdentifierBody(prev) && isIdentifierBody(current);
-   };
+      // --- treat alnum juxtaposition as identifiers needing space ---
+      auto needsSpaceBetween = [&](char prev, char current) {
+         return isIdentifierBody(prev) && isIdentifierBody(current);
+      };
 
-   // --- flag else/catch/finally/while so next token gets a space ---
-   auto beginControlKeyword = [&](std::string_view keyword) {
-      if (keyword.empty()) {
-         return;
-      }
-      controlKeywordActive = true;
-      controlKeywordLength = keyword.size();
-      controlKeywordProgress = 0;
-      forceSpaceBeforeNextToken = true;
-   };
-
-   // --- newline boundary decides semicolon insertion rules ---
-   auto handleLinebreakBoundary = [&](char upcoming, std::string_view keyword) {
-      if (upcoming == '\0') {
-         return;
-      }
+      // --- flag else/catch/finally/while so next token gets a space ---
+      auto beginControlKeyword = [&](std::string_view keyword) {
+         if (keyword.empty()) {
+            return;
+         }
+         controlKeywordActive = true;
+         controlKeywordLength = keyword.size();
+         controlKeywordProgress = 0;
+         forceSpaceBeforeNextToken = true;
+      };
+
+      // --- newline boundary decides semicolon insertion rules ---
+      auto handleLinebreakBoundary = [&](char upcoming, std::string_view keyword) {
+         if (upcoming == '\0') {
+            return;
+         }
 
-      if (isStatementEndChar(lastSignificant) && isStatementStartChar(upcoming) && !isControlFlowFollower(keyword)) {
-         if (lastSignificant != ';') {
-            appendChar(';');
-            if (isIdentifierStart(upcoming)) {
-               forceSpaceBeforeNextToken = true;
+         if (isStatementEndChar(lastSignificant) && isStatementStartChar(upcoming) && !isControlFlowFollower(keyword)) {
+            if (lastSignificant != ';') {
+               appendChar(';');
+               if (isIdentifierStart(upcoming)) {
+                  forceSpaceBeforeNextToken = true;
+               }
             }
+            return;
          }
-         return;
-      }
 
-      if (lastSignificant == '}' && isControlFlowFollower(keyword)) {
-         beginControlKeyword(keyword);
-         return;
-      }
+         if (lastSignificant == '}' && isControlFlowFollower(keyword)) {
+            beginControlKeyword(keyword);
+            return;
+         }
 
-      if (needsSpaceBetween(lastSignificant, upcoming) && (result.empty() || result.back() != ' ')) {
-         appendChar(' ');
-      }
-   };
+         if (needsSpaceBetween(lastSignificant, upcoming) && (result.empty() || result.back() != ' ')) {
+            appendChar(' ');
+         }
+      };
 
-   while (i < js.length()) {
-      char current = js[i];
-      char next = (i + 1 < js.length()) ? js[i + 1] : '\0';
+      while (i < js.length()) {
+         char current = js[i];
+         char next = (i + 1 < js.length()) ? js[i + 1] : '\0';
 
-      // --- trim block comments only at EXTREME level ---
-      if (currentLevel == EXTREME) {
-         if (!inString && !inRegex && !inSingleComment && current == '/' && next == '*') {
-            inMultiComment = true;
+         // --- trim block comments only at EXTREME level ---
+         if constexpr (stripBlockComments) {
+            if (!inString && !inRegex && !inSingleComment && current == '/' && next == '*') {
+               inMultiComment = true;
+               i += 2;
+               continue;
+            }
+            if (inMultiComment) {
+               if (current == '*' && next == '/') {
+                  inMultiComment = false;
+                  i += 2;
+                  continue;
+               }
+               ++i;
+               continue;
+            }
+         }
+
+         // --- strip single-line comments, remember newline boundary ---
+         if (!inString && !inRegex && !inMultiComment && current == '/' && next == '/') {
+            inSingleComment = true;
             i += 2;
             continue;
          }
-         if (inMultiComment) {
-            if (current == '*' && next == '/') {
-               inMultiComment = false;
-               i += 2;
-               continue;
+         if (inSingleComment) {
+            if (current == '\n' || current == '\r') {
+               inSingleComment = false;
+               pendingLinebreak = true;
             }
             ++i;
             continue;
          }
-      }
 
-      // --- strip single-line comments, remember newline boundary ---
-      if (!inString && !inRegex && !inMultiComment && current == '/' && next == '/') {
-         inSingleComment = true;
-         i += 2;
-         continue;
-      }
-      if (inSingleComment) {
-         if (current == '\n' || current == '\r') {
-            inSingleComment = false;
-            pendingLinebreak = true;
+         // --- string literal boundaries (" ' `) ---
+         if (!inRegex && (current == '"' || current == '\'' || current == '`')) {
+            if (!inString) {
+               inString = true;
+               stringChar = current;
+            } else if (current == stringChar && (result.empty() || result.back() != '\\')) {
+               inString = false;
+            }
+            appendChar(current);
+            ++i;
+            continue;
          }
-         ++i;
-         continue;
-      }
 
-      // --- string literal boundaries (" ' `) ---
-      if (!inRegex && (current == '"' || current == '\'' || current == '`')) {
-         if (!inString) {
-            inString = true;
-            stringChar = current;
-         } else if (current == stringChar && (result.empty() || result.back() != '\\')) {
-            inString = false;
+         if (inString) {
+            appendChar(current);
+            ++i;
+            continue;
          }
-         appendChar(current);
-         ++i;
-         continue;
-      }
 
-      if (inString) {
-         appendChar(current);
-         ++i;
-         continue;
-      }
+         // --- whitespace collapsed into pending state ---
+         if (std::isspace(static_cast<unsigned char>(current))) {
+            if (current == '\n' || current == '\r') {
+               pendingLinebreak = true;
+               pendingSpace = false;
+            } else if (!pendingLinebreak) {
+               pendingSpace = true;
+            }
+            ++i;
+            continue;
+         }
 
-      // --- whitespace collapsed into pending state ---
-      if (std::isspace(static_cast<unsigned char>(current))) {
-         if (current == '\n' || current == '\r') {
-            pendingLinebreak = true;
+         // --- newline boundary may inject semicolons or spaces ---
+         if (pendingLinebreak) {
+            std::string_view keyword = readKeyword(js, i);
+            handleLinebreakBoundary(current, keyword);
+            pendingLinebreak = false;
+            pendingSpace = false;
+         } else if (pendingSpace) {
+            std::string_view keyword = readKeyword(js, i);
+            if (lastSignificant == '}' && isControlFlowFollower(keyword)) {
+               beginControlKeyword(keyword);
+            } else if (needsSpaceBetween(lastSignificant, current) && (result.empty() || result.back() != ' ')) {
+               appendChar(' ');
+            }
             pendingSpace = false;
-         } else if (!pendingLinebreak) {
-            pendingSpace = true;
          }
+
+         // --- default: copy token into output ---
+         appendChar(current);
          ++i;
-         continue;
       }
 
-      // --- newline boundary may inject semicolons or spaces ---
-      if (pendingLinebreak) {
-         std::string_view keyword = readKeyword(js, i);
-         handleLinebreakBoundary(current, keyword);
-         pendingLinebreak = false;
-         pendingSpace = false;
-      } else if (pendingSpace) {
-         std::string_view keyword = readKeyword(js, i);
-         if (lastSignificant == '}' && isControlFlowFollower(keyword)) {
-            beginControlKeyword(keyword);
-         } else if (needsSpaceBetween(lastSignificant, current) && (result.empty() || result.back() != ' ')) {
-            appendChar(' ');
-         }
-         pendingSpace = false;
-      }
+      js = std::move(result);
+   }
 
-      // --- default: copy token into output ---
-      appendChar(current);
-      ++i;
+   const char* describeRoute(BundlerRoute route) {
+      return route == BundlerRoute::NativeSmall ? "Below the bundler size threshold" : "Bundler savings over the internal minifier negligible";
    }
 
+   // --- A second, native minification only to learn esbuild's savings: sampled, and never against a deadline ---
+   bool comparesBundlerSavings() {
+      return HtmlCompressor::settings.deadline == 0 && HtmlCompressor::settings.bundlerDeadline == 0 && sampleBundlerSavings();
+   }
 
-   if (scope == "scoped" && !result.empty()) {
-      // trim the trailing ";" and whitespace
-      while (!result.empty() && (std::isspace(static_cast<unsigned char>(result.back())) || result.back() == ';')) {
-         result.pop_back();
-      }
-      result = "(()=>{" + result + ";})();";
+} // namespace
+
+void HtmlCompressor::minifyJS(std::string& js, const std::string& scope) {
+   // --- Vendor bundles and cached output: only trim ---
+   if (isMinifiedJS(js)) {
+      js = trim(js);
+      if (manglingNames()) mangleScript(js);
+      if (scope == "scoped") wrapScoped(js);
+      return;
    }
-   js = result;
+
+   const auto started = std::chrono::steady_clock::now();
+   const size_t bytes = js.size();
+   if (currentLevel == EXTREME) {
+      minifyScript<true>(js);
+   } else {
+      minifyScript<false>(js);
+   }
+   recordNativeRun(bytes, std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - started).count());
+
+   if (manglingNames()) mangleScript(js);
+   if (scope == "scoped") wrapScoped(js);
 }
 
 void HtmlCompressor::minifyJS(std::string& js, const std::string& scope, char* debugOutput) {
-   // BASIC level: use internal minifier only
-   if (currentLevel == BASIC) {
+   // WHITESPACE and BASIC levels: use internal minifier only
+   if (currentLevel <= BASIC) {
       if (debugOutput) {
          std::string debugStr = "Using internal minifier for " + scope + " (Level: BASIC)";
          strncpy(debugOutput, debugStr.c_str(), 1023);
@@ -451,10 +518,38 @@ void HtmlCompressor::minifyJS(std::string& js, const std::string& scope, char* d
       debugOutput[0] = '\0';
    }
 
+   // Already minified: a bundler spawn would return the same bytes
+   if (isMinifiedJS(js)) {
+      appendDebug(debugOutput, "Input already minified, skipping bundler for " + scope);
+      minifyJS(js, scope);
+      return;
+   }
+
+   // Too close to the caller's deadline for a bundler process
+   if (overDeadline(settings.bundlerDeadline)) {
+      appendDebug(debugOutput, "Deadline too close for the bundler, using internal minifier for " + scope);
+      minifyJS(js, scope);
+      return;
+   }
+
+   // Small scripts, or ones esbuild barely shrinks further: the spawn costs more than it saves
+   const BundlerRoute route = routeBundler(js.size(), settings.bundlerMinBytes);
+   if (route != BundlerRoute::Bundler) {
+      appendDebug(debugOutput, std::string(describeRoute(route)) + ", using internal minifier for " + scope);
+      minifyJS(js, scope);
+      return;
+   }
+
    // AGGRESSIVE and EXTREME: use esbuild bundler
    std::string bundled;
    if (runBundler(js, scope, currentLevel, bundled, debugOutput)) {
+      if (comparesBundlerSavings()) {
+         std::string native = js;
+         minifyJS(native, scope);
+         recordBundlerSavings(js.size(), native.size(), bundled.size());
+      }
       js = bundled;
+      if (manglingNames()) mangleScript(js);
       return;
    }
 
@@ -466,3 +561,36 @@ void HtmlCompressor::minifyJS(std::string& js, const std::string& scope, char* d
    }
    minifyJS(js, scope);
 }
+
+bool HtmlCompressor::minifyJSBatch(std::vector<std::string>& scripts, const std::string& scope, char* debugOutput) {
+   if (scripts.empty()) return true;
+   if (currentLevel <= BASIC || overDeadline(settings.bundlerDeadline)) return false;
+
+   // --- One spawn serves the whole batch, so its total size is what pays for it ---
+   size_t bytes = 0;
+   for (const std::string& script : scripts) bytes += script.size();
+
+   const BundlerRoute route = routeBundler(bytes, settings.bundlerMinBytes);
+   if (route != BundlerRoute::Bundler) {
+      appendDebug(debugOutput, std::string(describeRoute(route)) + ", using internal minifier for " + scope);
+      return false;
+   }
+
+   std::vector<std::string> bundled;
+   if (!runBundlerBatch(scripts, scope, currentLevel, bundled, debugOutput)) return false;
+
+   if (comparesBundlerSavings()) {
+      size_t nativeBytes = 0;
+      size_t bundledBytes = 0;
+      for (size_t i = 0; i < scripts.size(); ++i) {
+         std::string native = scripts[i];
+         minifyJS(native, scope);
+         nativeBytes += native.size();
+         bundledBytes += bundled[i].size();
+      }
+      recordBundlerSavings(bytes, nativeBytes, bundledBytes);
+   }
+
+   scripts = std::move(bundled);
+   return true;
+}
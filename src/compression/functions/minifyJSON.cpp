@@ -0,0 +1,182 @@
+#include "../HtmlCompressor.h"
+#include "../../utils/scan.h"
+
+#include <cctype>
+#include <cstring>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+   constexpr size_t kMaxDepth = 512;
+
+   bool isJsonWhitespace(char ch) {
+      return ch == ' ' || ch == '\t' || ch == '\n' || ch == '\r';
+   }
+
+   bool isDigit(char ch) {
+      return ch >= '0' && ch <= '9';
+   }
+
+   // --- Copies a string literal at pos; the vectorized scan skips plain runs between escapes ---
+   bool copyString(std::string_view json, size_t& pos, char*& out) {
+      const size_t start = pos++;
+
+      for (;;) {
+         pos = findStringStop(json, pos);
+         if (pos >= json.size()) return false;
+
+         const char ch = json[pos];
+         if (ch == '"') {
+            ++pos;
+            std::memcpy(out, json.data() + start, pos - start);
+            out += pos - start;
+            return true;
+         }
+         if (ch != '\\' || pos + 1 >= json.size()) return false; // --- raw control character ---
+
+         const char escaped = json[pos + 1];
+         if (escaped == 'u') {
+            if (pos + 6 > json.size()) return false;
+            for (size_t i = pos + 2; i < pos + 6; ++i) {
+               if (!std::isxdigit(static_cast<unsigned char>(json[i]))) return false;
+            }
+            pos += 6;
+         } else if (escaped == '"' || escaped == '\\' || escaped == '/' || escaped == 'b' || escaped == 'f' || escaped == 'n' || escaped == 'r' || escaped == 't') {
+            pos += 2;
+         } else {
+            return false;
+         }
+      }
+   }
+
+   // --- -?(0|[1-9][0-9]*)(.[0-9]+)?([eE][+-]?[0-9]+)? ---
+   bool copyNumber(std::string_view json, size_t& pos, char*& out) {
+      const size_t start = pos;
+      auto digits = [&]() {
+         const size_t from = pos;
+         while (pos < json.size() && isDigit(json[pos])) ++pos;
+         return pos > from;
+      };
+
+      if (json[pos] == '-') ++pos;
+      if (pos < json.size() && json[pos] == '0') {
+         ++pos;
+      } else if (!digits()) {
+         return false;
+      }
+
+      if (pos < json.size() && json[pos] == '.') {
+         ++pos;
+         if (!digits()) return false;
+      }
+      if (pos < json.size() && (json[pos] == 'e' || json[pos] == 'E')) {
+         ++pos;
+         if (pos < json.size() && (json[pos] == '+' || json[pos] == '-')) ++pos;
+         if (!digits()) return false;
+      }
+
+      std::memcpy(out, json.data() + start, pos - start);
+      out += pos - start;
+      return true;
+   }
+
+   bool copyLiteral(std::string_view json, size_t& pos, char*& out) {
+      for (const std::string_view literal : { "true", "false", "null" }) {
+         if (json.compare(pos, literal.size(), literal) == 0) {
+            std::memcpy(out, literal.data(), literal.size());
+            out += literal.size();
+            pos += literal.size();
+            return true;
+         }
+      }
+      return false;
+   }
+
+   /**
+    * Validates the document while copying every token without the
+    * whitespace between them into out, which has room for the whole
+    * input. Containers are tracked on an explicit stack, so deep nesting
+    * cannot overflow the call stack.
+    */
+   bool minifyDocument(std::string_view json, char*& out) {
+      std::vector<char> stack;
+      size_t pos = 0;
+
+      auto skipWhitespace = [&]() {
+         while (pos < json.size() && isJsonWhitespace(json[pos])) ++pos;
+      };
+
+      auto readKey = [&]() {
+         skipWhitespace();
+         if (pos >= json.size() || json[pos] != '"' || !copyString(json, pos, out)) return false;
+         skipWhitespace();
+         if (pos >= json.size() || json[pos] != ':') return false;
+         *out++ = ':';
+         ++pos;
+         return true;
+      };
+
+      for (;;) {
+         // --- A value ---
+         skipWhitespace();
+         if (pos >= json.size()) return false;
+
+         const char ch = json[pos];
+         if (ch == '{' || ch == '[') {
+            const char close = ch == '{' ? '}' : ']';
+            *out++ = ch;
+            ++pos;
+            skipWhitespace();
+
+            if (pos < json.size() && json[pos] == close) {
+               *out++ = close;
+               ++pos;
+            } else {
+               if (stack.size() >= kMaxDepth) return false;
+               stack.push_back(close);
+               if (ch == '{' && !readKey()) return false;
+               continue;
+            }
+         } else if (ch == '"') {
+            if (!copyString(json, pos, out)) return false;
+         } else if (ch == '-' || isDigit(ch)) {
+            if (!copyNumber(json, pos, out)) return false;
+         } else if (!copyLiteral(json, pos, out)) {
+            return false;
+         }
+
+         // --- After a value: close finished containers, or move on to the next member ---
+         for (;;) {
+            skipWhitespace();
+            if (stack.empty()) return pos == json.size();
+            if (pos >= json.size()) return false;
+
+            if (json[pos] == stack.back()) {
+               *out++ = stack.back();
+               stack.pop_back();
+               ++pos;
+               continue;
+            }
+            if (json[pos] != ',') return false;
+
+            *out++ = ',';
+            ++pos;
+            if (stack.back() == '}' && !readKey()) return false;
+            break;
+         }
+      }
+   }
+
+} // namespace
+
+bool HtmlCompressor::minifyJSON(std::string& json) {
+   std::string out(json.size(), '\0');
+   char* end = out.data();
+
+   if (!minifyDocument(json, end)) return false;
+
+   out.resize(static_cast<size_t>(end - out.data()));
+   json.swap(out);
+   return true;
+}
@@ -0,0 +1,219 @@
+#include "../HtmlCompressor.h"
+#include "../../utils/styleSheet.h"
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <initializer_list>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+   struct Token {
+      enum class Kind { StartTag, EndTag, Comment, Text, Other };
+
+      Kind kind;
+      std::string name; // --- lowercase, tags only ---
+      size_t start;
+      size_t end;       // --- one past the last byte ---
+      bool selfClosing = false;
+   };
+
+   /**
+    * End-tag omission rules (HTML Living Standard, "Optional tags").
+    * The end tag may go when the next token starts one of the followers,
+    * or, with parentEnd, when the next token ends the parent element.
+    */
+   struct OmissionRule {
+      std::string_view name;
+      std::initializer_list<std::string_view> followers;
+      bool parentEnd;
+   };
+
+   const std::array<OmissionRule, 14> kRules{ {
+      { "dd", { "dd", "dt" }, true },
+      { "dt", { "dd", "dt" }, false },
+      { "li", { "li" }, true },
+      { "optgroup", { "hr", "optgroup" }, true },
+      { "option", { "hr", "optgroup", "option" }, true },
+      { "p", { "address", "article", "aside", "blockquote", "details", "dialog", "div", "dl", "fieldset", "figcaption",
+               "figure", "footer", "form", "h1", "h2", "h3", "h4", "h5", "h6", "header", "hgroup", "hr", "main",
+               "menu", "nav", "ol", "p", "pre", "search", "section", "table", "ul" }, true },
+      { "rp", { "rp", "rt" }, true },
+      { "rt", { "rp", "rt" }, true },
+      { "tbody", { "tbody", "tfoot" }, true },
+      { "td", { "td", "th" }, true },
+      { "tfoot", {}, true },
+      { "th", { "td", "th" }, true },
+      { "thead", { "tbody", "tfoot" }, false },
+      { "tr", { "tr" }, true },
+   } };
+
+   // --- A </p> before these parents would not be implied by their end tag ---
+   constexpr std::array<std::string_view, 7> kTransparentParents{ "a", "audio", "del", "ins", "map", "noscript", "video" };
+
+   constexpr std::array<std::string_view, 15> kVoidElements{
+      "area", "base", "br", "col", "embed", "hr", "img", "input", "keygen", "link", "meta", "param", "source", "track", "wbr",
+   };
+
+   constexpr std::array<std::string_view, 9> kIntegrationPoints{
+      "annotation-xml", "desc", "foreignobject", "mi", "mn", "mo", "ms", "mtext", "title",
+   };
+
+   // --- Elements whose content is not markup ---
+   constexpr std::array<std::string_view, 9> kRawTextElements{
+      "iframe", "noembed", "noframes", "noscript", "script", "style", "textarea", "title", "xmp",
+   };
+
+   template <typename Container>
+   bool contains(const Container& names, std::string_view name) {
+      return std::find(names.begin(), names.end(), name) != names.end();
+   }
+
+   std::string readTagName(std::string_view html, size_t pos) {
+      std::string name;
+      while (pos < html.size() && (std::isalnum(static_cast<unsigned char>(html[pos])) || html[pos] == '-' || html[pos] == ':')) {
+         name += static_cast<char>(std::tolower(static_cast<unsigned char>(html[pos])));
+         ++pos;
+      }
+      return name;
+   }
+
+   // --- Position of the ">" closing the tag at pos, skipping quoted attribute values ---
+   size_t findTagEnd(std::string_view html, size_t pos) {
+      while (pos < html.size()) {
+         const char ch = html[pos];
+         if (ch == '>') return pos;
+         if ((ch == '"' || ch == '\'') && html[pos - 1] == '=') {
+            pos = html.find(ch, pos + 1);
+            if (pos == std::string_view::npos) return pos;
+         }
+         ++pos;
+      }
+      return std::string_view::npos;
+   }
+
+   bool tokenize(std::string_view html, std::vector<Token>& tokens) {
+      size_t pos = 0;
+      while (pos < html.size()) {
+         if (html[pos] != '<') {
+            size_t next = html.find('<', pos);
+            if (next == std::string_view::npos) next = html.size();
+            tokens.push_back({ Token::Kind::Text, "", pos, next });
+            pos = next;
+            continue;
+         }
+
+         if (html.compare(pos, 4, "<!--") == 0) {
+            const size_t end = html.find("-->", pos + 4);
+            if (end == std::string_view::npos) return false;
+            tokens.push_back({ Token::Kind::Comment, "", pos, end + 3 });
+            pos = end + 3;
+            continue;
+         }
+
+         const bool closing = pos + 1 < html.size() && html[pos + 1] == '/';
+         const size_t tagEnd = closing ? html.find('>', pos) : findTagEnd(html, pos + 1);
+         if (tagEnd == std::string_view::npos) return false;
+
+         Token token{ closing ? Token::Kind::EndTag : Token::Kind::StartTag, readTagName(html, pos + (closing ? 2 : 1)), pos, tagEnd + 1 };
+         if (token.name.empty()) token.kind = Token::Kind::Other; // --- doctype, processing instructions, stray "<" ---
+         token.selfClosing = html[tagEnd - 1] == '/';
+         tokens.push_back(token);
+         pos = tagEnd + 1;
+
+         if (token.kind == Token::Kind::StartTag && contains(kRawTextElements, token.name)) {
+            const size_t close = findTagIgnoreCase(html, "</" + token.name, pos);
+            if (close == std::string_view::npos) return false;
+            if (close > pos) tokens.push_back({ Token::Kind::Text, "", pos, close });
+            pos = close;
+         }
+      }
+      return true;
+   }
+
+   bool startsWithWhitespace(std::string_view html, const Token& token) {
+      return token.kind == Token::Kind::Text && std::isspace(static_cast<unsigned char>(html[token.start]));
+   }
+
+   bool canOmit(std::string_view html, const Token& next, const std::vector<std::string>& stack, bool noQuirks) {
+      const std::string& name = stack.back();
+
+      // --- html/body: unless a comment follows; head/colgroup/caption: unless whitespace or a comment follows ---
+      if (name == "html" || name == "body") return next.kind != Token::Kind::Comment;
+      if (name == "head" || name == "colgroup" || name == "caption") {
+         return next.kind != Token::Kind::Comment && !startsWithWhitespace(html, next);
+      }
+
+      const auto rule = std::find_if(kRules.begin(), kRules.end(), [&](const OmissionRule& candidate) { return candidate.name == name; });
+      if (rule == kRules.end()) return false;
+
+      if (next.kind == Token::Kind::StartTag && contains(rule->followers, next.name)) {
+         // --- In quirks mode <table> does not close an open <p> ---
+         return !(name == "p" && next.name == "table" && !noQuirks);
+      }
+
+      if (!rule->parentEnd || next.kind != Token::Kind::EndTag || stack.size() < 2) return false;
+
+      const std::string& parent = stack[stack.size() - 2];
+      if (next.name != parent) return false;
+      if (name == "p" && (contains(kTransparentParents, parent) || parent.find('-') != std::string::npos)) return false;
+
+      // --- Template contents: not every parser generates implied end tags at </template> ---
+      return parent != "template";
+   }
+
+} // namespace
+
+void HtmlCompressor::omitOptionalTags(std::string& html) {
+   std::vector<Token> tokens;
+   if (!tokenize(html, tokens)) return;
+
+   const bool noQuirks = html.size() >= 15 && findTagIgnoreCase(html, "<!doctype html", 0) == 0;
+   const Token endOfInput{ Token::Kind::Other, "", html.size(), html.size() };
+
+   std::vector<std::string> stack;
+   std::vector<bool> foreign; // --- per open element: SVG/MathML content rather than HTML ---
+   std::vector<size_t> omitted;
+
+   for (size_t i = 0; i < tokens.size(); ++i) {
+      const Token& token = tokens[i];
+
+      if (token.kind == Token::Kind::StartTag) {
+         const bool inForeign = !foreign.empty() && foreign.back() && !contains(kIntegrationPoints, stack.back());
+
+         // --- The parser would leave <svg>/<math> here, which the stack does not model ---
+         if (inForeign && isForeignBreakout(token.name)) return;
+         if (contains(kVoidElements, token.name) || (inForeign && token.selfClosing)) continue;
+
+         stack.push_back(token.name);
+         foreign.push_back(inForeign || token.name == "svg" || token.name == "math");
+         continue;
+      }
+      if (token.kind != Token::Kind::EndTag) continue;
+
+      // --- The source already relies on implied end tags: the stack is unknown, keep everything ---
+      if (stack.empty() || stack.back() != token.name) return;
+
+      const Token& next = i + 1 < tokens.size() ? tokens[i + 1] : endOfInput;
+      if (!foreign.back() && canOmit(html, next, stack, noQuirks)) omitted.push_back(i);
+
+      stack.pop_back();
+      foreign.pop_back();
+   }
+
+   if (omitted.empty()) return;
+
+   size_t writePos = 0;
+   size_t readPos = 0;
+   for (const size_t index : omitted) {
+      const Token& token = tokens[index];
+      std::copy(html.begin() + readPos, html.begin() + token.start, html.begin() + writePos);
+      writePos += token.start - readPos;
+      readPos = token.end;
+   }
+   std::copy(html.begin() + readPos, html.end(), html.begin() + writePos);
+   writePos += html.size() - readPos;
+   html.resize(writePos);
+}
@@ -1,11 +1,14 @@
 #include <iostream>
+#include <string_view>
 #include "../HtmlCompressor.h"
 #include "../../utils/trim.h"
 
-void HtmlCompressor::optimizeAttributes(std::string& tagContent) {
-   if (HtmlCompressor::currentLevel < AGGRESSIVE) return;
+template <HtmlCompressor::Level level>
+void HtmlCompressor::optimizeAttributes(std::string& tagContent, std::string& scratch) {
+   if constexpr (level < AGGRESSIVE) return;
 
-   std::string optimizedContent;
+   std::string& optimizedContent = scratch;
+   optimizedContent.clear();
    optimizedContent.reserve(tagContent.length()); // Pre-allocate to avoid reallocations
    bool lastWasSpace = false;
 
@@ -29,14 +32,27 @@ void HtmlCompressor::optimizeAttributes(std::string& tagContent) {
 
    // --- EXTREME LEVEL OPTIMIZATIONS ---
 
-   if (HtmlCompressor::currentLevel < EXTREME) {
-      tagContent = optimizedContent;
+   if constexpr (level < EXTREME) {
+      tagContent.swap(optimizedContent); // --- Both buffers keep their capacity for the next tag ---
       return;
    }
 
+   // --- Names rewritten before quoting is decided: the short names never need quotes ---
+   if (manglingNames() && optimizedContent.size() > 2 && optimizedContent[1] != '/') {
+      mangleAttributes(optimizedContent, tagContent);
+      optimizedContent.swap(tagContent);
+   }
+
+   // --- One token and attribute order for every copy of a tag, which gzip and brotli then match whole ---
+   if (settings.canonicalizeAttributes && optimizedContent.size() > 2 && optimizedContent[1] != '/') {
+      canonicalizeAttributes(optimizedContent, tagContent);
+      optimizedContent.swap(tagContent);
+   }
+
    // --- REMOVE QUOTES FROM ATTRIBUTES WHERE SAFE ---
 
-   std::string result;
+   std::string& result = tagContent;
+   result.clear();
    for (size_t i = 0; i < optimizedContent.length(); ++i) {
       char current = optimizedContent[i];
 
@@ -57,10 +73,11 @@ void HtmlCompressor::optimizeAttributes(std::string& tagContent) {
             size_t valueEnd = optimizedContent.find(quoteChar, valueStart);
 
             if (valueEnd != std::string::npos) {
-               std::string attributeValue = optimizedContent.substr(valueStart, valueEnd - valueStart);
+               std::string_view attributeValue(optimizedContent.data() + valueStart, valueEnd - valueStart);
 
                // Check if the value is safe to unquote
-               bool canUnquote = !attributeValue.empty();
+               // --- An unquoted value would swallow the "/" of a directly following "/>" ---
+               bool canUnquote = !attributeValue.empty() && (valueEnd + 1 >= optimizedContent.length() || optimizedContent[valueEnd + 1] != '/');
                for (char ch : attributeValue) {
                   if (isWhitespace(ch) || ch == '>' || ch == '<' || ch == '=' || ch == '"' || ch == '\'' || ch == '`') {
                      canUnquote = false;
@@ -87,5 +104,7 @@ void HtmlCompressor::optimizeAttributes(std::string& tagContent) {
       result += current;
    }
 
-   tagContent = result;
-}
\ No newline at end of file
+}
+
+template void HtmlCompressor::optimizeAttributes<HtmlCompressor::AGGRESSIVE>(std::string&, std::string&);
+template void HtmlCompressor::optimizeAttributes<HtmlCompressor::EXTREME>(std::string&, std::string&);
@@ -0,0 +1,496 @@
+#include "../HtmlCompressor.h"
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <optional>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace {
+
+   using Entry = std::pair<std::string_view, std::string_view>;
+
+   // --- CSS Color 4 named colors, sorted by name ---
+   constexpr std::array<Entry, 148> kNamedColors{ {
+      { "aliceblue", "f0f8ff" }, { "antiquewhite", "faebd7" }, { "aqua", "00ffff" }, { "aquamarine", "7fffd4" },
+      { "azure", "f0ffff" }, { "beige", "f5f5dc" }, { "bisque", "ffe4c4" }, { "black", "000000" },
+      { "blanchedalmond", "ffebcd" }, { "blue", "0000ff" }, { "blueviolet", "8a2be2" }, { "brown", "a52a2a" },
+      { "burlywood", "deb887" }, { "cadetblue", "5f9ea0" }, { "chartreuse", "7fff00" }, { "chocolate", "d2691e" },
+      { "coral", "ff7f50" }, { "cornflowerblue", "6495ed" }, { "cornsilk", "fff8dc" }, { "crimson", "dc143c" },
+      { "cyan", "00ffff" }, { "darkblue", "00008b" }, { "darkcyan", "008b8b" }, { "darkgoldenrod", "b8860b" },
+      { "darkgray", "a9a9a9" }, { "darkgreen", "006400" }, { "darkgrey", "a9a9a9" }, { "darkkhaki", "bdb76b" },
+      { "darkmagenta", "8b008b" }, { "darkolivegreen", "556b2f" }, { "darkorange", "ff8c00" }, { "darkorchid", "9932cc" },
+      { "darkred", "8b0000" }, { "darksalmon", "e9967a" }, { "darkseagreen", "8fbc8f" }, { "darkslateblue", "483d8b" },
+      { "darkslategray", "2f4f4f" }, { "darkslategrey", "2f4f4f" }, { "darkturquoise", "00ced1" }, { "darkviolet", "9400d3" },
+      { "deeppink", "ff1493" }, { "deepskyblue", "00bfff" }, { "dimgray", "696969" }, { "dimgrey", "696969" },
+      { "dodgerblue", "1e90ff" }, { "firebrick", "b22222" }, { "floralwhite", "fffaf0" }, { "forestgreen", "228b22" },
+      { "fuchsia", "ff00ff" }, { "gainsboro", "dcdcdc" }, { "ghostwhite", "f8f8ff" }, { "gold", "ffd700" },
+      { "goldenrod", "daa520" }, { "gray", "808080" }, { "green", "008000" }, { "greenyellow", "adff2f" },
+      { "grey", "808080" }, { "honeydew", "f0fff0" }, { "hotpink", "ff69b4" }, { "indianred", "cd5c5c" },
+      { "indigo", "4b0082" }, { "ivory", "fffff0" }, { "khaki", "f0e68c" }, { "lavender", "e6e6fa" },
+      { "lavenderblush", "fff0f5" }, { "lawngreen", "7cfc00" }, { "lemonchiffon", "fffacd" }, { "lightblue", "add8e6" },
+      { "lightcoral", "f08080" }, { "lightcyan", "e0ffff" }, { "lightgoldenrodyellow", "fafad2" }, { "lightgray", "d3d3d3" },
+      { "lightgreen", "90ee90" }, { "lightgrey", "d3d3d3" }, { "lightpink", "ffb6c1" }, { "lightsalmon", "ffa07a" },
+      { "lightseagreen", "20b2aa" }, { "lightskyblue", "87cefa" }, { "lightslategray", "778899" }, { "lightslategrey", "778899" },
+      { "lightsteelblue", "b0c4de" }, { "lightyellow", "ffffe0" }, { "lime", "00ff00" }, { "limegreen", "32cd32" },
+      { "linen", "faf0e6" }, { "magenta", "ff00ff" }, { "maroon", "800000" }, { "mediumaquamarine", "66cdaa" },
+      { "mediumblue", "0000cd" }, { "mediumorchid", "ba55d3" }, { "mediumpurple", "9370db" }, { "mediumseagreen", "3cb371" },
+      { "mediumslateblue", "7b68ee" }, { "mediumspringgreen", "00fa9a" }, { "mediumturquoise", "48d1cc" }, { "mediumvioletred", "c71585" },
+      { "midnightblue", "191970" }, { "mintcream", "f5fffa" }, { "mistyrose", "ffe4e1" }, { "moccasin", "ffe4b5" },
+      { "navajowhite", "ffdead" }, { "navy", "000080" }, { "oldlace", "fdf5e6" }, { "olive", "808000" },
+      { "olivedrab", "6b8e23" }, { "orange", "ffa500" }, { "orangered", "ff4500" }, { "orchid", "da70d6" },
+      { "palegoldenrod", "eee8aa" }, { "palegreen", "98fb98" }, { "paleturquoise", "afeeee" }, { "palevioletred", "db7093" },
+      { "papayawhip", "ffefd5" }, { "peachpuff", "ffdab9" }, { "peru", "cd853f" }, { "pink", "ffc0cb" },
+      { "plum", "dda0dd" }, { "powderblue", "b0e0e6" }, { "purple", "800080" }, { "rebeccapurple", "663399" },
+      { "red", "ff0000" }, { "rosybrown", "bc8f8f" }, { "royalblue", "4169e1" }, { "saddlebrown", "8b4513" },
+      { "salmon", "fa8072" }, { "sandybrown", "f4a460" }, { "seagreen", "2e8b57" }, { "seashell", "fff5ee" },
+      { "sienna", "a0522d" }, { "silver", "c0c0c0" }, { "skyblue", "87ceeb" }, { "slateblue", "6a5acd" },
+      { "slategray", "708090" }, { "slategrey", "708090" }, { "snow", "fffafa" }, { "springgreen", "00ff7f" },
+      { "steelblue", "4682b4" }, { "tan", "d2b48c" }, { "teal", "008080" }, { "thistle", "d8bfd8" },
+      { "tomato", "ff6347" }, { "turquoise", "40e0d0" }, { "violet", "ee82ee" }, { "wheat", "f5deb3" },
+      { "white", "ffffff" }, { "whitesmoke", "f5f5f5" }, { "yellow", "ffff00" }, { "yellowgreen", "9acd32" },
+   } };
+
+   // --- Properties whose bare identifiers may be named colors ---
+   constexpr std::array<std::string_view, 33> kColorProperties{
+      "accent-color", "background", "background-color", "border", "border-block", "border-block-color",
+      "border-bottom", "border-bottom-color", "border-color", "border-inline", "border-inline-color", "border-left",
+      "border-left-color", "border-right", "border-right-color", "border-top", "border-top-color", "box-shadow",
+      "caret-color", "color", "column-rule", "column-rule-color", "fill", "flood-color", "lighting-color", "outline",
+      "outline-color", "scrollbar-color", "stop-color", "stroke", "text-decoration", "text-decoration-color", "text-shadow",
+   };
+
+   // --- Shorthands whose repeated side values collapse (top right bottom left / corners) ---
+   constexpr std::array<std::string_view, 9> kFourSideShorthands{
+      "border-color", "border-radius", "border-style", "border-width", "inset", "margin", "padding", "scroll-margin", "scroll-padding",
+   };
+
+   // --- Shorthands where "x x" equals "x" ---
+   constexpr std::array<std::string_view, 9> kPairShorthands{
+      "border-spacing", "gap", "inset-block", "inset-inline", "margin-block", "margin-inline",
+      "overflow", "padding-block", "padding-inline",
+   };
+
+   // --- Whole-value keyword replacements: property, keyword, replacement ---
+   struct Keyword {
+      std::string_view property;
+      std::string_view keyword;
+      std::string_view replacement;
+   };
+
+   constexpr std::array<Keyword, 8> kKeywords{ {
+      { "border", "none", "0" },
+      { "border-bottom", "none", "0" },
+      { "border-left", "none", "0" },
+      { "border-right", "none", "0" },
+      { "border-top", "none", "0" },
+      { "font-weight", "bold", "700" },
+      { "font-weight", "normal", "400" },
+      { "outline", "none", "0" },
+   } };
+
+   // --- Units a zero can drop (outside calc-like functions) ---
+   constexpr std::array<std::string_view, 14> kLengthUnits{
+      "ch", "cm", "em", "ex", "in", "mm", "pc", "pt", "px", "rem", "vh", "vmax", "vmin", "vw",
+   };
+
+   template <size_t N>
+   bool contains(const std::array<std::string_view, N>& table, std::string_view value) {
+      return std::binary_search(table.begin(), table.end(), value);
+   }
+
+   std::string toLower(std::string_view value) {
+      std::string lower(value);
+      for (char& ch : lower) ch = static_cast<char>(std::tolower(static_cast<unsigned char>(ch)));
+      return lower;
+   }
+
+   bool isIdentChar(char ch) {
+      return std::isalnum(static_cast<unsigned char>(ch)) || ch == '-' || ch == '_';
+   }
+
+   bool isPropertyName(std::string_view name) {
+      if (name.empty() || name.front() == '@') return false;
+      return std::all_of(name.begin(), name.end(), isIdentChar);
+   }
+
+   std::optional<std::string_view> namedColorHex(std::string_view lowerName) {
+      const auto it = std::lower_bound(kNamedColors.begin(), kNamedColors.end(), lowerName, [](const Entry& entry, std::string_view name) {
+         return entry.first < name;
+      });
+      if (it == kNamedColors.end() || it->first != lowerName) return std::nullopt;
+      return it->second;
+   }
+
+   // --- Shortest name for a 6-digit hex, if any ---
+   std::optional<std::string_view> hexColorName(std::string_view hex) {
+      std::optional<std::string_view> best;
+      for (const Entry& entry : kNamedColors) {
+         if (entry.second == hex && (!best || entry.first.size() < best->size())) best = entry.first;
+      }
+      return best;
+   }
+
+   // --- Shortest spelling of an opaque (6-digit) or translucent (8-digit) lowercase hex ---
+   std::string shortestHex(std::string hex) {
+      if (hex.size() == 8 && hex.ends_with("ff")) hex.resize(6);
+
+      bool pairs = true;
+      for (size_t i = 0; i < hex.size(); i += 2) pairs = pairs && hex[i] == hex[i + 1];
+
+      std::string best = "#";
+      if (pairs) {
+         for (size_t i = 0; i < hex.size(); i += 2) best += hex[i];
+      } else {
+         best += hex;
+      }
+
+      if (hex.size() == 6) {
+         const std::optional<std::string_view> name = hexColorName(hex);
+         if (name && name->size() < best.size()) return std::string(*name);
+      }
+      return best;
+   }
+
+   std::string toHexPair(int value) {
+      const char* digits = "0123456789abcdef";
+      return { digits[(value >> 4) & 0xF], digits[value & 0xF] };
+   }
+
+   // --- "1.50" -> "1.5", "0.50" -> ".5", "2.0" -> "2" ---
+   std::string trimNumber(std::string_view number) {
+      const size_t dot = number.find('.');
+      if (dot != std::string_view::npos) {
+         while (number.size() > dot + 1 && number.back() == '0') number.remove_suffix(1);
+         if (number.back() == '.') number.remove_suffix(1);
+      }
+
+      const std::string_view sign = (!number.empty() && (number[0] == '-' || number[0] == '+')) ? number.substr(0, 1) : std::string_view();
+      number.remove_prefix(sign.size());
+      while (number.size() > 1 && number[0] == '0' && number[1] != '.') number.remove_prefix(1);
+      if (number.size() > 2 && number[0] == '0' && number[1] == '.') number.remove_prefix(1);
+
+      if (number.empty()) return "0";
+      std::string out(sign);
+      out.append(number);
+      return out;
+   }
+
+   std::string formatAlpha(double alpha) {
+      char buffer[16];
+      snprintf(buffer, sizeof(buffer), "%.3f", alpha);
+      return trimNumber(buffer);
+   }
+
+   // --- Parses one color function argument: a number with an optional unit ---
+   std::optional<std::pair<double, std::string_view>> parseArgument(std::string_view argument) {
+      size_t length = 0;
+      while (length < argument.size() && (std::isdigit(static_cast<unsigned char>(argument[length])) || argument[length] == '.' || argument[length] == '-' || argument[length] == '+')) {
+         ++length;
+      }
+      if (length == 0) return std::nullopt;
+
+      try {
+         const double value = std::stod(std::string(argument.substr(0, length)));
+         return std::make_pair(value, argument.substr(length));
+      } catch (...) {
+         return std::nullopt;
+      }
+   }
+
+   std::vector<std::string_view> splitArguments(std::string_view args, std::string_view& alpha) {
+      std::vector<std::string_view> parts;
+      alpha = {};
+
+      const size_t slash = args.find('/');
+      std::string_view channels = args.substr(0, slash);
+      if (slash != std::string_view::npos) alpha = args.substr(slash + 1);
+
+      const char separator = channels.find(',') != std::string_view::npos ? ',' : ' ';
+      size_t start = 0;
+      while (start <= channels.size()) {
+         size_t end = channels.find(separator, start);
+         if (end == std::string_view::npos) end = channels.size();
+         std::string_view part = channels.substr(start, end - start);
+         while (!part.empty() && part.front() == ' ') part.remove_prefix(1);
+         while (!part.empty() && part.back() == ' ') part.remove_suffix(1);
+         if (!part.empty()) parts.push_back(part);
+         start = end + 1;
+      }
+
+      while (!alpha.empty() && alpha.front() == ' ') alpha.remove_prefix(1);
+      while (!alpha.empty() && alpha.back() == ' ') alpha.remove_suffix(1);
+      if (alpha.empty() && parts.size() == 4) {
+         alpha = parts.back();
+         parts.pop_back();
+      }
+      return parts;
+   }
+
+   double hueToChannel(double p, double q, double t) {
+      if (t < 0) t += 1;
+      if (t > 1) t -= 1;
+      if (t < 1.0 / 6) return p + (q - p) * 6 * t;
+      if (t < 1.0 / 2) return q;
+      if (t < 2.0 / 3) return p + (q - p) * (2.0 / 3 - t) * 6;
+      return p;
+   }
+
+   /**
+    * Rewrite rgb()/rgba()/hsl()/hsla() with literal arguments.
+    * Opaque colors become hex (or a shorter name); translucent ones become
+    * #rrggbbaa at EXTREME when the alpha survives 8-bit rounding.
+    */
+   std::optional<std::string> convertColorFunction(std::string_view name, std::string_view args) {
+      std::string_view alphaText;
+      const std::vector<std::string_view> parts = splitArguments(args, alphaText);
+      if (parts.size() != 3) return std::nullopt;
+
+      int channels[3];
+      if (name == "rgb" || name == "rgba") {
+         for (int i = 0; i < 3; ++i) {
+            const auto argument = parseArgument(parts[i]);
+            if (!argument) return std::nullopt;
+            double value = argument->first;
+            if (argument->second == "%") value = value * 255.0 / 100.0;
+            else if (!argument->second.empty()) return std::nullopt;
+            channels[i] = std::clamp(static_cast<int>(std::lround(value)), 0, 255);
+         }
+      } else {
+         const auto hue = parseArgument(parts[0]);
+         const auto saturation = parseArgument(parts[1]);
+         const auto lightness = parseArgument(parts[2]);
+         if (!hue || !saturation || !lightness) return std::nullopt;
+         if (!(hue->second.empty() || hue->second == "deg") || saturation->second != "%" || lightness->second != "%") return std::nullopt;
+
+         const double h = std::fmod(std::fmod(hue->first, 360.0) + 360.0, 360.0) / 360.0;
+         const double s = std::clamp(saturation->first, 0.0, 100.0) / 100.0;
+         const double l = std::clamp(lightness->first, 0.0, 100.0) / 100.0;
+         const double q = l < 0.5 ? l * (1 + s) : l + s - l * s;
+         const double p = 2 * l - q;
+         const double rgb[3] = { hueToChannel(p, q, h + 1.0 / 3), hueToChannel(p, q, h), hueToChannel(p, q, h - 1.0 / 3) };
+         for (int i = 0; i < 3; ++i) channels[i] = std::clamp(static_cast<int>(std::lround(rgb[i] * 255.0)), 0, 255);
+      }
+
+      double alpha = 1.0;
+      if (!alphaText.empty()) {
+         const auto argument = parseArgument(alphaText);
+         if (!argument) return std::nullopt;
+         alpha = argument->first;
+         if (argument->second == "%") alpha /= 100.0;
+         else if (!argument->second.empty()) return std::nullopt;
+         alpha = std::clamp(alpha, 0.0, 1.0);
+      }
+
+      const std::string hex = toHexPair(channels[0]) + toHexPair(channels[1]) + toHexPair(channels[2]);
+      if (alpha >= 1.0) return shortestHex(hex);
+
+      std::string best = "rgba(" + std::to_string(channels[0]) + "," + std::to_string(channels[1]) + "," +
+                         std::to_string(channels[2]) + "," + formatAlpha(alpha) + ")";
+
+      if (HtmlCompressor::currentLevel >= HtmlCompressor::EXTREME) {
+         const int alphaByte = static_cast<int>(std::lround(alpha * 255.0));
+         // --- Only when the 8-bit alpha prints back as the same value ---
+         if (formatAlpha(std::round(alphaByte / 255.0 * 100.0) / 100.0) == formatAlpha(alpha)) {
+            const std::string candidate = shortestHex(hex + toHexPair(alphaByte));
+            if (candidate.size() < best.size()) best = candidate;
+         }
+      }
+      return best;
+   }
+
+   // --- Collapse "a b a b" style repeats in a side/corner shorthand ---
+   std::string collapseSides(std::string_view value, bool fourSides) {
+      std::vector<std::string_view> parts;
+      size_t start = 0;
+      while (start < value.size()) {
+         size_t end = value.find(' ', start);
+         if (end == std::string_view::npos) end = value.size();
+         if (end > start) parts.push_back(value.substr(start, end - start));
+         start = end + 1;
+      }
+
+      if (fourSides) {
+         if (parts.size() < 2 || parts.size() > 4) return std::string(value);
+         if (parts.size() == 4 && parts[3] == parts[1]) parts.pop_back();
+         if (parts.size() == 3 && parts[2] == parts[0]) parts.pop_back();
+         if (parts.size() == 2 && parts[1] == parts[0]) parts.pop_back();
+      } else if (parts.size() == 2 && parts[0] == parts[1]) {
+         parts.pop_back();
+      }
+
+      std::string out;
+      for (const std::string_view part : parts) {
+         if (!out.empty()) out += ' ';
+         out += part;
+      }
+      return out;
+   }
+
+   // --- Optimize one declaration value (placeholders already hide strings and urls) ---
+   std::string optimizeValue(const std::string& property, std::string_view value) {
+      std::string_view important;
+      const size_t bang = value.find('!');
+      if (bang != std::string_view::npos) {
+         important = value.substr(bang);
+         value = value.substr(0, bang);
+         while (!value.empty() && value.back() == ' ') value.remove_suffix(1);
+      }
+
+      const std::string lowerValue = toLower(value);
+      for (const Keyword& keyword : kKeywords) {
+         if (keyword.property == property && keyword.keyword == lowerValue) {
+            return std::string(keyword.replacement) + std::string(important);
+         }
+      }
+
+      const bool colorProperty = contains(kColorProperties, property);
+      std::string out;
+      out.reserve(value.size());
+      std::vector<bool> calcStack; // --- One entry per open parenthesis: inside calc()/min()/max()/clamp()? ---
+
+      size_t i = 0;
+      while (i < value.size()) {
+         const char ch = value[i];
+
+         if (ch == '#') {
+            size_t end = i + 1;
+            while (end < value.size() && std::isxdigit(static_cast<unsigned char>(value[end]))) ++end;
+            const size_t length = end - i - 1;
+            if ((length == 3 || length == 4 || length == 6 || length == 8) && (end == value.size() || !isIdentChar(value[end]))) {
+               std::string hex = toLower(value.substr(i + 1, length));
+               if (length <= 4) {
+                  std::string expanded;
+                  for (const char digit : hex) expanded += std::string(2, digit);
+                  hex = expanded;
+               }
+               out += shortestHex(hex);
+               i = end;
+               continue;
+            }
+            out += ch;
+            ++i;
+            continue;
+         }
+
+         const bool numberStart = std::isdigit(static_cast<unsigned char>(ch)) ||
+                                  (ch == '.' && i + 1 < value.size() && std::isdigit(static_cast<unsigned char>(value[i + 1])));
+         if (numberStart && (out.empty() || !isIdentChar(out.back()) || out.back() == '-')) {
+            size_t end = i;
+            bool dot = false;
+            while (end < value.size() && (std::isdigit(static_cast<unsigned char>(value[end])) || (value[end] == '.' && !dot))) {
+               dot = dot || value[end] == '.';
+               ++end;
+            }
+            size_t unitEnd = end;
+            while (unitEnd < value.size() && (std::isalpha(static_cast<unsigned char>(value[unitEnd])) || value[unitEnd] == '%')) ++unitEnd;
+
+            const std::string number = trimNumber(value.substr(i, end - i));
+            const std::string unit = toLower(value.substr(end, unitEnd - end));
+            // --- calc() needs typed zeros; old engines read a unitless flex basis as a factor ---
+            const bool keepUnit = property == "flex" || std::find(calcStack.begin(), calcStack.end(), true) != calcStack.end();
+
+            out += number;
+            if (!(number == "0" && !keepUnit && contains(kLengthUnits, unit))) out.append(value.substr(end, unitEnd - end));
+            i = unitEnd;
+            continue;
+         }
+
+         const bool signedNumber = ch == '-' && i + 1 < value.size() && (std::isdigit(static_cast<unsigned char>(value[i + 1])) || value[i + 1] == '.');
+         if (std::isalpha(static_cast<unsigned char>(ch)) || ch == '_' || (ch == '-' && !signedNumber)) {
+            size_t end = i;
+            while (end < value.size() && isIdentChar(value[end])) ++end;
+            const std::string_view ident = value.substr(i, end - i);
+            const std::string lowerIdent = toLower(ident);
+
+            if (end < value.size() && value[end] == '(') {
+               if (lowerIdent == "rgb" || lowerIdent == "rgba" || lowerIdent == "hsl" || lowerIdent == "hsla") {
+                  const size_t close = value.find(')', end);
+                  if (close != std::string_view::npos) {
+                     const std::optional<std::string> color = convertColorFunction(lowerIdent, value.substr(end + 1, close - end - 1));
+                     if (color) {
+                        out += *color;
+                        i = close + 1;
+                        continue;
+                     }
+                  }
+               }
+               calcStack.push_back(lowerIdent == "calc" || lowerIdent == "min" || lowerIdent == "max" || lowerIdent == "clamp");
+               out.append(ident);
+               out += '(';
+               i = end + 1;
+               continue;
+            }
+
+            if (colorProperty) {
+               const std::optional<std::string_view> hex = namedColorHex(lowerIdent);
+               if (hex) {
+                  const std::string shortest = shortestHex(std::string(*hex));
+                  out += shortest.size() < ident.size() ? shortest : lowerIdent;
+                  i = end;
+                  continue;
+               }
+            }
+
+            out.append(ident);
+            i = end;
+            continue;
+         }
+
+         if (ch == '(') calcStack.push_back(!calcStack.empty() && calcStack.back());
+         if (ch == ')' && !calcStack.empty()) calcStack.pop_back();
+         out += ch;
+         ++i;
+      }
+
+      if (contains(kFourSideShorthands, property) && out.find_first_of(",/(") == std::string::npos) {
+         out = collapseSides(out, true);
+      } else if (contains(kPairShorthands, property) && out.find_first_of(",/(") == std::string::npos) {
+         out = collapseSides(out, false);
+      }
+
+      if (!important.empty()) out.append(important);
+      return out;
+   }
+
+} // namespace
+
+void HtmlCompressor::optimizeCSSValues(std::string& css) {
+   std::string out;
+   out.reserve(css.size());
+
+   size_t pos = 0;
+   while (pos < css.size()) {
+      const size_t end = css.find_first_of(";{}", pos);
+      if (end == std::string::npos) {
+         out.append(css, pos, std::string::npos);
+         break;
+      }
+
+      const std::string_view segment(css.data() + pos, end - pos);
+      const size_t colon = segment.find(':');
+
+      // --- Selectors, at-rule preludes and anything that is not a plain declaration stay untouched ---
+      const bool declaration = css[end] != '{' && colon != std::string_view::npos && colon > 0;
+      const std::string_view property = declaration ? segment.substr(0, colon) : std::string_view();
+
+      // --- Custom properties are opaque; unicode-range hex digits are not numbers ---
+      if (declaration && isPropertyName(property) && property.substr(0, 2) != "--" && property != "unicode-range" &&
+          segment.find('\\') == std::string_view::npos && segment.find("progid:") == std::string_view::npos) {
+         out.append(property);
+         out += ':';
+         out += optimizeValue(toLower(property), segment.substr(colon + 1));
+      } else {
+         out.append(segment);
+      }
+
+      out += css[end];
+      pos = end + 1;
+   }
+
+   css.swap(out);
+}
@@ -0,0 +1,39 @@
+#include "../HtmlCompressor.h"
+#include "../../utils/styleSheet.h"
+#include "../../utils/trace.h"
+
+namespace {
+
+   // --- Fragments (component responses) are styled by a page we cannot see ---
+   bool isFullDocument(std::string_view html) {
+      return findTagIgnoreCase(html, "<!doctype", 0) != std::string_view::npos ||
+             findTagIgnoreCase(html, "<html", 0) != std::string_view::npos ||
+             findTagIgnoreCase(html, "<body", 0) != std::string_view::npos;
+   }
+
+} // namespace
+
+void HtmlCompressor::optimizeStyleBlocks(std::string& html) {
+   const bool prune = settings.pruneUnusedCSS && isFullDocument(html);
+   const bool merge = currentLevel >= EXTREME;
+   if (!prune && !merge) return;
+
+   std::vector<StyleBlock> blocks = findStyleBlocks(html);
+
+   // --- One unparsable block makes the cascade unknowable: leave the page alone ---
+   if (blocks.empty() || !parseStyleBlocks(html, blocks)) return;
+
+   bool changed = false;
+   if (prune) {
+      TraceSpan span("pruneUnusedRules");
+      span.arg("blocks", static_cast<int64_t>(blocks.size()));
+      changed = pruneUnusedRules(html, blocks) || changed;
+   }
+   if (merge) {
+      TraceSpan span("mergeStyleRules");
+      span.arg("blocks", static_cast<int64_t>(blocks.size()));
+      changed = mergeStyleRules(blocks) || changed;
+   }
+
+   if (changed) writeStyleBlocks(html, blocks);
+}
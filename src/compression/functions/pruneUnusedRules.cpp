@@ -0,0 +1,253 @@
+#include "../HtmlCompressor.h"
+#include "../../utils/styleSheet.h"
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+namespace {
+
+   // --- Elements the parser creates even when the markup omits them ---
+   constexpr std::array<std::string_view, 3> kImpliedTags{ "body", "head", "html" };
+
+   struct DocumentNames {
+      std::unordered_set<std::string> tags;
+      std::unordered_set<std::string> classes;
+      std::unordered_set<std::string> ids;
+      std::vector<std::string> prefixes; // --- allowlist entries ending in "*" ---
+
+      bool allowedByPrefix(const std::string& name) const {
+         return std::any_of(prefixes.begin(), prefixes.end(), [&](const std::string& prefix) {
+            return name.compare(0, prefix.size(), prefix) == 0;
+         });
+      }
+   };
+
+   std::string toLower(std::string_view value) {
+      std::string lower(value);
+      for (char& ch : lower) ch = static_cast<char>(std::tolower(static_cast<unsigned char>(ch)));
+      return lower;
+   }
+
+   void addTokens(std::string_view value, std::unordered_set<std::string>& names) {
+      size_t pos = 0;
+      while (pos < value.size()) {
+         while (pos < value.size() && std::isspace(static_cast<unsigned char>(value[pos]))) ++pos;
+         size_t end = pos;
+         while (end < value.size() && !std::isspace(static_cast<unsigned char>(value[end]))) ++end;
+         if (end > pos) names.emplace(value.substr(pos, end - pos));
+         pos = end;
+      }
+   }
+
+   // --- Every tag name, class and id in the markup, including <template> and non-JS <script> templates ---
+   DocumentNames collectNames(std::string_view html) {
+      DocumentNames names;
+
+      for (size_t pos = html.find('<'); pos != std::string_view::npos; pos = html.find('<', pos + 1)) {
+         if (html.compare(pos, 4, "<!--") == 0) {
+            const size_t end = html.find("-->", pos + 4);
+            if (end == std::string_view::npos) break;
+            pos = end;
+            continue;
+         }
+
+         size_t nameEnd = pos + 1;
+         while (nameEnd < html.size() && (std::isalnum(static_cast<unsigned char>(html[nameEnd])) || html[nameEnd] == '-' || html[nameEnd] == ':')) ++nameEnd;
+         if (nameEnd == pos + 1) continue;
+
+         const size_t tagEnd = html.find('>', nameEnd);
+         if (tagEnd == std::string_view::npos) break;
+
+         const std::string_view tag = html.substr(pos, tagEnd - pos + 1);
+         const std::string tagName = toLower(html.substr(pos + 1, nameEnd - pos - 1));
+         names.tags.insert(tagName);
+         addTokens(tagAttribute(tag, "class"), names.classes);
+         addTokens(tagAttribute(tag, "id"), names.ids);
+
+         // --- Raw text bodies: stylesheets and scripts contain no markup, templates do ---
+         const bool rawText = tagName == "style" || (tagName == "script" && classifyScriptType(tagAttribute(tag, "type")) == ScriptKind::JavaScript);
+         if (rawText) {
+            const size_t close = findTagIgnoreCase(html, "</" + tagName, tagEnd);
+            if (close == std::string_view::npos) break;
+            pos = close;
+            continue;
+         }
+         pos = tagEnd;
+      }
+      return names;
+   }
+
+   void addAllowlist(const std::vector<std::string>& allowlist, DocumentNames& names) {
+      for (const std::string& entry : allowlist) {
+         if (entry.empty()) continue;
+         if (entry.back() == '*') {
+            names.prefixes.push_back(entry.substr(entry.front() == '#' || entry.front() == '.' ? 1 : 0, std::string::npos));
+            names.prefixes.back().pop_back();
+         } else if (entry.front() == '#') {
+            names.ids.insert(entry.substr(1));
+         } else {
+            names.classes.insert(entry.front() == '.' ? entry.substr(1) : entry);
+         }
+      }
+   }
+
+   bool isIdentStart(char ch) {
+      return std::isalpha(static_cast<unsigned char>(ch)) || ch == '_' || ch == '-' || ch == '\\' || static_cast<unsigned char>(ch) >= 0x80;
+   }
+
+   // --- Reads a CSS identifier at pos, resolving escapes ("md\:flex" -> "md:flex") ---
+   std::string readIdent(std::string_view selector, size_t& pos) {
+      std::string ident;
+      while (pos < selector.size()) {
+         const char ch = selector[pos];
+         if (ch == '\\' && pos + 1 < selector.size()) {
+            ++pos;
+            if (std::isxdigit(static_cast<unsigned char>(selector[pos]))) {
+               size_t end = pos;
+               while (end < selector.size() && end - pos < 6 && std::isxdigit(static_cast<unsigned char>(selector[end]))) ++end;
+               const unsigned long code = std::stoul(std::string(selector.substr(pos, end - pos)), nullptr, 16);
+               // --- Non-ASCII escapes: keep a marker that never matches, which only means "may match" is lost ---
+               ident += code < 0x80 ? static_cast<char>(code) : '\x7f';
+               pos = end;
+               if (pos < selector.size() && selector[pos] == ' ') ++pos;
+            } else {
+               ident += selector[pos++];
+            }
+            continue;
+         }
+         if (!(std::isalnum(static_cast<unsigned char>(ch)) || ch == '-' || ch == '_' || static_cast<unsigned char>(ch) >= 0x80)) break;
+         ident += ch;
+         ++pos;
+      }
+      return ident;
+   }
+
+   size_t skipGroup(std::string_view selector, size_t pos, char open, char close) {
+      int depth = 0;
+      while (pos < selector.size()) {
+         const char ch = selector[pos];
+         if (ch == '"' || ch == '\'') {
+            const size_t end = selector.find(ch, pos + 1);
+            if (end == std::string_view::npos) return selector.size();
+            pos = end + 1;
+            continue;
+         }
+         if (ch == open) ++depth;
+         else if (ch == close && --depth == 0) return pos + 1;
+         ++pos;
+      }
+      return selector.size();
+   }
+
+   /**
+    * Can this complex selector match an element of the document?
+    * Only class, id and type selectors are checked; attribute selectors,
+    * pseudo-classes and functional arguments are assumed to match.
+    */
+   bool canMatch(std::string_view selector, const DocumentNames& names) {
+      bool compoundStart = true;
+      size_t pos = 0;
+
+      while (pos < selector.size()) {
+         const char ch = selector[pos];
+
+         if (ch == '|' || ch == '&') return true;
+
+         if (ch == ' ' || ch == '>' || ch == '+' || ch == '~') {
+            compoundStart = true;
+            ++pos;
+            continue;
+         }
+
+         if (ch == '[') {
+            pos = skipGroup(selector, pos, '[', ']');
+         } else if (ch == '(') {
+            pos = skipGroup(selector, pos, '(', ')');
+         } else if (ch == ':') {
+            while (pos < selector.size() && selector[pos] == ':') ++pos;
+            readIdent(selector, pos);
+            if (pos < selector.size() && selector[pos] == '(') pos = skipGroup(selector, pos, '(', ')');
+         } else if (ch == '.' || ch == '#') {
+            ++pos;
+            const std::string name = readIdent(selector, pos);
+            const auto& known = ch == '.' ? names.classes : names.ids;
+            if (!name.empty() && !known.contains(name) && !names.allowedByPrefix(name)) return false;
+         } else if (compoundStart && isIdentStart(ch)) {
+            const std::string tag = toLower(readIdent(selector, pos));
+            const bool implied = std::find(kImpliedTags.begin(), kImpliedTags.end(), tag) != kImpliedTags.end();
+            if (!tag.empty() && !implied && !names.tags.contains(tag)) return false;
+         } else {
+            ++pos;
+         }
+         compoundStart = false;
+      }
+      return true;
+   }
+
+   std::vector<std::string_view> splitSelectorList(std::string_view list) {
+      std::vector<std::string_view> selectors;
+      size_t start = 0;
+      size_t pos = 0;
+      while (pos < list.size()) {
+         const char ch = list[pos];
+         if (ch == '(') pos = skipGroup(list, pos, '(', ')');
+         else if (ch == '[') pos = skipGroup(list, pos, '[', ']');
+         else if (ch == '"' || ch == '\'') {
+            const size_t end = list.find(ch, pos + 1);
+            pos = end == std::string_view::npos ? list.size() : end + 1;
+         } else if (ch == ',') {
+            selectors.push_back(list.substr(start, pos - start));
+            start = ++pos;
+         } else {
+            ++pos;
+         }
+      }
+      selectors.push_back(list.substr(start));
+      return selectors;
+   }
+
+   bool pruneNodes(std::vector<CssNode>& nodes, const DocumentNames& names) {
+      bool changed = false;
+
+      for (CssNode& node : nodes) {
+         if (node.removed) continue;
+
+         if (node.kind == CssNode::Kind::Group) {
+            changed = pruneNodes(node.children, names) || changed;
+            continue;
+         }
+         if (node.kind != CssNode::Kind::Rule) continue;
+
+         const std::vector<std::string_view> selectors = splitSelectorList(node.prelude);
+         std::string kept;
+         size_t keptCount = 0;
+         for (const std::string_view selector : selectors) {
+            if (!canMatch(selector, names)) continue;
+            if (keptCount++ > 0) kept += ',';
+            kept.append(selector);
+         }
+
+         if (keptCount == selectors.size()) continue;
+         if (keptCount == 0) node.removed = true;
+         else node.prelude = kept;
+         changed = true;
+      }
+      return changed;
+   }
+
+} // namespace
+
+bool HtmlCompressor::pruneUnusedRules(std::string_view html, std::vector<StyleBlock>& blocks) {
+   DocumentNames names = collectNames(html);
+   if (settings.cssAllowlist) addAllowlist(*settings.cssAllowlist, names);
+
+   bool changed = false;
+   for (StyleBlock& block : blocks) {
+      changed = pruneNodes(block.nodes, names) || changed;
+   }
+   return changed;
+}
@@ -3,6 +3,7 @@
 #include <string>
 #include "commands/formatCommandLineArguments.hh"
 #include "compression/HtmlCompressor.h"
+#include "utils/trace.h"
 
 int main(int argc, char* argv[]) {
     std::map<std::string, std::string> arguments = formatCommandLineArguments(argc, argv);
@@ -34,12 +35,20 @@ int main(int argc, char* argv[]) {
 
     HtmlCompressor::currentLevel = static_cast<HtmlCompressor::Level>(std::stoi(arguments["level"]));
 
-    if (HtmlCompressor::currentLevel < HtmlCompressor::BASIC || HtmlCompressor::currentLevel > HtmlCompressor::EXTREME) {
-        std::cout << "Compressor level must be between 1 and 3." << std::endl;
+    if (HtmlCompressor::currentLevel < HtmlCompressor::WHITESPACE || HtmlCompressor::currentLevel > HtmlCompressor::EXTREME) {
+        std::cout << "Compressor level must be between 0 and 3." << std::endl;
         return 1;
     }
 
-    HtmlCompressor::compress(htmlContent);
+    // --- --trace out.json: Chrome trace_event timeline of this run ---
+    const bool tracing = arguments.contains("trace") && traceStart();
+
+    htmlContent = HtmlCompressor::compress(htmlContent);
+
+    if (tracing && !traceStop(arguments["trace"])) {
+        std::cerr << "Failed to write trace: " << arguments["trace"] << std::endl;
+    }
+
     std::cout << htmlContent << std::endl;
     return 0;
 }
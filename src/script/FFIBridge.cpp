@@ -1,8 +1,20 @@
-#include "../compression/HtmlCompressor.h"
+#include "../compression/BundleQueue.h"
+#include "../compression/Compressor.h"
+#include "../compression/Delta.h"
+#include "../compression/SharedCache.h"
+#include "../utils/bundlerModel.h"
+#include "../utils/hash.h"
+#include "../utils/nameMap.h"
+#include "../utils/trace.h"
 
+#include <cctype>
+#include <cstdint>
 #include <cstdlib>
 #include <cstring>
+#include <optional>
 #include <string>
+#include <utility>
+#include <vector>
 
 #if defined(_WIN32) || defined(_WIN64)
 #define PHPSPA_EXPORT __declspec(dllexport)
@@ -10,35 +22,156 @@
 #define PHPSPA_EXPORT __attribute__((visibility("default")))
 #endif
 
-extern "C" {
-   PHPSPA_EXPORT char* phpspa_compress_html(const char* input, int level, const char* type, size_t* out_len) {
-      if (!input || !out_len) return nullptr;
+namespace {
 
-      HtmlCompressor::currentLevel = static_cast<HtmlCompressor::Level>(level);
+   std::optional<phpspa::ContentType> parseType(const char* type) {
+      if (!type) return std::nullopt;
+      if (strcmp(type, "HTML") == 0) return phpspa::ContentType::HTML;
+      if (strcmp(type, "CSS") == 0) return phpspa::ContentType::CSS;
+      if (strcmp(type, "JS") == 0) return phpspa::ContentType::JS;
+      if (strcmp(type, "JSON") == 0) return phpspa::ContentType::JSON;
+      return std::nullopt;
+   }
 
-      // Reserve to avoid reallocs during compression
-      std::string result;
-      result.reserve(strlen(input));
+   std::string normalizeScope(const char* scope) {
+      return (scope == nullptr || scope[0] == '\0') ? "global" : std::string(scope);
+   }
 
-      try {
+   // --- One-shot compression; unknown types are returned unchanged ---
+   bool compressOnce(const char* input, int level, const char* type, const char* scope, bool useBundler, char* debugOutput, std::string& result) {
+      const std::optional<phpspa::ContentType> contentType = parseType(type);
+      if (!contentType) {
          result = input;
-         if (strcmp(type, "HTML") == 0) {
-            result = HtmlCompressor::compress(input);
-         } else {
-            std::string content{input};
-
-            if (strcmp(type, "CSS") == 0) {
-               HtmlCompressor::minifyCSS(content);
-            } else if (strcmp(type, "JS") == 0) {
-               HtmlCompressor::minifyJS(content);
-            }
-
-            result = content;
-         }
+         return true;
+      }
+
+      try {
+         phpspa::CompressorOptions options;
+         options.level = static_cast<HtmlCompressor::Level>(level);
+         options.type = *contentType;
+         options.scope = normalizeScope(scope);
+         // --- A page's inline scripts stay with the native minifier, as they always have here ---
+         options.useBundler = useBundler && *contentType != phpspa::ContentType::HTML;
+
+         // --- The one-shot entry points keep their original output; the newer passes are opt-in through handles ---
+         options.minifiedThreshold = 2.0;
+         options.omitOptionalTags = false;
+
+         phpspa::Compressor compressor(std::move(options));
+         compressor.compress(input, result, debugOutput);
       } catch (...) {
-         return nullptr;
+         return false;
+      }
+      return true;
+   }
+
+   // --- Options of a background bundle job; nullopt for an unknown type or level ---
+   std::optional<phpspa::CompressorOptions> bundleOptions(int level, const char* type, const char* scope) {
+      const std::optional<phpspa::ContentType> contentType = parseType(type);
+      if (!contentType || level < HtmlCompressor::WHITESPACE || level > HtmlCompressor::EXTREME) return std::nullopt;
+
+      phpspa::CompressorOptions options;
+      options.level = static_cast<HtmlCompressor::Level>(level);
+      options.type = *contentType;
+      options.scope = normalizeScope(scope);
+      options.useBundler = true;
+      return options;
+   }
+
+   int jobStateCode(phpspa::JobState state) {
+      switch (state) {
+         case phpspa::JobState::DONE: return 1;
+         case phpspa::JobState::PENDING: return 0;
+         case phpspa::JobState::UNKNOWN: return -1;
+      }
+      return -1;
+   }
+
+   // --- "1"/"true"/"on" and "0"/"false"/"off" ---
+   std::optional<bool> parseFlag(const char* value) {
+      if (strcmp(value, "1") == 0 || strcmp(value, "true") == 0 || strcmp(value, "on") == 0) return true;
+      if (strcmp(value, "0") == 0 || strcmp(value, "false") == 0 || strcmp(value, "off") == 0) return false;
+      return std::nullopt;
+   }
+
+   // --- Whitespace- or comma-separated list ---
+   std::vector<std::string> parseList(const char* value) {
+      std::vector<std::string> items;
+      std::string item;
+      for (const char* ch = value;; ++ch) {
+         if (*ch == '\0' || *ch == ',' || std::isspace(static_cast<unsigned char>(*ch))) {
+            if (!item.empty()) items.push_back(std::move(item));
+            item.clear();
+            if (*ch == '\0') break;
+            continue;
+         }
+         item += *ch;
       }
+      return items;
+   }
 
+   bool applyOption(phpspa::CompressorOptions& options, const char* name, const char* value) {
+      if (strcmp(name, "minified_threshold") == 0) {
+         char* end = nullptr;
+         const double threshold = strtod(value, &end);
+         if (end == value || *end != '\0' || threshold < 0.0) return false;
+         options.minifiedThreshold = threshold;
+      } else if (strcmp(name, "prune_unused_css") == 0) {
+         const std::optional<bool> enabled = parseFlag(value);
+         if (!enabled) return false;
+         options.pruneUnusedCSS = *enabled;
+      } else if (strcmp(name, "css_allowlist") == 0) {
+         options.cssAllowlist = parseList(value);
+      } else if (strcmp(name, "omit_optional_tags") == 0) {
+         const std::optional<bool> enabled = parseFlag(value);
+         if (!enabled) return false;
+         options.omitOptionalTags = *enabled;
+      } else if (strcmp(name, "svg_precision") == 0) {
+         char* end = nullptr;
+         const long precision = strtol(value, &end, 10);
+         if (end == value || *end != '\0' || precision > 10) return false;
+         options.svgPrecision = precision < 0 ? -1 : static_cast<int>(precision);
+      } else if (strcmp(name, "dedupe_inline_styles") == 0) {
+         const std::optional<bool> enabled = parseFlag(value);
+         if (!enabled) return false;
+         options.dedupeInlineStyles = *enabled;
+      } else if (strcmp(name, "dedupe_inline_scripts") == 0) {
+         const std::optional<bool> enabled = parseFlag(value);
+         if (!enabled) return false;
+         options.dedupeInlineScripts = *enabled;
+      } else if (strcmp(name, "mangle_names") == 0) {
+         const std::optional<bool> enabled = parseFlag(value);
+         if (!enabled) return false;
+         options.mangleNames = *enabled;
+      } else if (strcmp(name, "mangle_allowlist") == 0) {
+         options.mangleAllowlist = parseList(value);
+      } else if (strcmp(name, "canonical_attributes") == 0) {
+         const std::optional<bool> enabled = parseFlag(value);
+         if (!enabled) return false;
+         options.canonicalizeAttributes = *enabled;
+      } else if (strcmp(name, "bundler_min_bytes") == 0) {
+         char* end = nullptr;
+         const unsigned long long bytes = strtoull(value, &end, 10);
+         if (end == value || *end != '\0' || value[0] == '-') return false;
+         options.bundlerMinBytes = static_cast<size_t>(bytes);
+      } else if (strcmp(name, "fragment_cache") == 0) {
+         const std::optional<bool> enabled = parseFlag(value);
+         if (!enabled) return false;
+         options.memoizeFragments = *enabled;
+      } else if (strcmp(name, "fragment_markers") == 0) {
+         std::vector<std::string> markers = parseList(value);
+         if (markers.empty()) return false;
+         for (std::string& marker : markers) {
+            for (char& ch : marker) ch = static_cast<char>(std::tolower(static_cast<unsigned char>(ch)));
+         }
+         options.fragmentMarkers = std::move(markers);
+      } else {
+         return false;
+      }
+      return true;
+   }
+
+   char* copyResult(const std::string& result, size_t* out_len) {
       *out_len = result.size();
 
       // allocate once
@@ -50,51 +183,370 @@ extern "C" {
       return buffer;
    }
 
-   PHPSPA_EXPORT char* phpspa_compress_html_esbuild(const char* input, int level, const char* type, const char* scope, char* debugOutput, size_t* out_len) {
-      if (!input || !out_len) return nullptr;
+} // namespace
+
+// --- Counters and learned figures of the esbuild-or-native routing (utils/bundlerModel.h) ---
+struct phpspa_bundler_stats {
+   uint64_t bundled;
+   uint64_t native_small;
+   uint64_t native_low_savings;
+   uint64_t explored;
+   uint64_t spawns;
+   uint64_t spawn_failures;
+   int64_t saved_bytes;
+   int64_t spawn_ns;
+   int64_t native_ps_per_byte;
+   double savings_ratio;
+   uint64_t threshold_bytes;
+};
+
+// --- Long-lived compressor: output and scratch buffers stay warm between runs ---
+struct phpspa_compressor {
+   phpspa::Compressor compressor;
+   std::string output;
+   phpspa::CompressResult lastResult;
+};
 
-      HtmlCompressor::currentLevel = static_cast<HtmlCompressor::Level>(level);
+extern "C" {
+   PHPSPA_EXPORT char* phpspa_compress_html(const char* input, int level, const char* type, size_t* out_len) {
+      if (!input || !out_len) return nullptr;
 
       std::string result;
-      std::string scopeValue = (scope == nullptr || scope[0] == '\0') ? "global" : std::string(scope);
-      result.reserve(strlen(input));
+      if (!compressOnce(input, level, type, nullptr, false, nullptr, result)) return nullptr;
 
-      try {
-         result = input;
-         if (strcmp(type, "HTML") == 0) {
-            result = HtmlCompressor::compress(input);
-         } else {
-            std::string content{input};
-
-            if (strcmp(type, "CSS") == 0) {
-               HtmlCompressor::minifyCSS(content);
-            } else if (strcmp(type, "JS") == 0) {
-               HtmlCompressor::minifyJS(content, scopeValue, debugOutput);
-            }
-
-            result = content;
-         }
-      } catch (...) {
-         return nullptr;
-      }
+      return copyResult(result, out_len);
+   }
+
+   PHPSPA_EXPORT char* phpspa_compress_html_esbuild(const char* input, int level, const char* type, const char* scope, char* debugOutput, size_t* out_len) {
+      if (!input || !out_len) return nullptr;
+
+      std::string result;
+      if (!compressOnce(input, level, type, scope, true, debugOutput, result)) return nullptr;
 
-      *out_len = result.size();
       // if (debugOutput) {
-      //    std::string debugStr = "Compressing with native library at level " + std::to_string(level) + 
+      //    std::string debugStr = "Compressing with native library at level " + std::to_string(level) +
       //                          " for type " + std::string(type) + " and scope " + scopeValue;
       //    strncpy(debugOutput, debugStr.c_str(), 1023);
       //    debugOutput[1023] = '\0';
       // }
 
-      char* buffer = (char*) malloc(result.size() + 1);
-      if (!buffer) return nullptr;
-
-      memcpy(buffer, result.c_str(), result.size() + 1);
-
-      return buffer;
+      return copyResult(result, out_len);
    }
 
    PHPSPA_EXPORT void phpspa_free_string(char* buffer) {
       free(buffer);
    }
+
+   PHPSPA_EXPORT phpspa_compressor* phpspa_compressor_create(int level, const char* type, const char* scope, int use_esbuild) {
+      const std::optional<phpspa::ContentType> contentType = parseType(type);
+      if (!contentType || level < HtmlCompressor::WHITESPACE || level > HtmlCompressor::EXTREME) return nullptr;
+
+      phpspa::CompressorOptions options;
+      options.level = static_cast<HtmlCompressor::Level>(level);
+      options.type = *contentType;
+      options.scope = normalizeScope(scope);
+      options.useBundler = use_esbuild != 0;
+
+      try {
+         return new phpspa_compressor{
+            phpspa::Compressor(std::move(options)),
+            std::string(),
+            phpspa::CompressResult(),
+         };
+      } catch (...) {
+         return nullptr;
+      }
+   }
+
+   /**
+    * Compress with a long-lived handle.
+    *
+    * Returns a pointer into the handle's output buffer (NUL-terminated). It is
+    * borrowed: valid until the next run or destroy on the same handle, and must
+    * not be passed to phpspa_free_string. debugOutput (optional, 1024 bytes)
+    * receives bundler diagnostics for JS handles created with use_esbuild.
+    */
+   PHPSPA_EXPORT const char* phpspa_compressor_run(phpspa_compressor* handle, const char* input, size_t input_len, char* debugOutput, size_t* out_len) {
+      if (!handle || !input || !out_len) return nullptr;
+
+      try {
+         handle->lastResult = handle->compressor.compress(std::string_view(input, input_len), handle->output, debugOutput);
+      } catch (...) {
+         return nullptr;
+      }
+
+      *out_len = handle->output.size();
+      return handle->output.c_str();
+   }
+
+   /**
+    * Compress with a long-lived handle within a latency budget of budget_us
+    * microseconds. The handle's level is lowered to the most aggressive one
+    * the library's cost model (fed by the throughput of earlier runs)
+    * predicts to fit, and passes or esbuild runs that would overrun are
+    * skipped mid-call (result flag 4). phpspa_compressor_level reports the
+    * level used. The output is borrowed as with phpspa_compressor_run.
+    */
+   PHPSPA_EXPORT const char* phpspa_compressor_run_within(phpspa_compressor* handle, const char* input, size_t input_len, int64_t budget_us, char* debugOutput, size_t* out_len) {
+      if (!handle || !input || !out_len) return nullptr;
+
+      try {
+         handle->lastResult = handle->compressor.compressWithin(std::string_view(input, input_len), handle->output, budget_us, debugOutput);
+      } catch (...) {
+         return nullptr;
+      }
+
+      *out_len = handle->output.size();
+      return handle->output.c_str();
+   }
+
+   // --- Level (0-3) the last run on the handle compressed at ---
+   PHPSPA_EXPORT int phpspa_compressor_level(const phpspa_compressor* handle) {
+      return handle ? static_cast<int>(handle->lastResult.level) : -1;
+   }
+
+   /**
+    * Result flags of the last run on the handle (phpspa::ResultFlag bits,
+    * e.g. 1 = input was already minified and only trimmed).
+    */
+   PHPSPA_EXPORT uint32_t phpspa_compressor_flags(const phpspa_compressor* handle) {
+      return handle ? handle->lastResult.flags : 0;
+   }
+
+   // --- 64-bit hash of the last run's output (ETag / cache key material) ---
+   PHPSPA_EXPORT uint64_t phpspa_compressor_hash(const phpspa_compressor* handle) {
+      return handle ? handle->lastResult.hash : 0;
+   }
+
+   // --- The same 64-bit hash over any buffer, e.g. output served from a cache ---
+   PHPSPA_EXPORT uint64_t phpspa_hash(const char* data, size_t data_len) {
+      return data ? hash64(std::string_view(data, data_len)) : 0;
+   }
+
+   /**
+    * Adjust a tuning option on a handle. Returns 1 on success, 0 for an
+    * unknown option or invalid value.
+    *
+    *   minified_threshold  compactness (0-1) above which input is passed through; > 1 disables (the
+    *                       one-shot phpspa_compress_html* calls always disable it)
+    *   prune_unused_css    1/0: drop inline CSS rules that cannot match the document (full pages only)
+    *   css_allowlist       classes/ids added at runtime, e.g. "is-open #modal js-*"
+    *   omit_optional_tags  1/0: at EXTREME, drop end tags the parser implies (default 1)
+    *   svg_precision       0-10: at EXTREME, decimals kept in inline SVG paths; -1 keeps them exact (default 3)
+    *   dedupe_inline_styles  1/0: at AGGRESSIVE+, keep only one of byte-identical <style> blocks (default 0)
+    *   dedupe_inline_scripts 1/0: at AGGRESSIVE+, keep only the last of byte-identical inline scripts (default 0)
+    *   mangle_names        1/0: at EXTREME, rewrite class and id names to short ones in markup, CSS and JS (default 0)
+    *   mangle_allowlist    classes/ids kept as written, e.g. "js-* #app"; css_allowlist entries are kept too
+    *   canonical_attributes 1/0: at EXTREME, sort class tokens and attributes for better gzip/brotli matches (default 0)
+    *   bundler_min_bytes   scripts below this many bytes skip esbuild; 0 learns the threshold from spawn timings (default 0)
+    *   fragment_cache      1/0: reuse cached output for marked fragments (component subtrees) seen before
+    *   fragment_markers    attributes marking a fragment's root element (default "data-phpspa-target")
+    */
+   PHPSPA_EXPORT int phpspa_compressor_set_option(phpspa_compressor* handle, const char* name, const char* value) {
+      if (!handle || !name || !value) return 0;
+
+      try {
+         phpspa::CompressorOptions options = handle->compressor.options();
+         if (!applyOption(options, name, value)) return 0;
+         handle->compressor.setOptions(options);
+      } catch (...) {
+         return 0;
+      }
+      return 1;
+   }
+
+   PHPSPA_EXPORT void phpspa_compressor_destroy(phpspa_compressor* handle) {
+      delete handle;
+   }
+
+   /**
+    * Queue a bundler job and return at once. Returns a ticket for
+    * phpspa_bundle_poll/wait/take, or 0 for an invalid type or level.
+    */
+   PHPSPA_EXPORT uint64_t phpspa_bundle_submit(const char* input, size_t input_len, int level, const char* type, const char* scope) {
+      if (!input) return 0;
+
+      const std::optional<phpspa::CompressorOptions> options = bundleOptions(level, type, scope);
+      if (!options) return 0;
+
+      try {
+         return phpspa::BundleQueue::instance().submit(std::string(input, input_len), *options);
+      } catch (...) {
+         return 0;
+      }
+   }
+
+   // --- 1 = done, 0 = pending, -1 = unknown, already taken, or expired (results are kept 60 s) ---
+   PHPSPA_EXPORT int phpspa_bundle_poll(uint64_t ticket) {
+      return jobStateCode(phpspa::BundleQueue::instance().poll(ticket));
+   }
+
+   // --- Like phpspa_bundle_poll, after waiting up to timeout_ms for the job to finish ---
+   PHPSPA_EXPORT int phpspa_bundle_wait(uint64_t ticket, int timeout_ms) {
+      const std::chrono::milliseconds timeout(timeout_ms < 0 ? 0 : timeout_ms);
+      return jobStateCode(phpspa::BundleQueue::instance().wait(ticket, timeout));
+   }
+
+   /**
+    * Collect a finished job and release its ticket. Returns a buffer to free
+    * with phpspa_free_string, or NULL while the job is pending or unknown.
+    * flags and debugOutput (1024 bytes) are optional.
+    */
+   PHPSPA_EXPORT char* phpspa_bundle_take(uint64_t ticket, char* debugOutput, uint32_t* flags, size_t* out_len) {
+      if (!out_len) return nullptr;
+
+      phpspa::BundleResult result;
+      if (!phpspa::BundleQueue::instance().take(ticket, result)) return nullptr;
+
+      if (flags) *flags = result.result.flags;
+      if (debugOutput) {
+         strncpy(debugOutput, result.debug.c_str(), 1023);
+         debugOutput[1023] = '\0';
+      }
+      return copyResult(result.output, out_len);
+   }
+
+   /**
+    * Compress with the handle's options without waiting for the bundler:
+    * returns the cached bundled result, or the native minifier's output
+    * (flag PROVISIONAL) while the bundled result is built in the background
+    * for the next call. A budget_us of 0 or more bounds the native answer as
+    * phpspa_compressor_run_within does; negative means none. The output is
+    * borrowed as with phpspa_compressor_run, and the handle's level, flags
+    * and hash describe it.
+    */
+   PHPSPA_EXPORT const char* phpspa_bundle_optimistic(phpspa_compressor* handle, const char* input, size_t input_len, int64_t budget_us, size_t* out_len) {
+      if (!handle || !input || !out_len) return nullptr;
+
+      try {
+         handle->lastResult = phpspa::BundleQueue::instance().compressOptimistic(std::string_view(input, input_len), handle->output, handle->compressor.options(), budget_us);
+      } catch (...) {
+         return nullptr;
+      }
+
+      *out_len = handle->output.size();
+      return handle->output.c_str();
+   }
+
+   /**
+    * Patch that turns base (e.g. the previously sent output) into target
+    * (see phpspa::encodeDelta for the format). Returns a buffer to free with
+    * phpspa_free_string.
+    */
+   PHPSPA_EXPORT char* phpspa_delta_encode(const char* base, size_t base_len, const char* target, size_t target_len, size_t* out_len) {
+      if (!base || !target || !out_len) return nullptr;
+
+      std::string patch;
+      try {
+         phpspa::encodeDelta(std::string_view(base, base_len), std::string_view(target, target_len), patch);
+      } catch (...) {
+         return nullptr;
+      }
+      return copyResult(patch, out_len);
+   }
+
+   /**
+    * Rebuild the target from base and a patch. Returns a buffer to free with
+    * phpspa_free_string, or NULL when the patch is malformed or was made for
+    * a different base.
+    */
+   PHPSPA_EXPORT char* phpspa_delta_apply(const char* base, size_t base_len, const char* patch, size_t patch_len, size_t* out_len) {
+      if (!base || !patch || !out_len) return nullptr;
+
+      std::string result;
+      try {
+         if (!phpspa::applyDelta(std::string_view(base, base_len), std::string_view(patch, patch_len), result)) return nullptr;
+      } catch (...) {
+         return nullptr;
+      }
+      return copyResult(result, out_len);
+   }
+
+   /**
+    * Record a timeline of the compressor's work (passes, script/style
+    * blocks, bundler runs, cache lookups) from every thread until
+    * phpspa_trace_stop. Returns 0 when a trace is already recording.
+    */
+   PHPSPA_EXPORT int phpspa_trace_start() {
+      return traceStart() ? 1 : 0;
+   }
+
+   // --- Stop recording and write Chrome trace_event JSON to path; 0 when nothing was recording or the file cannot be written ---
+   PHPSPA_EXPORT int phpspa_trace_stop(const char* path) {
+      if (!path) return 0;
+
+      try {
+         return traceStop(path) ? 1 : 0;
+      } catch (...) {
+         return 0;
+      }
+   }
+
+   /**
+    * Share compressed outputs with every process that opens the same file
+    * (e.g. /dev/shm/phpspa-cache), creating it with heap_bytes of values if
+    * needed. Once per process; returns 1 when the cache is mapped (or was
+    * already mapped from path), 0 otherwise (unsupported platform,
+    * unwritable path, or a file made by an incompatible build).
+    */
+   PHPSPA_EXPORT int phpspa_shared_cache_open(const char* path, size_t heap_bytes) {
+      if (!path || path[0] == '\0') return 0;
+
+      try {
+         return phpspa::SharedCache::instance().open(path, heap_bytes) ? 1 : 0;
+      } catch (...) {
+         return 0;
+      }
+   }
+
+   /**
+    * How scripts were routed between esbuild and the native minifier in this
+    * process: decision counts, spawns, bytes esbuild saved over the native
+    * minifier, and the learned spawn latency, native rate, savings ratio and
+    * size threshold.
+    */
+   PHPSPA_EXPORT void phpspa_bundler_stats(phpspa_bundler_stats* out) {
+      if (!out) return;
+
+      const BundlerStats stats = bundlerStats();
+      out->bundled = stats.bundled;
+      out->native_small = stats.nativeSmall;
+      out->native_low_savings = stats.nativeLowSavings;
+      out->explored = stats.explored;
+      out->spawns = stats.spawns;
+      out->spawn_failures = stats.spawnFailures;
+      out->saved_bytes = stats.savedBytes;
+      out->spawn_ns = stats.spawnNanos;
+      out->native_ps_per_byte = stats.nativePicosPerByte;
+      out->savings_ratio = stats.savingsRatio;
+      out->threshold_bytes = stats.thresholdBytes;
+   }
+
+   /**
+    * Replace the class/id name map with the JSON file at path (as written by
+    * phpspa_names_export) and freeze it, so every process loading it
+    * mangles alike. Without it each process assigns names in the order it
+    * meets them, so output of different processes does not match. Returns 0
+    * when the file is unreadable or malformed.
+    */
+   PHPSPA_EXPORT int phpspa_names_load(const char* path) {
+      if (!path) return 0;
+
+      try {
+         return loadNameMap(path) ? 1 : 0;
+      } catch (...) {
+         return 0;
+      }
+   }
+
+   // --- Write the class/id name map as JSON; 0 when the file cannot be written ---
+   PHPSPA_EXPORT int phpspa_names_export(const char* path) {
+      if (!path) return 0;
+
+      try {
+         return exportNameMap(path) ? 1 : 0;
+      } catch (...) {
+         return 0;
+      }
+   }
 }
@@ -0,0 +1,60 @@
+#include <cstddef>
+#include <cstdint>
+#pragma once
+
+/**
+ * Whether esbuild is worth its process spawn over the native JS minifier.
+ *
+ * A source goes to esbuild only when both hold:
+ * - it is at least the size threshold: configured, or learned as the size
+ *   where the measured spawn latency is at most kSpawnToNativeLimit times
+ *   the measured native minification time;
+ * - esbuild's expected extra savings over the native minifier (a learned
+ *   share of the input) reach kMinSavedBytes.
+ *
+ * Every figure is an exponentially weighted average of this process's
+ * runs, starting from priors measured on the bench corpus. The savings
+ * figure needs a native run next to esbuild's, so it is sampled: the first
+ * kColdSavingsSamples esbuild runs, then one in kSavingsSampleEvery. Counters and the
+ * learned figures are readable through bundlerStats().
+ */
+
+enum class BundlerRoute {
+   Bundler,
+   NativeSmall,     // --- below the size threshold ---
+   NativeLowSavings // --- expected savings over the native minifier negligible ---
+};
+
+struct BundlerStats {
+   uint64_t bundled = 0;          // --- decisions for esbuild ---
+   uint64_t nativeSmall = 0;      // --- decisions for the native minifier: too small ---
+   uint64_t nativeLowSavings = 0; // --- decisions for the native minifier: savings negligible ---
+   uint64_t explored = 0;         // --- low-savings sources sent to esbuild anyway, to keep the savings figure current ---
+   uint64_t spawns = 0;
+   uint64_t spawnFailures = 0;
+   int64_t savedBytes = 0;        // --- esbuild output bytes saved over the native minifier, summed over the sampled runs ---
+   int64_t spawnNanos = 0;
+   int64_t nativePicosPerByte = 0;
+   double savingsRatio = 0.0;     // --- saved bytes per input byte ---
+   uint64_t thresholdBytes = 0;   // --- learned size threshold ---
+};
+
+// --- Where sources totalling bytes are minified; minBytes is the configured size threshold (0 = learned) ---
+BundlerRoute routeBundler(size_t bytes, size_t minBytes);
+
+// --- A native minification of bytes took nanos ---
+void recordNativeRun(size_t bytes, int64_t nanos);
+
+// --- An esbuild process ran for nanos ---
+void recordBundlerSpawn(int64_t nanos, bool succeeded);
+
+// --- Whether this esbuild run should also be minified natively to feed recordBundlerSavings ---
+bool sampleBundlerSavings();
+
+// --- esbuild's output size against the native minifier's, for the same inputBytes ---
+void recordBundlerSavings(size_t inputBytes, size_t nativeBytes, size_t bundledBytes);
+
+// --- Learned esbuild spawn latency in nanoseconds ---
+int64_t bundlerSpawnNanos();
+
+BundlerStats bundlerStats();
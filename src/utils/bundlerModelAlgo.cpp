@@ -0,0 +1,118 @@
+#include <algorithm>
+#include <atomic>
+#include "bundlerModel.h"
+
+namespace {
+
+   // --- esbuild is worth at most this many native runs of the same source ---
+   constexpr int64_t kSpawnToNativeLimit = 1000;
+
+   // --- Expected savings below this are not worth a process ---
+   constexpr int64_t kMinSavedBytes = 128;
+
+   // --- Every this many low-savings decisions, one goes to esbuild so a low figure can recover ---
+   constexpr uint64_t kExploreEvery = 32;
+
+   // --- esbuild runs compared with the native minifier while the savings figure is still the prior, then one in this many ---
+   constexpr uint64_t kColdSavingsSamples = 8;
+   constexpr uint64_t kSavingsSampleEvery = 16;
+
+   // --- Below this, per-call overhead drowns the native rate ---
+   constexpr size_t kMinObservedBytes = 512;
+
+   // --- Weight of a new sample: 1/8 ---
+   constexpr int kSmoothingShift = 3;
+
+   // --- Priors: a cold esbuild process, the native minifier's rate (Release build), and
+   //     esbuild's identifier mangling on the bench corpus's app.js ---
+   std::atomic<int64_t> spawnNanos{ 30'000'000 };
+   std::atomic<int64_t> nativePicosPerByte{ 25'000 };
+   std::atomic<int64_t> savingsPpm{ 150'000 };
+
+   std::atomic<uint64_t> bundled{ 0 };
+   std::atomic<uint64_t> nativeSmall{ 0 };
+   std::atomic<uint64_t> nativeLowSavings{ 0 };
+   std::atomic<uint64_t> explored{ 0 };
+   std::atomic<uint64_t> spawns{ 0 };
+   std::atomic<uint64_t> spawnFailures{ 0 };
+   std::atomic<int64_t> savedBytes{ 0 };
+   std::atomic<uint64_t> savingsRuns{ 0 };
+
+   // --- Concurrent updates may drop a sample, never corrupt one ---
+   void smooth(std::atomic<int64_t>& average, int64_t sample) {
+      const int64_t current = average.load(std::memory_order_relaxed);
+      average.store(current + ((sample - current) >> kSmoothingShift), std::memory_order_relaxed);
+   }
+
+   // --- spawn <= kSpawnToNativeLimit * bytes * picosPerByte / 1000 ---
+   uint64_t learnedThreshold() {
+      const int64_t picos = std::max<int64_t>(nativePicosPerByte.load(std::memory_order_relaxed), 1);
+      return static_cast<uint64_t>(spawnNanos.load(std::memory_order_relaxed) * 1000 / (kSpawnToNativeLimit * picos));
+   }
+
+} // namespace
+
+BundlerRoute routeBundler(size_t bytes, size_t minBytes) {
+   const uint64_t threshold = minBytes != 0 ? minBytes : learnedThreshold();
+   if (bytes < threshold) {
+      nativeSmall.fetch_add(1, std::memory_order_relaxed);
+      return BundlerRoute::NativeSmall;
+   }
+
+   const int64_t expectedSavings = static_cast<int64_t>(bytes) * savingsPpm.load(std::memory_order_relaxed) / 1'000'000;
+   if (expectedSavings < kMinSavedBytes) {
+      if (nativeLowSavings.fetch_add(1, std::memory_order_relaxed) % kExploreEvery != kExploreEvery - 1) return BundlerRoute::NativeLowSavings;
+      explored.fetch_add(1, std::memory_order_relaxed);
+   }
+
+   bundled.fetch_add(1, std::memory_order_relaxed);
+   return BundlerRoute::Bundler;
+}
+
+void recordNativeRun(size_t bytes, int64_t nanos) {
+   if (bytes < kMinObservedBytes) return;
+   smooth(nativePicosPerByte, std::max<int64_t>(nanos, 0) * 1000 / static_cast<int64_t>(bytes));
+}
+
+void recordBundlerSpawn(int64_t nanos, bool succeeded) {
+   spawns.fetch_add(1, std::memory_order_relaxed);
+   // --- A failed spawn says little about the next one: it may be a missing binary or a timeout ---
+   if (!succeeded) {
+      spawnFailures.fetch_add(1, std::memory_order_relaxed);
+      return;
+   }
+   smooth(spawnNanos, std::max<int64_t>(nanos, 0));
+}
+
+bool sampleBundlerSavings() {
+   const uint64_t run = savingsRuns.fetch_add(1, std::memory_order_relaxed);
+   return run < kColdSavingsSamples || run % kSavingsSampleEvery == 0;
+}
+
+void recordBundlerSavings(size_t inputBytes, size_t nativeBytes, size_t bundledBytes) {
+   if (inputBytes == 0) return;
+
+   const int64_t saved = static_cast<int64_t>(nativeBytes) - static_cast<int64_t>(bundledBytes);
+   savedBytes.fetch_add(saved, std::memory_order_relaxed);
+   smooth(savingsPpm, std::max<int64_t>(saved, 0) * 1'000'000 / static_cast<int64_t>(inputBytes));
+}
+
+int64_t bundlerSpawnNanos() {
+   return spawnNanos.load(std::memory_order_relaxed);
+}
+
+BundlerStats bundlerStats() {
+   BundlerStats stats;
+   stats.bundled = bundled.load(std::memory_order_relaxed);
+   stats.nativeSmall = nativeSmall.load(std::memory_order_relaxed);
+   stats.nativeLowSavings = nativeLowSavings.load(std::memory_order_relaxed) - explored.load(std::memory_order_relaxed);
+   stats.explored = explored.load(std::memory_order_relaxed);
+   stats.spawns = spawns.load(std::memory_order_relaxed);
+   stats.spawnFailures = spawnFailures.load(std::memory_order_relaxed);
+   stats.savedBytes = savedBytes.load(std::memory_order_relaxed);
+   stats.spawnNanos = spawnNanos.load(std::memory_order_relaxed);
+   stats.nativePicosPerByte = nativePicosPerByte.load(std::memory_order_relaxed);
+   stats.savingsRatio = static_cast<double>(savingsPpm.load(std::memory_order_relaxed)) / 1'000'000.0;
+   stats.thresholdBytes = learnedThreshold();
+   return stats;
+}
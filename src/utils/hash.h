@@ -0,0 +1,10 @@
+#include <cstdint>
+#include <string_view>
+#pragma once
+
+/**
+ * Fast non-cryptographic 64-bit hash (wyhash construction, xxh3 class) for
+ * ETags and cache keys. Stable across runs and processes on little-endian
+ * hosts; not suitable where an attacker picks inputs to collide.
+ */
+uint64_t hash64(std::string_view data, uint64_t seed = 0);
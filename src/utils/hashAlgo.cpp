@@ -0,0 +1,97 @@
+#include <cstring>
+#include "hash.h"
+
+#if defined(_MSC_VER) && defined(_M_X64)
+#include <intrin.h>
+#pragma intrinsic(_umul128)
+#endif
+
+namespace {
+
+   constexpr uint64_t kSecret[4] = { 0x2d358dccaa6c78a5ull, 0x8bb84b93962eacc9ull, 0x4b33a62ed433d4a3ull, 0x4d5a2da51de1aa47ull };
+
+   // --- 64x64 -> 128-bit multiply: low half into a, high half into b ---
+   inline void multiply(uint64_t& a, uint64_t& b) {
+#if defined(__SIZEOF_INT128__)
+      const __uint128_t product = static_cast<__uint128_t>(a) * b;
+      a = static_cast<uint64_t>(product);
+      b = static_cast<uint64_t>(product >> 64);
+#elif defined(_MSC_VER) && defined(_M_X64)
+      a = _umul128(a, b, &b);
+#else
+      const uint64_t aHigh = a >> 32, aLow = static_cast<uint32_t>(a);
+      const uint64_t bHigh = b >> 32, bLow = static_cast<uint32_t>(b);
+      const uint64_t high = aHigh * bHigh, middle1 = aHigh * bLow, middle2 = aLow * bHigh, low = aLow * bLow;
+      const uint64_t cross = (low >> 32) + static_cast<uint32_t>(middle1) + static_cast<uint32_t>(middle2);
+      a = (cross << 32) | static_cast<uint32_t>(low);
+      b = high + (middle1 >> 32) + (middle2 >> 32) + (cross >> 32);
+#endif
+   }
+
+   inline uint64_t mix(uint64_t a, uint64_t b) {
+      multiply(a, b);
+      return a ^ b;
+   }
+
+   inline uint64_t read64(const unsigned char* p) {
+      uint64_t value;
+      std::memcpy(&value, p, sizeof(value));
+      return value;
+   }
+
+   inline uint64_t read32(const unsigned char* p) {
+      uint32_t value;
+      std::memcpy(&value, p, sizeof(value));
+      return value;
+   }
+
+} // namespace
+
+uint64_t hash64(std::string_view data, uint64_t seed) {
+   const unsigned char* p = reinterpret_cast<const unsigned char*>(data.data());
+   const size_t length = data.size();
+   seed ^= mix(seed ^ kSecret[0], kSecret[1]);
+
+   uint64_t a = 0;
+   uint64_t b = 0;
+   if (length <= 16) {
+      if (length >= 4) {
+         const size_t offset = (length >> 3) << 2;
+         a = (read32(p) << 32) | read32(p + offset);
+         b = (read32(p + length - 4) << 32) | read32(p + length - 4 - offset);
+      } else if (length > 0) {
+         a = (static_cast<uint64_t>(p[0]) << 16) | (static_cast<uint64_t>(p[length >> 1]) << 8) | p[length - 1];
+      }
+   } else {
+      size_t remaining = length;
+
+      // --- Three independent lanes per 48-byte stripe keep the multipliers busy ---
+      if (remaining >= 48) {
+         uint64_t lane1 = seed;
+         uint64_t lane2 = seed;
+         do {
+            seed = mix(read64(p) ^ kSecret[1], read64(p + 8) ^ seed);
+            lane1 = mix(read64(p + 16) ^ kSecret[2], read64(p + 24) ^ lane1);
+            lane2 = mix(read64(p + 32) ^ kSecret[3], read64(p + 40) ^ lane2);
+            p += 48;
+            remaining -= 48;
+         } while (remaining >= 48);
+         seed ^= lane1 ^ lane2;
+      }
+
+      while (remaining > 16) {
+         seed = mix(read64(p) ^ kSecret[1], read64(p + 8) ^ seed);
+         p += 16;
+         remaining -= 16;
+      }
+
+      // --- The last 16 bytes, overlapping the previous block when the tail is short ---
+      a = read64(p + remaining - 16);
+      b = read64(p + remaining - 8);
+   }
+
+   a ^= kSecret[1];
+   b ^= seed;
+   multiply(a, b);
+   return mix(a ^ kSecret[0] ^ length, b ^ kSecret[1]);
+}
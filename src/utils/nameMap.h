@@ -0,0 +1,45 @@
+#include <cstdint>
+#include <string>
+#include <string_view>
+#pragma once
+
+/**
+ * Process-wide map from class and id names to short generated ones, so a
+ * name is rewritten the same way in every page, stylesheet and script the
+ * process compresses.
+ *
+ * Names are assigned on first sight ("a".."z", then "a0".."z9", ...:
+ * lowercase letters and digits only, so they match in quirks mode too and
+ * never need escaping); a name already that short keeps itself while no
+ * other name took it. Names kept as written (allowlisted) are never
+ * generated, and a generated name that one of them turns out to spell is
+ * moved to another name.
+ *
+ * First-sight order differs between processes: without a loaded map, two
+ * workers rewrite the same name differently, so a page and a stylesheet
+ * compressed by different workers disagree. Loading a map file freezes
+ * the map: every process loading the same file rewrites the same way.
+ * Names missing from a frozen map, or arriving after kMaxNames per kind,
+ * are kept as written; one spelled like a generated name becomes "_" and
+ * a hash of it instead. Safe to use from any thread.
+ */
+
+enum class NameKind : uint8_t { Class, Id };
+
+// --- Short name for name, assigned on first sight; false when it stays as written (frozen map or full table) ---
+bool shortNameFor(NameKind kind, std::string_view name, std::string& out);
+
+// --- A name kept as written: no short name is generated equal to it, and one already generated moves ---
+void keepName(NameKind kind, std::string_view name);
+
+// --- Names starting with prefix are kept as written: as keepName, for every generated name with that prefix ---
+void keepPrefix(NameKind kind, std::string_view prefix);
+
+// --- Replace the map with the JSON in path and freeze it; false (map unchanged) when unreadable or malformed ---
+bool loadNameMap(const std::string& path);
+
+// --- Write the map as JSON: {"classes":{"original":"short",...},"ids":{...}}; false when the file cannot be written ---
+bool exportNameMap(const std::string& path);
+
+// --- 0 while names are assigned on first sight; otherwise a hash of the loaded map ---
+uint64_t nameMapFingerprint();
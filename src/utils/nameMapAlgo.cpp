@@ -0,0 +1,341 @@
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "hash.h"
+#include "nameMap.h"
+
+namespace {
+
+   struct NameTable {
+      std::unordered_map<std::string, std::string> shortNames;
+      std::unordered_map<std::string, std::string> owners; // --- names in the output: generated (-> original), or kept as written (-> "") ---
+      std::vector<std::string> keptPrefixes;
+      uint64_t nextIndex = 0;
+   };
+
+   // --- Past this many names per kind new ones are no longer assigned, so a long-lived worker's map stays bounded ---
+   constexpr size_t kMaxNames = 1 << 16;
+
+   // --- Length of the hashed names given to names that cannot stay as written ---
+   constexpr size_t kHashedNameLength = 8;
+
+   // --- Already as short as a generated name: mapped to itself while no other name took it ---
+   bool keepsItself(std::string_view name) {
+      if (name.empty() || name.size() > 2 || name[0] < 'a' || name[0] > 'z') return false;
+      return name.size() == 1 || (name[1] >= 'a' && name[1] <= 'z') || (name[1] >= '0' && name[1] <= '9');
+   }
+
+   std::shared_mutex mutex;
+   NameTable tables[2];
+   std::atomic<uint64_t> fingerprint{ 0 };
+
+   NameTable& tableOf(NameKind kind) {
+      return tables[static_cast<size_t>(kind)];
+   }
+
+   // --- index-th name of "a".."z", "a0".."z9", "a00".. ---
+   std::string generatedName(uint64_t index) {
+      constexpr char kDigits[] = "0123456789abcdefghijklmnopqrstuvwxyz";
+      uint64_t count = 26;
+      size_t length = 1;
+      while (index >= count) {
+         index -= count;
+         count *= 36;
+         ++length;
+      }
+
+      std::string name(length, 'a');
+      name[0] = static_cast<char>('a' + index % 26);
+      index /= 26;
+      for (size_t i = 1; i < length; ++i) {
+         name[i] = kDigits[index % 36];
+         index /= 36;
+      }
+      return name;
+   }
+
+   bool keptByPrefix(const NameTable& table, std::string_view name) {
+      return std::any_of(table.keptPrefixes.begin(), table.keptPrefixes.end(), [&](const std::string& prefix) { return name.compare(0, prefix.size(), prefix) == 0; });
+   }
+
+   // --- Caller holds the unique lock ---
+   void assign(NameTable& table, const std::string& original) {
+      std::string generated;
+      if (keepsItself(original) && table.owners.count(original) == 0 && !keptByPrefix(table, original)) {
+         generated = original;
+      } else {
+         do {
+            generated = generatedName(table.nextIndex++);
+         } while (table.owners.count(generated) != 0 || keptByPrefix(table, generated));
+      }
+      table.owners[generated] = original;
+      table.shortNames[original] = std::move(generated);
+   }
+
+   // --- A name that must now be written as is no longer stands for original: reassigned, or (frozen map) kept as written ---
+   void release(NameTable& table, const std::string& original) {
+      if (fingerprint.load(std::memory_order_relaxed) != 0) {
+         table.shortNames.erase(original);
+      } else {
+         assign(table, original);
+      }
+   }
+
+   /**
+    * A name left unassigned (missing from a frozen map, or past kMaxNames)
+    * stays as written unless that spelling already stands for another name;
+    * then it gets "_" and a hash of it, which every process derives alike
+    * and generated names (no "_") never equal.
+    */
+   bool unassignedName(const NameTable& table, const std::string& name, std::string& out) {
+      const auto owner = table.owners.find(name);
+      if (owner == table.owners.end() || owner->second.empty()) return false;
+
+      constexpr char kDigits[] = "0123456789abcdefghijklmnopqrstuvwxyz";
+      uint64_t hash = hash64(name);
+      out.assign(1, '_');
+      for (size_t i = 0; i < kHashedNameLength; ++i) {
+         out += kDigits[hash % 36];
+         hash /= 36;
+      }
+      return true;
+   }
+
+   // --- Minimal reader for the exported format: objects of strings, \uXXXX limited to one code unit ---
+   class MapReader {
+      public:
+         explicit MapReader(std::string_view text) : text(text) {}
+
+         bool read(NameTable (&result)[2]) {
+            if (!consume('{')) return false;
+            if (consume('}')) return atEnd();
+            do {
+               std::string section;
+               if (!readString(section) || !consume(':')) return false;
+               if (section == "classes") {
+                  if (!readNames(result[static_cast<size_t>(NameKind::Class)])) return false;
+               } else if (section == "ids") {
+                  if (!readNames(result[static_cast<size_t>(NameKind::Id)])) return false;
+               } else {
+                  return false;
+               }
+            } while (consume(','));
+            return consume('}') && atEnd();
+         }
+
+      private:
+         bool readNames(NameTable& table) {
+            if (!consume('{')) return false;
+            if (consume('}')) return true;
+            do {
+               std::string original;
+               std::string generated;
+               if (!readString(original) || !consume(':') || !readString(generated) || original.empty() || generated.empty()) return false;
+               table.owners[generated] = original;
+               table.shortNames[std::move(original)] = std::move(generated);
+            } while (consume(','));
+            return consume('}');
+         }
+
+         bool readString(std::string& out) {
+            if (!consume('"')) return false;
+            while (pos < text.size()) {
+               const char ch = text[pos++];
+               if (ch == '"') return true;
+               if (ch != '\\') {
+                  out += ch;
+                  continue;
+               }
+               if (pos >= text.size()) return false;
+               const char escaped = text[pos++];
+               switch (escaped) {
+                  case '"': case '\\': case '/': out += escaped; break;
+                  case 'u': {
+                     if (pos + 4 > text.size()) return false;
+                     unsigned code = 0;
+                     for (size_t i = 0; i < 4; ++i) {
+                        const char digit = text[pos++];
+                        code <<= 4;
+                        if (digit >= '0' && digit <= '9') code |= static_cast<unsigned>(digit - '0');
+                        else if (digit >= 'a' && digit <= 'f') code |= static_cast<unsigned>(digit - 'a' + 10);
+                        else if (digit >= 'A' && digit <= 'F') code |= static_cast<unsigned>(digit - 'A' + 10);
+                        else return false;
+                     }
+                     if (code >= 0x80) return false; // --- the exporter writes non-ASCII as UTF-8 ---
+                     out += static_cast<char>(code);
+                     break;
+                  }
+                  default: return false;
+               }
+            }
+            return false;
+         }
+
+         void skipSpace() {
+            while (pos < text.size() && (text[pos] == ' ' || text[pos] == '\n' || text[pos] == '\r' || text[pos] == '\t')) ++pos;
+         }
+
+         bool consume(char ch) {
+            skipSpace();
+            if (pos >= text.size() || text[pos] != ch) return false;
+            ++pos;
+            return true;
+         }
+
+         bool atEnd() {
+            skipSpace();
+            return pos == text.size();
+         }
+
+         std::string_view text;
+         size_t pos = 0;
+   };
+
+   void writeString(std::string& out, std::string_view value) {
+      out += '"';
+      for (const char ch : value) {
+         if (ch == '"' || ch == '\\') {
+            out += '\\';
+            out += ch;
+         } else if (static_cast<unsigned char>(ch) < 0x20) {
+            char escaped[8];
+            std::snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned>(ch));
+            out += escaped;
+         } else {
+            out += ch;
+         }
+      }
+      out += '"';
+   }
+
+   void writeNames(std::string& out, const NameTable& table) {
+      // --- Sorted, so the same map always exports the same bytes ---
+      std::vector<std::pair<std::string_view, std::string_view>> names(table.shortNames.begin(), table.shortNames.end());
+      std::sort(names.begin(), names.end());
+
+      out += '{';
+      for (size_t i = 0; i < names.size(); ++i) {
+         out += i == 0 ? "\n    " : ",\n    ";
+         writeString(out, names[i].first);
+         out += ": ";
+         writeString(out, names[i].second);
+      }
+      out += names.empty() ? "}" : "\n  }";
+   }
+
+} // namespace
+
+bool shortNameFor(NameKind kind, std::string_view name, std::string& out) {
+   thread_local std::string key;
+   key.assign(name.data(), name.size());
+   NameTable& table = tableOf(kind);
+
+   {
+      std::shared_lock<std::shared_mutex> lock(mutex);
+      const auto found = table.shortNames.find(key);
+      if (found != table.shortNames.end()) {
+         out = found->second;
+         return true;
+      }
+      if (fingerprint.load(std::memory_order_relaxed) != 0 || table.shortNames.size() >= kMaxNames) return unassignedName(table, key, out);
+   }
+
+   std::unique_lock<std::shared_mutex> lock(mutex);
+   if (fingerprint.load(std::memory_order_relaxed) != 0 || table.shortNames.size() >= kMaxNames) return unassignedName(table, key, out);
+
+   // --- Another thread may have assigned it between the locks ---
+   if (table.shortNames.count(key) == 0) assign(table, key);
+   out = table.shortNames[key];
+   return true;
+}
+
+void keepName(NameKind kind, std::string_view name) {
+   thread_local std::string key;
+   key.assign(name.data(), name.size());
+   NameTable& table = tableOf(kind);
+
+   {
+      std::shared_lock<std::shared_mutex> lock(mutex);
+      const auto owner = table.owners.find(key);
+      if (owner != table.owners.end() && owner->second.empty()) return;
+   }
+
+   std::unique_lock<std::shared_mutex> lock(mutex);
+   std::string& owner = table.owners[key];
+   if (owner.empty()) return;
+
+   // --- Generated for another name: that one moves, the spelling is the kept name's from now on ---
+   const std::string original = std::move(owner);
+   owner.clear();
+   release(table, original);
+}
+
+void keepPrefix(NameKind kind, std::string_view prefix) {
+   if (prefix.empty()) return;
+   NameTable& table = tableOf(kind);
+
+   {
+      std::shared_lock<std::shared_mutex> lock(mutex);
+      if (std::find(table.keptPrefixes.begin(), table.keptPrefixes.end(), prefix) != table.keptPrefixes.end()) return;
+   }
+
+   std::unique_lock<std::shared_mutex> lock(mutex);
+   if (std::find(table.keptPrefixes.begin(), table.keptPrefixes.end(), prefix) != table.keptPrefixes.end()) return;
+   table.keptPrefixes.emplace_back(prefix);
+
+   std::vector<std::string> moved;
+   for (auto it = table.owners.begin(); it != table.owners.end();) {
+      if (!it->second.empty() && it->first.compare(0, prefix.size(), prefix) == 0) {
+         moved.push_back(std::move(it->second));
+         it = table.owners.erase(it);
+      } else {
+         ++it;
+      }
+   }
+   for (const std::string& original : moved) release(table, original);
+}
+
+bool loadNameMap(const std::string& path) {
+   std::ifstream in(path, std::ios::binary);
+   if (!in.is_open()) return false;
+   const std::string text((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+   if (in.bad()) return false;
+
+   NameTable loaded[2];
+   if (!MapReader(text).read(loaded)) return false;
+
+   // --- Names and prefixes kept as written are reserved again by the next call that mangles ---
+   std::unique_lock<std::shared_mutex> lock(mutex);
+   tables[0] = std::move(loaded[0]);
+   tables[1] = std::move(loaded[1]);
+   fingerprint.store(std::max<uint64_t>(hash64(text), 1), std::memory_order_relaxed);
+   return true;
+}
+
+bool exportNameMap(const std::string& path) {
+   std::string json = "{\n  \"classes\": ";
+   {
+      std::shared_lock<std::shared_mutex> lock(mutex);
+      writeNames(json, tableOf(NameKind::Class));
+      json += ",\n  \"ids\": ";
+      writeNames(json, tableOf(NameKind::Id));
+   }
+   json += "\n}\n";
+
+   std::ofstream out(path, std::ios::binary | std::ios::trunc);
+   if (!out.is_open()) return false;
+   out << json;
+   out.close();
+   return !out.fail();
+}
+
+uint64_t nameMapFingerprint() {
+   return fingerprint.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,22 @@
+#include <string>
+#include <string_view>
+#pragma once
+
+// --- Compact SVG geometry syntax. Each returns false (out unspecified) when the input does not parse ---
+
+// --- A plain number without redundant signs, zeros or decimal point ("+02.500" -> "2.5", "0.5" -> ".5") ---
+bool compactNumber(std::string_view number, std::string& out);
+
+/**
+ * Path data (the d attribute) with the fewest separators and command letters.
+ * With precision >= 0, coordinates are rounded to that many decimals and each
+ * segment uses the absolute or relative form, whichever is shorter; a negative
+ * precision keeps every value and command exactly as written.
+ */
+bool compactPathData(std::string_view data, int precision, std::string& out);
+
+// --- Coordinate pairs of a points attribute, rounded like path data ---
+bool compactPointList(std::string_view list, int precision, std::string& out);
+
+// --- Whitespace/comma separated numbers (viewBox, ...), values kept exact ---
+bool compactNumberList(std::string_view list, std::string& out);
@@ -0,0 +1,559 @@
+#include "pathData.h"
+
+#include <array>
+#include <cctype>
+#include <charconv>
+#include <cstdint>
+#include <cmath>
+#include <cstring>
+#include <initializer_list>
+#include <vector>
+
+namespace {
+
+   // --- Converted to a double only when it gets rounded ---
+   struct Number {
+      std::string_view text;
+   };
+
+   struct Point {
+      double x = 0.0;
+      double y = 0.0;
+   };
+
+   bool isDigit(char ch) {
+      return ch >= '0' && ch <= '9';
+   }
+
+   bool isSpace(char ch) {
+      return ch == ' ' || ch == '\t' || ch == '\n' || ch == '\r' || ch == '\f';
+   }
+
+   bool startsNumber(char ch) {
+      return isDigit(ch) || ch == '.' || ch == '-' || ch == '+';
+   }
+
+   // --- Tokenizer for the SVG number/path grammar: a comma is only allowed between two numbers ---
+   class Reader {
+      public:
+         explicit Reader(std::string_view data) : data(data) {
+            skipSpace();
+         }
+
+         bool atEnd() const { return pos >= data.size(); }
+         char peek() const { return data[pos]; }
+         void advance() { ++pos; }
+
+         bool atNumber() const { return !atEnd() && startsNumber(data[pos]); }
+
+         void skipSpace() {
+            while (pos < data.size() && isSpace(data[pos])) ++pos;
+         }
+
+         // --- wsp* ","? wsp*; a comma must be followed by another number ---
+         bool skipSeparator() {
+            skipSpace();
+            if (atEnd() || data[pos] != ',') return true;
+            ++pos;
+            skipSpace();
+            return atNumber();
+         }
+
+         bool readNumber(Number& number) {
+            const size_t start = pos;
+            if (pos < data.size() && (data[pos] == '+' || data[pos] == '-')) ++pos;
+
+            const size_t mantissa = pos;
+            while (pos < data.size() && isDigit(data[pos])) ++pos;
+            if (pos < data.size() && data[pos] == '.') {
+               ++pos;
+               while (pos < data.size() && isDigit(data[pos])) ++pos;
+            }
+            if (pos == mantissa || (pos == mantissa + 1 && data[mantissa] == '.')) return false;
+
+            // --- "1e" is a number followed by garbage, not an exponent ---
+            if (pos < data.size() && (data[pos] == 'e' || data[pos] == 'E')) {
+               size_t exponent = pos + 1;
+               if (exponent < data.size() && (data[exponent] == '+' || data[exponent] == '-')) ++exponent;
+               if (exponent < data.size() && isDigit(data[exponent])) {
+                  pos = exponent;
+                  while (pos < data.size() && isDigit(data[pos])) ++pos;
+               }
+            }
+
+            number.text = data.substr(start, pos - start);
+            return true;
+         }
+
+         // --- Arc flags are a single "0" or "1" and may run into the next number ("011") ---
+         bool readFlag(Number& flag) {
+            if (atEnd() || (data[pos] != '0' && data[pos] != '1')) return false;
+            flag.text = data.substr(pos, 1);
+            ++pos;
+            return true;
+         }
+
+      private:
+         std::string_view data;
+         size_t pos = 0;
+   };
+
+   struct Segment {
+      char command;
+      std::array<Number, 7> args;
+   };
+
+   size_t argumentCount(char upper) {
+      switch (upper) {
+         case 'M': case 'L': case 'T': return 2;
+         case 'H': case 'V': return 1;
+         case 'C': return 6;
+         case 'S': case 'Q': return 4;
+         case 'A': return 7;
+         case 'Z': return 0;
+      }
+      return static_cast<size_t>(-1);
+   }
+
+   bool parsePath(std::string_view data, std::vector<Segment>& segments) {
+      Reader reader(data);
+      if (reader.atEnd()) return false;
+
+      while (!reader.atEnd()) {
+         char command = reader.peek();
+         const char upper = static_cast<char>(std::toupper(static_cast<unsigned char>(command)));
+         const size_t count = argumentCount(upper);
+         if (count == static_cast<size_t>(-1) || (segments.empty() && upper != 'M')) return false;
+
+         reader.advance();
+         reader.skipSpace();
+         if (count == 0) {
+            segments.push_back({ command, {} });
+            continue;
+         }
+
+         // --- Argument groups repeat the command; extra pairs after a moveto are linetos ---
+         do {
+            Segment segment{ command, {} };
+            for (size_t i = 0; i < count; ++i) {
+               const bool flag = upper == 'A' && (i == 3 || i == 4);
+               if (!(flag ? reader.readFlag(segment.args[i]) : reader.readNumber(segment.args[i]))) return false;
+               if (!reader.skipSeparator()) return false;
+            }
+            segments.push_back(segment);
+
+            if (command == 'M') command = 'L';
+            if (command == 'm') command = 'l';
+         } while (reader.atNumber());
+      }
+      return true;
+   }
+
+   // --- Separators and repeated command letters are only written where the parser needs them ---
+   struct WriterState {
+      char implicitCommand = 0;
+      bool afterNumber = false;
+      bool afterDecimal = false; // --- the last number has a "." or exponent, so ".5" can follow directly ---
+   };
+
+   // --- Sink that only measures, for comparing the forms of a segment without building them ---
+   struct LengthCounter {
+      size_t size = 0;
+      void operator+=(char) { ++size; }
+      void operator+=(std::string_view text) { size += text.size(); }
+   };
+
+   template <typename Out>
+   void writeCommand(Out& out, WriterState& state, char command) {
+      if (command != state.implicitCommand) {
+         out += command;
+         state.afterNumber = false;
+      }
+
+      if (command == 'M') state.implicitCommand = 'L';
+      else if (command == 'm') state.implicitCommand = 'l';
+      else if (command == 'Z' || command == 'z') state.implicitCommand = 0;
+      else state.implicitCommand = command;
+   }
+
+   template <typename Out>
+   void writeNumber(Out& out, WriterState& state, std::string_view number) {
+      if (state.afterNumber && (isDigit(number[0]) || (number[0] == '.' && !state.afterDecimal))) out += ' ';
+      out += number;
+      state.afterNumber = true;
+      state.afterDecimal = number.find_first_of(".e") != std::string_view::npos;
+   }
+
+   // --- A compacted number in a fixed buffer; rounded values never need more ---
+   struct Formatted {
+      std::array<char, 40> text;
+      size_t size = 0;
+
+      std::string_view view() const { return std::string_view(text.data(), size); }
+   };
+
+   struct Candidate {
+      char command = 0;
+      std::array<Formatted, 7> args;
+      size_t count = 0;
+   };
+
+   template <typename Out>
+   void writeCandidate(Out& out, WriterState& state, const Candidate& candidate) {
+      writeCommand(out, state, candidate.command);
+      for (size_t i = 0; i < candidate.count; ++i) writeNumber(out, state, candidate.args[i].view());
+   }
+
+   void writeShortest(std::string& out, WriterState& state, const Candidate* candidates, size_t count) {
+      const Candidate* best = nullptr;
+      size_t bestSize = 0;
+      for (size_t i = 0; i < count; ++i) {
+         LengthCounter trial;
+         WriterState trialState = state;
+         writeCandidate(trial, trialState, candidates[i]);
+         if (!best || trial.size < bestSize) {
+            best = &candidates[i];
+            bestSize = trial.size;
+         }
+      }
+      writeCandidate(out, state, *best);
+   }
+
+   // --- Writes the compacted form of number to out (room for number.size() bytes); 0 when it is not a number ---
+   size_t compactInto(std::string_view number, char* out) {
+      size_t pos = 0;
+      const bool negative = pos < number.size() && number[pos] == '-';
+      if (pos < number.size() && (number[pos] == '-' || number[pos] == '+')) ++pos;
+
+      auto digits = [&]() {
+         const size_t from = pos;
+         while (pos < number.size() && isDigit(number[pos])) ++pos;
+         return number.substr(from, pos - from);
+      };
+
+      std::string_view integer = digits();
+      std::string_view fraction;
+      if (pos < number.size() && number[pos] == '.') {
+         ++pos;
+         fraction = digits();
+      }
+      if (integer.empty() && fraction.empty()) return 0;
+
+      bool negativeExponent = false;
+      std::string_view exponent;
+      if (pos < number.size() && (number[pos] == 'e' || number[pos] == 'E')) {
+         ++pos;
+         if (pos < number.size() && (number[pos] == '-' || number[pos] == '+')) negativeExponent = number[pos++] == '-';
+         exponent = digits();
+         if (exponent.empty()) return 0;
+      }
+      if (pos != number.size()) return 0;
+
+      while (!integer.empty() && integer.front() == '0') integer.remove_prefix(1);
+      while (!fraction.empty() && fraction.back() == '0') fraction.remove_suffix(1);
+      while (!exponent.empty() && exponent.front() == '0') exponent.remove_prefix(1);
+
+      if (integer.empty() && fraction.empty()) {
+         out[0] = '0';
+         return 1;
+      }
+
+      char* cursor = out;
+      auto append = [&](std::string_view text) {
+         std::memcpy(cursor, text.data(), text.size());
+         cursor += text.size();
+      };
+
+      if (negative) *cursor++ = '-';
+      append(integer);
+      if (!fraction.empty()) {
+         *cursor++ = '.';
+         append(fraction);
+      }
+      if (!exponent.empty()) {
+         *cursor++ = 'e';
+         if (negativeExponent) *cursor++ = '-';
+         append(exponent);
+      }
+      return static_cast<size_t>(cursor - out);
+   }
+
+   // --- Rounds to integer units of 10^-precision, so relative values are exact differences ---
+   class Rounder {
+      public:
+         explicit Rounder(int precision) : precision(precision) {
+            for (int i = 0; i < precision; ++i) unitScale *= 10;
+            scale = static_cast<double>(unitScale);
+         }
+
+         // --- false for magnitudes that would lose integer digits ---
+         bool toUnits(double value, int64_t& units) const {
+            const double scaled = std::round(value * scale);
+            if (!(std::fabs(scaled) <= 1e15)) return false;
+            units = static_cast<int64_t>(scaled);
+            return true;
+         }
+
+         void format(int64_t units, Formatted& out) const {
+            char* cursor = out.text.data();
+            char* const end = cursor + out.text.size();
+            if (units < 0) *cursor++ = '-';
+
+            const uint64_t magnitude = units < 0 ? static_cast<uint64_t>(-units) : static_cast<uint64_t>(units);
+            const uint64_t integer = magnitude / unitScale;
+            uint64_t fraction = magnitude % unitScale;
+            if (integer || !fraction) cursor = std::to_chars(cursor, end, integer).ptr;
+
+            if (fraction) {
+               int width = precision;
+               while (fraction % 10 == 0) {
+                  fraction /= 10;
+                  --width;
+               }
+
+               char digits[20];
+               const size_t length = static_cast<size_t>(std::to_chars(digits, digits + sizeof digits, fraction).ptr - digits);
+               *cursor++ = '.';
+               for (size_t i = length; i < static_cast<size_t>(width); ++i) *cursor++ = '0';
+               std::memcpy(cursor, digits, length);
+               cursor += length;
+            }
+
+            out.size = static_cast<size_t>(cursor - out.text.data());
+            if (out.size == 2 && out.text[0] == '-' && out.text[1] == '0') {
+               out.text[0] = '0';
+               out.size = 1;
+            }
+         }
+
+         bool format(double value, Formatted& out) const {
+            int64_t units = 0;
+            if (!toUnits(value, units)) return false;
+            format(units, out);
+            return true;
+         }
+
+      private:
+         int precision;
+         uint64_t unitScale = 1;
+         double scale;
+   };
+
+   bool toValue(const Number& number, double& value) {
+      const std::string_view text = !number.text.empty() && number.text[0] == '+' ? number.text.substr(1) : number.text;
+      const auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+      return error == std::errc() && end == text.data() + text.size() && std::isfinite(value);
+   }
+
+   bool writeExact(const std::vector<Segment>& segments, std::string& out) {
+      WriterState state;
+      std::string number;
+      for (const Segment& segment : segments) {
+         writeCommand(out, state, segment.command);
+         const size_t count = argumentCount(static_cast<char>(std::toupper(static_cast<unsigned char>(segment.command))));
+         for (size_t i = 0; i < count; ++i) {
+            number.resize(segment.args[i].text.size());
+            number.resize(compactInto(segment.args[i].text, number.data()));
+            if (number.empty()) return false;
+            writeNumber(out, state, number);
+         }
+      }
+      return true;
+   }
+
+   /**
+    * Every endpoint is rounded in absolute coordinates, and relative forms
+    * are taken from the previous rounded endpoint, so the point a renderer
+    * accumulates never drifts from the rounded source point.
+    */
+   bool writeRounded(const std::vector<Segment>& segments, const Rounder& rounder, std::string& out) {
+      struct Units {
+         int64_t x = 0;
+         int64_t y = 0;
+      };
+
+      WriterState state;
+      Point source;      // --- current point of the original path ---
+      Point sourceStart;
+      Units current;     // --- current point of the written path ---
+      Units start;
+
+      std::array<Candidate, 6> candidates;
+      size_t candidateCount = 0;
+
+      auto addCandidate = [&](char command, int64_t value) {
+         Candidate& candidate = candidates[candidateCount++];
+         candidate.command = command;
+         candidate.count = 1;
+         rounder.format(value, candidate.args[0]);
+      };
+
+      // --- Absolute and relative form of a segment whose arguments end with the points (after the arc's shape) ---
+      auto addPointCandidates = [&](char upper, const Candidate& prefix, const Units* points, size_t count) {
+         Candidate& absolute = candidates[candidateCount++];
+         Candidate& relative = candidates[candidateCount++];
+         absolute = prefix;
+         relative = prefix;
+         absolute.command = upper;
+         relative.command = static_cast<char>(std::tolower(upper));
+
+         for (size_t i = 0; i < count; ++i) {
+            rounder.format(points[i].x, absolute.args[absolute.count++]);
+            rounder.format(points[i].y, absolute.args[absolute.count++]);
+            rounder.format(points[i].x - current.x, relative.args[relative.count++]);
+            rounder.format(points[i].y - current.y, relative.args[relative.count++]);
+         }
+      };
+
+      const Candidate noPrefix{};
+      for (const Segment& segment : segments) {
+         const char upper = static_cast<char>(std::toupper(static_cast<unsigned char>(segment.command)));
+         const size_t count = argumentCount(upper);
+
+         std::array<double, 7> values;
+         for (size_t i = 0; i < count; ++i) {
+            if (!toValue(segment.args[i], values[i])) return false;
+         }
+
+         const Point origin = segment.command != upper ? source : Point{};
+         auto sourcePoint = [&](size_t index) {
+            return Point{ origin.x + values[index], origin.y + values[index + 1] };
+         };
+
+         std::array<Units, 3> points; // --- absolute control points and endpoint of the segment, rounded ---
+         size_t pointCount = 1;
+         auto roundPoint = [&](size_t index, Point point) {
+            return rounder.toUnits(point.x, points[index].x) && rounder.toUnits(point.y, points[index].y);
+         };
+
+         candidateCount = 0;
+         Point end = source;
+
+         switch (upper) {
+            case 'Z':
+               writeCommand(out, state, 'z');
+               source = sourceStart;
+               current = start;
+               continue;
+
+            case 'M': case 'T':
+               end = sourcePoint(0);
+               if (!roundPoint(0, end)) return false;
+               addPointCandidates(upper, noPrefix, points.data(), 1);
+               break;
+
+            case 'L': case 'H': case 'V': {
+               if (upper == 'L') end = sourcePoint(0);
+               else if (upper == 'H') end.x = origin.x + values[0];
+               else end.y = origin.y + values[0];
+
+               if (!roundPoint(0, end)) return false;
+               const Units target = points[0];
+               addPointCandidates('L', noPrefix, points.data(), 1);
+               if (target.y == current.y) {
+                  addCandidate('H', target.x);
+                  addCandidate('h', target.x - current.x);
+               }
+               if (target.x == current.x) {
+                  addCandidate('V', target.y);
+                  addCandidate('v', target.y - current.y);
+               }
+               break;
+            }
+
+            case 'C': case 'S': case 'Q':
+               pointCount = count / 2;
+               for (size_t i = 0; i < pointCount; ++i) {
+                  if (!roundPoint(i, sourcePoint(i * 2))) return false;
+               }
+               end = sourcePoint((pointCount - 1) * 2);
+               addPointCandidates(upper, noPrefix, points.data(), pointCount);
+               break;
+
+            case 'A': {
+               Candidate shape;
+               for (size_t i = 0; i < 3; ++i) {
+                  if (!rounder.format(values[i], shape.args[shape.count++])) return false;
+               }
+               for (size_t i = 3; i < 5; ++i) {
+                  Formatted& flag = shape.args[shape.count++];
+                  flag.text[0] = segment.args[i].text[0];
+                  flag.size = 1;
+               }
+               end = sourcePoint(5);
+               if (!roundPoint(0, end)) return false;
+               addPointCandidates(upper, shape, points.data(), 1);
+               break;
+            }
+         }
+
+         writeShortest(out, state, candidates.data(), candidateCount);
+         source = end;
+         current = points[pointCount - 1];
+         if (upper == 'M') {
+            sourceStart = source;
+            start = current;
+         }
+      }
+      return true;
+   }
+
+   bool readNumberList(std::string_view list, std::vector<Number>& numbers) {
+      Reader reader(list);
+      while (!reader.atEnd()) {
+         Number number;
+         if (!reader.readNumber(number) || !reader.skipSeparator()) return false;
+         numbers.push_back(number);
+      }
+      return !numbers.empty();
+   }
+
+} // namespace
+
+bool compactNumber(std::string_view number, std::string& out) {
+   out.resize(number.size());
+   out.resize(compactInto(number, out.data()));
+   return !out.empty();
+}
+
+bool compactPathData(std::string_view data, int precision, std::string& out) {
+   std::vector<Segment> segments;
+   segments.reserve(data.size() / 8);
+   if (!parsePath(data, segments)) return false;
+
+   out.clear();
+   out.reserve(data.size());
+   return precision < 0 ? writeExact(segments, out) : writeRounded(segments, Rounder(precision), out);
+}
+
+bool compactPointList(std::string_view list, int precision, std::string& out) {
+   std::vector<Number> numbers;
+   if (!readNumberList(list, numbers) || numbers.size() % 2 != 0) return false;
+
+   out.clear();
+   if (precision < 0) return compactNumberList(list, out);
+
+   WriterState state;
+   Formatted number;
+   const Rounder rounder(precision);
+   for (const Number& value : numbers) {
+      double parsed = 0.0;
+      if (!toValue(value, parsed) || !rounder.format(parsed, number)) return false;
+      writeNumber(out, state, number.view());
+   }
+   return true;
+}
+
+bool compactNumberList(std::string_view list, std::string& out) {
+   std::vector<Number> numbers;
+   if (!readNumberList(list, numbers)) return false;
+
+   out.clear();
+   WriterState state;
+   std::string number;
+   for (const Number& value : numbers) {
+      if (!compactNumber(value.text, number)) return false;
+      writeNumber(out, state, number);
+   }
+   return true;
+}
@@ -0,0 +1,20 @@
+#include <cstddef>
+#include <string_view>
+#pragma once
+
+// --- Byte-class counts gathered in one vectorized pass ---
+struct TextDensity {
+   size_t length = 0;
+   size_t whitespace = 0;
+   size_t newlines = 0;
+   size_t commentMarkers = 0;
+};
+
+// --- Count whitespace, newlines and comment openers (`open` followed by `next1` or `next2`) ---
+TextDensity measureDensity(std::string_view text, char open, char next1, char next2);
+
+// --- First '"', '\\' or control byte (< 0x20) at or after from; text.size() if none ---
+size_t findStringStop(std::string_view text, size_t from);
+
+// --- First '<', tab/newline/CR/form feed, or space followed by whitespace at or after from; text.size() if none ---
+size_t findMarkupStop(std::string_view text, size_t from);
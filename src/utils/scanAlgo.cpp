@@ -0,0 +1,191 @@
+#include <bit>
+#include <cstdint>
+#include "scan.h"
+#include "trim.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define PHPSPA_SCAN_SSE2 1
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define PHPSPA_SCAN_NEON 1
+#endif
+
+namespace {
+
+   void measureScalar(std::string_view text, size_t from, char open, char next1, char next2, TextDensity& density) {
+      for (size_t i = from; i < text.size(); ++i) {
+         const char ch = text[i];
+         if (isWhitespace(ch)) {
+            ++density.whitespace;
+            if (ch == '\n') ++density.newlines;
+         } else if (ch == open && i + 1 < text.size() && (text[i + 1] == next1 || text[i + 1] == next2)) {
+            ++density.commentMarkers;
+         }
+      }
+   }
+
+} // namespace
+
+TextDensity measureDensity(std::string_view text, char open, char next1, char next2) {
+   TextDensity density;
+   density.length = text.size();
+
+   const char* data = text.data();
+   size_t i = 0;
+
+#if defined(PHPSPA_SCAN_SSE2)
+   const __m128i space = _mm_set1_epi8(' ');
+   const __m128i tab = _mm_set1_epi8('\t');
+   const __m128i newline = _mm_set1_epi8('\n');
+   const __m128i carriage = _mm_set1_epi8('\r');
+   const __m128i feed = _mm_set1_epi8('\f');
+   const __m128i opener = _mm_set1_epi8(open);
+   const __m128i follow1 = _mm_set1_epi8(next1);
+   const __m128i follow2 = _mm_set1_epi8(next2);
+
+   // --- 17 readable bytes per step: the comment pair may straddle the block edge ---
+   for (; i + 17 <= text.size(); i += 16) {
+      const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+      const __m128i shifted = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + 1));
+
+      const __m128i lines = _mm_cmpeq_epi8(block, newline);
+      const __m128i blanks = _mm_or_si128(
+         _mm_or_si128(_mm_cmpeq_epi8(block, space), _mm_cmpeq_epi8(block, tab)),
+         _mm_or_si128(_mm_or_si128(lines, _mm_cmpeq_epi8(block, carriage)), _mm_cmpeq_epi8(block, feed))
+      );
+      const __m128i markers = _mm_and_si128(
+         _mm_cmpeq_epi8(block, opener),
+         _mm_or_si128(_mm_cmpeq_epi8(shifted, follow1), _mm_cmpeq_epi8(shifted, follow2))
+      );
+
+      density.whitespace += std::popcount(static_cast<uint32_t>(_mm_movemask_epi8(blanks)));
+      density.newlines += std::popcount(static_cast<uint32_t>(_mm_movemask_epi8(lines)));
+      density.commentMarkers += std::popcount(static_cast<uint32_t>(_mm_movemask_epi8(markers)));
+   }
+#elif defined(PHPSPA_SCAN_NEON)
+   const uint8x16_t one = vdupq_n_u8(1);
+
+   for (; i + 17 <= text.size(); i += 16) {
+      const uint8x16_t block = vld1q_u8(reinterpret_cast<const uint8_t*>(data + i));
+      const uint8x16_t shifted = vld1q_u8(reinterpret_cast<const uint8_t*>(data + i + 1));
+
+      const uint8x16_t lines = vceqq_u8(block, vdupq_n_u8('\n'));
+      const uint8x16_t blanks = vorrq_u8(
+         vorrq_u8(vceqq_u8(block, vdupq_n_u8(' ')), vceqq_u8(block, vdupq_n_u8('\t'))),
+         vorrq_u8(vorrq_u8(lines, vceqq_u8(block, vdupq_n_u8('\r'))), vceqq_u8(block, vdupq_n_u8('\f')))
+      );
+      const uint8x16_t markers = vandq_u8(
+         vceqq_u8(block, vdupq_n_u8(static_cast<uint8_t>(open))),
+         vorrq_u8(vceqq_u8(shifted, vdupq_n_u8(static_cast<uint8_t>(next1))), vceqq_u8(shifted, vdupq_n_u8(static_cast<uint8_t>(next2))))
+      );
+
+      density.whitespace += vaddvq_u8(vandq_u8(blanks, one));
+      density.newlines += vaddvq_u8(vandq_u8(lines, one));
+      density.commentMarkers += vaddvq_u8(vandq_u8(markers, one));
+   }
+#endif
+
+   measureScalar(text, i, open, next1, next2, density);
+   return density;
+}
+
+size_t findStringStop(std::string_view text, size_t from) {
+   const char* data = text.data();
+   size_t i = from;
+
+#if defined(PHPSPA_SCAN_SSE2)
+   const __m128i quote = _mm_set1_epi8('"');
+   const __m128i backslash = _mm_set1_epi8('\\');
+   const __m128i lastControl = _mm_set1_epi8(0x1f);
+
+   for (; i + 16 <= text.size(); i += 16) {
+      const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+
+      // --- Unsigned b <= 0x1f  <=>  max(b, 0x1f) == 0x1f ---
+      const __m128i stops = _mm_or_si128(
+         _mm_or_si128(_mm_cmpeq_epi8(block, quote), _mm_cmpeq_epi8(block, backslash)),
+         _mm_cmpeq_epi8(_mm_max_epu8(block, lastControl), lastControl)
+      );
+
+      const uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(stops));
+      if (mask != 0) return i + std::countr_zero(mask);
+   }
+#elif defined(PHPSPA_SCAN_NEON)
+   for (; i + 16 <= text.size(); i += 16) {
+      const uint8x16_t block = vld1q_u8(reinterpret_cast<const uint8_t*>(data + i));
+      const uint8x16_t stops = vorrq_u8(
+         vorrq_u8(vceqq_u8(block, vdupq_n_u8('"')), vceqq_u8(block, vdupq_n_u8('\\'))),
+         vcleq_u8(block, vdupq_n_u8(0x1f))
+      );
+      if (vmaxvq_u8(stops) != 0) break; // --- the scalar loop pins down the exact byte ---
+   }
+#endif
+
+   for (; i < text.size(); ++i) {
+      const unsigned char ch = static_cast<unsigned char>(data[i]);
+      if (ch == '"' || ch == '\\' || ch < 0x20) return i;
+   }
+   return text.size();
+}
+
+size_t findMarkupStop(std::string_view text, size_t from) {
+   const char* data = text.data();
+   size_t i = from;
+
+#if defined(PHPSPA_SCAN_SSE2)
+   const __m128i open = _mm_set1_epi8('<');
+   const __m128i space = _mm_set1_epi8(' ');
+   const __m128i tab = _mm_set1_epi8('\t');
+   const __m128i newline = _mm_set1_epi8('\n');
+   const __m128i carriage = _mm_set1_epi8('\r');
+   const __m128i feed = _mm_set1_epi8('\f');
+
+   // --- 17 readable bytes per step: a space stops only when the next byte is whitespace too ---
+   for (; i + 17 <= text.size(); i += 16) {
+      const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+      const __m128i shifted = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + 1));
+
+      const __m128i breaks = _mm_or_si128(
+         _mm_or_si128(_mm_cmpeq_epi8(block, tab), _mm_cmpeq_epi8(block, newline)),
+         _mm_or_si128(_mm_cmpeq_epi8(block, carriage), _mm_cmpeq_epi8(block, feed))
+      );
+      const __m128i nextBlank = _mm_or_si128(
+         _mm_or_si128(_mm_cmpeq_epi8(shifted, space), _mm_cmpeq_epi8(shifted, tab)),
+         _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(shifted, newline), _mm_cmpeq_epi8(shifted, carriage)), _mm_cmpeq_epi8(shifted, feed))
+      );
+      const __m128i stops = _mm_or_si128(
+         _mm_or_si128(_mm_cmpeq_epi8(block, open), breaks),
+         _mm_and_si128(_mm_cmpeq_epi8(block, space), nextBlank)
+      );
+
+      const uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(stops));
+      if (mask != 0) return i + std::countr_zero(mask);
+   }
+#elif defined(PHPSPA_SCAN_NEON)
+   for (; i + 17 <= text.size(); i += 16) {
+      const uint8x16_t block = vld1q_u8(reinterpret_cast<const uint8_t*>(data + i));
+      const uint8x16_t shifted = vld1q_u8(reinterpret_cast<const uint8_t*>(data + i + 1));
+
+      const uint8x16_t breaks = vorrq_u8(
+         vorrq_u8(vceqq_u8(block, vdupq_n_u8('\t')), vceqq_u8(block, vdupq_n_u8('\n'))),
+         vorrq_u8(vceqq_u8(block, vdupq_n_u8('\r')), vceqq_u8(block, vdupq_n_u8('\f')))
+      );
+      const uint8x16_t nextBlank = vorrq_u8(
+         vorrq_u8(vceqq_u8(shifted, vdupq_n_u8(' ')), vceqq_u8(shifted, vdupq_n_u8('\t'))),
+         vorrq_u8(vorrq_u8(vceqq_u8(shifted, vdupq_n_u8('\n')), vceqq_u8(shifted, vdupq_n_u8('\r'))), vceqq_u8(shifted, vdupq_n_u8('\f')))
+      );
+      const uint8x16_t stops = vorrq_u8(
+         vorrq_u8(vceqq_u8(block, vdupq_n_u8('<')), breaks),
+         vandq_u8(vceqq_u8(block, vdupq_n_u8(' ')), nextBlank)
+      );
+      if (vmaxvq_u8(stops) != 0) break; // --- the scalar loop pins down the exact byte ---
+   }
+#endif
+
+   for (; i < text.size(); ++i) {
+      const char ch = data[i];
+      if (ch == '<' || (ch != ' ' && isWhitespace(ch)) || (ch == ' ' && i + 1 < text.size() && isWhitespace(data[i + 1]))) return i;
+   }
+   return text.size();
+}
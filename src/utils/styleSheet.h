@@ -0,0 +1,60 @@
+#include <string>
+#include <string_view>
+#include <vector>
+#pragma once
+
+// --- Minimal stylesheet model for page-level passes over inline <style> blocks ---
+
+struct CssDeclaration {
+   std::string property; // --- lowercase ---
+   std::string text;     // --- "property:value[!important]" as written ---
+   bool important = false;
+};
+
+struct CssNode {
+   enum class Kind { Rule, Group, Opaque };
+
+   Kind kind = Kind::Opaque;
+   std::string prelude; // --- selector, grouping at-rule prelude, or the whole opaque text ---
+   std::vector<CssDeclaration> declarations;
+   std::vector<CssNode> children;
+   bool removed = false;
+};
+
+struct StyleBlock {
+   size_t start = 0;     // --- "<style" ---
+   size_t bodyStart = 0; // --- after the opening tag ---
+   size_t bodyEnd = 0;   // --- "</style" ---
+   size_t end = 0;       // --- after the closing tag ---
+   std::string media;
+   std::vector<CssNode> nodes;
+};
+
+// --- Locate the <style> elements that apply to the document (not inside script/template/noscript/textarea) ---
+std::vector<StyleBlock> findStyleBlocks(std::string_view html);
+
+// --- Parse every block's CSS; false if any block is malformed ---
+bool parseStyleBlocks(std::string_view html, std::vector<StyleBlock>& blocks);
+
+void serializeDeclarations(const std::vector<CssDeclaration>& declarations, std::string& out);
+
+// --- Appends the live nodes; false if nothing was written ---
+bool serializeNodes(const std::vector<CssNode>& nodes, std::string& out);
+
+// --- Rewrite each block with its serialized nodes, dropping blocks left empty ---
+void writeStyleBlocks(std::string& html, const std::vector<StyleBlock>& blocks);
+
+// --- Tag helpers shared by the page passes ---
+bool isTagAt(std::string_view html, size_t pos, std::string_view lowerName);
+size_t findTagIgnoreCase(std::string_view html, std::string_view lowerNeedle, size_t from);
+std::string tagAttribute(std::string_view tag, std::string_view lowerName);
+
+// --- Presence of an attribute, valued or not (tagAttribute cannot tell src="" from no src) ---
+bool hasAttribute(std::string_view tag, std::string_view lowerName);
+
+// --- HTML start tags that end <svg>/<math> content unless inside an integration point ---
+bool isForeignBreakout(std::string_view lowerName);
+
+// --- What a <script> body holds, from its type attribute (browsers only run exact JavaScript types) ---
+enum class ScriptKind { JavaScript, Json, Other };
+ScriptKind classifyScriptType(std::string_view type);
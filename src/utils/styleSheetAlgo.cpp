@@ -0,0 +1,351 @@
+#include "styleSheet.h"
+
+#include <algorithm>
+#include <cctype>
+#include <iterator>
+
+namespace {
+
+   std::string toLower(std::string_view value) {
+      std::string lower(value);
+      for (char& ch : lower) ch = static_cast<char>(std::tolower(static_cast<unsigned char>(ch)));
+      return lower;
+   }
+
+   std::string_view trimView(std::string_view value) {
+      while (!value.empty() && std::isspace(static_cast<unsigned char>(value.front()))) value.remove_prefix(1);
+      while (!value.empty() && std::isspace(static_cast<unsigned char>(value.back()))) value.remove_suffix(1);
+      return value;
+   }
+
+   bool startsWithIgnoreCase(std::string_view text, size_t pos, std::string_view lowerNeedle) {
+      if (pos + lowerNeedle.size() > text.size()) return false;
+      for (size_t i = 0; i < lowerNeedle.size(); ++i) {
+         if (std::tolower(static_cast<unsigned char>(text[pos + i])) != lowerNeedle[i]) return false;
+      }
+      return true;
+   }
+
+   // --- Skips a string or comment starting at pos; returns the index after it, or pos if none starts there ---
+   size_t skipOpaque(std::string_view css, size_t pos) {
+      const char ch = css[pos];
+      if (ch == '"' || ch == '\'') {
+         size_t i = pos + 1;
+         while (i < css.size() && css[i] != ch) i += (css[i] == '\\') ? 2 : 1;
+         return std::min(i + 1, css.size());
+      }
+      if (ch == '/' && pos + 1 < css.size() && css[pos + 1] == '*') {
+         const size_t end = css.find("*/", pos + 2);
+         return end == std::string_view::npos ? css.size() : end + 2;
+      }
+      return pos;
+   }
+
+   // --- First of stops at parenthesis depth 0, outside strings and comments ---
+   size_t findStructural(std::string_view css, size_t pos, std::string_view stops) {
+      int depth = 0;
+      while (pos < css.size()) {
+         const size_t skipped = skipOpaque(css, pos);
+         if (skipped != pos) {
+            pos = skipped;
+            continue;
+         }
+
+         const char ch = css[pos];
+         if (ch == '(') ++depth;
+         else if (ch == ')' && depth > 0) --depth;
+         else if (depth == 0 && stops.find(ch) != std::string_view::npos) return pos;
+         ++pos;
+      }
+      return std::string_view::npos;
+   }
+
+   // --- Index of the "}" matching the "{" at open ---
+   size_t findBlockEnd(std::string_view css, size_t open) {
+      int depth = 0;
+      size_t pos = open;
+      while (pos < css.size()) {
+         const size_t skipped = skipOpaque(css, pos);
+         if (skipped != pos) {
+            pos = skipped;
+            continue;
+         }
+
+         if (css[pos] == '{') ++depth;
+         else if (css[pos] == '}' && --depth == 0) return pos;
+         ++pos;
+      }
+      return std::string_view::npos;
+   }
+
+   bool parseDeclarations(std::string_view body, std::vector<CssDeclaration>& declarations) {
+      size_t pos = 0;
+      while (pos <= body.size()) {
+         size_t end = findStructural(body, pos, ";");
+         if (end == std::string_view::npos) end = body.size();
+
+         const std::string_view text = trimView(body.substr(pos, end - pos));
+         if (!text.empty()) {
+            const size_t colon = text.find(':');
+            if (colon == std::string_view::npos || colon == 0) return false;
+
+            CssDeclaration declaration;
+            declaration.property = toLower(trimView(text.substr(0, colon)));
+            declaration.text.assign(text);
+            const size_t bang = text.rfind('!');
+            declaration.important = bang != std::string_view::npos && bang > colon &&
+                                    toLower(trimView(text.substr(bang + 1))) == "important";
+            declarations.push_back(std::move(declaration));
+         }
+         pos = end + 1;
+      }
+      return true;
+   }
+
+   bool parseNodes(std::string_view css, size_t& pos, std::vector<CssNode>& nodes, bool nested) {
+      while (true) {
+         while (pos < css.size() && std::isspace(static_cast<unsigned char>(css[pos]))) ++pos;
+         if (pos >= css.size()) return !nested;
+         if (css[pos] == '}') {
+            if (!nested) return false;
+            ++pos;
+            return true;
+         }
+
+         const size_t stop = findStructural(css, pos, "{;}");
+         if (stop == std::string_view::npos || css[stop] == '}') return false;
+
+         CssNode node;
+         const std::string_view prelude = trimView(css.substr(pos, stop - pos));
+
+         if (css[stop] == ';') {
+            node.prelude.assign(prelude);
+            node.prelude += ';';
+            nodes.push_back(std::move(node));
+            pos = stop + 1;
+            continue;
+         }
+
+         const size_t close = findBlockEnd(css, stop);
+         if (close == std::string_view::npos) return false;
+
+         if (prelude.starts_with('@')) {
+            const std::string lowerPrelude = toLower(prelude);
+            const bool grouping = lowerPrelude.starts_with("@media") || lowerPrelude.starts_with("@supports") ||
+                                  lowerPrelude.starts_with("@container") || lowerPrelude.starts_with("@layer");
+            if (grouping) {
+               node.kind = CssNode::Kind::Group;
+               node.prelude.assign(prelude);
+               pos = stop + 1;
+               if (!parseNodes(css, pos, node.children, true)) return false;
+               nodes.push_back(std::move(node));
+               continue;
+            }
+         } else {
+            const std::string_view body = css.substr(stop + 1, close - stop - 1);
+            // --- Nested rules keep their block as written ---
+            if (findStructural(body, 0, "{}") == std::string_view::npos && parseDeclarations(body, node.declarations)) {
+               node.kind = CssNode::Kind::Rule;
+               node.prelude.assign(prelude);
+               nodes.push_back(std::move(node));
+               pos = close + 1;
+               continue;
+            }
+            node.declarations.clear();
+         }
+
+         node.prelude.assign(trimView(css.substr(pos, close + 1 - pos)));
+         nodes.push_back(std::move(node));
+         pos = close + 1;
+      }
+   }
+
+} // namespace
+
+bool isTagAt(std::string_view html, size_t pos, std::string_view lowerName) {
+   if (!startsWithIgnoreCase(html, pos + 1, lowerName)) return false;
+   const size_t after = pos + 1 + lowerName.size();
+   return after < html.size() && (html[after] == '>' || html[after] == '/' || std::isspace(static_cast<unsigned char>(html[after])));
+}
+
+size_t findTagIgnoreCase(std::string_view text, std::string_view lowerNeedle, size_t from) {
+   for (size_t pos = text.find('<', from); pos != std::string_view::npos; pos = text.find('<', pos + 1)) {
+      if (startsWithIgnoreCase(text, pos, lowerNeedle)) return pos;
+   }
+   return std::string_view::npos;
+}
+
+std::string tagAttribute(std::string_view tag, std::string_view lowerName) {
+   const std::string lowerTag = toLower(tag);
+   size_t pos = lowerTag.find(lowerName);
+   while (pos != std::string::npos && (pos == 0 || !std::isspace(static_cast<unsigned char>(lowerTag[pos - 1])))) {
+      pos = lowerTag.find(lowerName, pos + 1);
+   }
+   if (pos == std::string::npos) return std::string();
+
+   pos += lowerName.size();
+   if (pos >= tag.size() || tag[pos] != '=') return std::string();
+   ++pos;
+
+   if (pos < tag.size() && (tag[pos] == '"' || tag[pos] == '\'')) {
+      const size_t end = tag.find(tag[pos], pos + 1);
+      return std::string(tag.substr(pos + 1, end == std::string_view::npos ? std::string_view::npos : end - pos - 1));
+   }
+   size_t end = pos;
+   while (end < tag.size() && !std::isspace(static_cast<unsigned char>(tag[end])) && tag[end] != '>') ++end;
+   return std::string(tag.substr(pos, end - pos));
+}
+
+bool hasAttribute(std::string_view tag, std::string_view lowerName) {
+   const std::string lower = toLower(tag);
+   for (size_t pos = lower.find(lowerName); pos != std::string::npos; pos = lower.find(lowerName, pos + 1)) {
+      const size_t end = pos + lowerName.size();
+      const bool startsName = pos > 0 && std::isspace(static_cast<unsigned char>(lower[pos - 1]));
+      const bool endsName = end < lower.size() && (lower[end] == '=' || lower[end] == '>' || lower[end] == '/' || std::isspace(static_cast<unsigned char>(lower[end])));
+      if (startsName && endsName) return true;
+   }
+   return false;
+}
+
+bool isForeignBreakout(std::string_view lowerName) {
+   static constexpr std::string_view kBreakouts[] = {
+      "b", "big", "blockquote", "body", "br", "center", "code", "dd", "div", "dl", "dt", "em", "embed", "h1", "h2",
+      "h3", "h4", "h5", "h6", "head", "hr", "i", "img", "li", "listing", "menu", "meta", "nobr", "ol", "p",
+      "pre", "ruby", "s", "small", "span", "strike", "strong", "sub", "sup", "table", "tt", "u", "ul", "var",
+   };
+   return std::find(std::begin(kBreakouts), std::end(kBreakouts), lowerName) != std::end(kBreakouts);
+}
+
+ScriptKind classifyScriptType(std::string_view type) {
+   static constexpr std::string_view kJavaScriptTypes[] = {
+      "application/ecmascript", "application/javascript", "application/x-ecmascript", "application/x-javascript",
+      "module", "text/ecmascript", "text/javascript", "text/javascript1.0", "text/javascript1.1", "text/javascript1.2",
+      "text/javascript1.3", "text/javascript1.4", "text/javascript1.5", "text/jscript", "text/livescript",
+      "text/x-ecmascript", "text/x-javascript",
+   };
+   static constexpr std::string_view kJsonTypes[] = { "application/json", "importmap", "speculationrules", "text/json" };
+
+   const std::string essence = toLower(trimView(type));
+   if (essence.empty()) return ScriptKind::JavaScript;
+
+   for (const std::string_view candidate : kJavaScriptTypes) {
+      if (essence == candidate) return ScriptKind::JavaScript;
+   }
+   for (const std::string_view candidate : kJsonTypes) {
+      if (essence == candidate) return ScriptKind::Json;
+   }
+
+   // --- application/ld+json, application/manifest+json, ... ---
+   if (essence.size() > 5 && essence.compare(essence.size() - 5, 5, "+json") == 0) return ScriptKind::Json;
+   return ScriptKind::Other;
+}
+
+std::vector<StyleBlock> findStyleBlocks(std::string_view html) {
+   std::vector<StyleBlock> blocks;
+
+   for (size_t pos = html.find('<'); pos != std::string_view::npos; pos = html.find('<', pos + 1)) {
+      bool skipped = false;
+      for (const std::string_view inert : { "script", "template", "noscript", "textarea" }) {
+         if (isTagAt(html, pos, inert)) {
+            const size_t close = findTagIgnoreCase(html, std::string("</") + std::string(inert), pos + 1);
+            if (close == std::string_view::npos) return blocks;
+            pos = close;
+            skipped = true;
+            break;
+         }
+      }
+      if (skipped || !isTagAt(html, pos, "style")) continue;
+
+      const size_t openEnd = html.find('>', pos);
+      const size_t close = openEnd == std::string_view::npos ? openEnd : findTagIgnoreCase(html, "</style", openEnd);
+      const size_t closeEnd = close == std::string_view::npos ? close : html.find('>', close);
+      if (closeEnd == std::string_view::npos) return blocks;
+
+      const std::string_view openTag = html.substr(pos, openEnd - pos + 1);
+      const std::string type = toLower(tagAttribute(openTag, "type"));
+      if (type.empty() || type == "text/css") {
+         StyleBlock block;
+         block.start = pos;
+         block.bodyStart = openEnd + 1;
+         block.bodyEnd = close;
+         block.end = closeEnd + 1;
+         block.media = toLower(tagAttribute(openTag, "media"));
+         blocks.push_back(std::move(block));
+      }
+      pos = closeEnd;
+   }
+   return blocks;
+}
+
+bool parseStyleBlocks(std::string_view html, std::vector<StyleBlock>& blocks) {
+   for (StyleBlock& block : blocks) {
+      const std::string_view css = html.substr(block.bodyStart, block.bodyEnd - block.bodyStart);
+      size_t pos = 0;
+      if (!parseNodes(css, pos, block.nodes, false)) return false;
+   }
+   return true;
+}
+
+void serializeDeclarations(const std::vector<CssDeclaration>& declarations, std::string& out) {
+   for (size_t i = 0; i < declarations.size(); ++i) {
+      if (i > 0) out += ';';
+      out += declarations[i].text;
+   }
+}
+
+bool serializeNodes(const std::vector<CssNode>& nodes, std::string& out) {
+   const size_t before = out.size();
+   for (const CssNode& node : nodes) {
+      if (node.removed) continue;
+
+      switch (node.kind) {
+         case CssNode::Kind::Rule:
+            if (node.declarations.empty()) break;
+            out += node.prelude;
+            out += '{';
+            serializeDeclarations(node.declarations, out);
+            out += '}';
+            break;
+
+         case CssNode::Kind::Group: {
+            const size_t groupStart = out.size();
+            out += node.prelude;
+            out += '{';
+            // --- Drop at-rules left without content ---
+            if (!serializeNodes(node.children, out)) {
+               out.resize(groupStart);
+               break;
+            }
+            out += '}';
+            break;
+         }
+
+         case CssNode::Kind::Opaque:
+            out += node.prelude;
+            break;
+      }
+   }
+   return out.size() > before;
+}
+
+void writeStyleBlocks(std::string& html, const std::vector<StyleBlock>& blocks) {
+   std::string out;
+   out.reserve(html.size());
+   size_t copied = 0;
+   std::string css;
+
+   for (const StyleBlock& block : blocks) {
+      css.clear();
+      out.append(html, copied, block.start - copied);
+
+      if (serializeNodes(block.nodes, css)) {
+         out.append(html, block.start, block.bodyStart - block.start);
+         out += css;
+         out.append(html, block.bodyEnd, block.end - block.bodyEnd);
+      }
+      copied = block.end;
+   }
+
+   out.append(html, copied, std::string::npos);
+   html.swap(out);
+}
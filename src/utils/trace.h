@@ -0,0 +1,65 @@
+#include <atomic>
+#include <cstdint>
+#include <string>
+#pragma once
+
+/**
+ * Opt-in timeline of the compressor's work, written as Chrome trace_event
+ * JSON (open it in chrome://tracing or https://ui.perfetto.dev).
+ *
+ * While no trace is recording a TraceSpan is one relaxed atomic load; spans
+ * take static names and integer arguments only, so nothing is formatted or
+ * allocated on the disabled path.
+ */
+
+namespace trace_detail {
+   // --- Id of the recording session, 0 while tracing is off ---
+   extern std::atomic<uint32_t> session;
+
+   void record(uint32_t session, const char* name, int64_t startNanos, const char* const* argNames, const int64_t* argValues, int argCount);
+
+   int64_t nowNanos();
+}
+
+// --- Start recording spans from every thread; false when a trace is already recording ---
+bool traceStart();
+
+// --- Stop recording and write the spans to path; false when no trace was recording or the file cannot be written ---
+bool traceStop(const std::string& path);
+
+// --- Times the enclosing scope as one complete ("X") event ---
+class TraceSpan {
+   public:
+      explicit TraceSpan(const char* name) : session(trace_detail::session.load(std::memory_order_relaxed)), name(name) {
+         if (session != 0) start = trace_detail::nowNanos();
+      }
+
+      TraceSpan(const char* name, int64_t bytes) : TraceSpan(name) {
+         arg("bytes", bytes);
+      }
+
+      ~TraceSpan() {
+         if (session != 0) trace_detail::record(session, name, start, argNames, argValues, argCount);
+      }
+
+      TraceSpan(const TraceSpan&) = delete;
+      TraceSpan& operator=(const TraceSpan&) = delete;
+
+      // --- Attach an integer argument (name must outlive the span); extra ones are dropped ---
+      void arg(const char* argName, int64_t value) {
+         if (session == 0 || argCount == kMaxArgs) return;
+         argNames[argCount] = argName;
+         argValues[argCount] = value;
+         ++argCount;
+      }
+
+   private:
+      static constexpr int kMaxArgs = 3;
+
+      uint32_t session;
+      const char* name;
+      int64_t start = 0;
+      const char* argNames[kMaxArgs];
+      int64_t argValues[kMaxArgs];
+      int argCount = 0;
+};
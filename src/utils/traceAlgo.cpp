@@ -0,0 +1,147 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <mutex>
+#include <vector>
+#include "trace.h"
+
+namespace {
+
+   struct TraceEvent {
+      const char* name;
+      int64_t start;
+      int64_t duration;
+      uint32_t thread;
+      int argCount;
+      const char* argNames[3];
+      int64_t argValues[3];
+   };
+
+   // --- A runaway trace stops growing here; later spans are counted, not kept ---
+   constexpr size_t kMaxEvents = 1 << 20;
+
+   std::mutex mutex;
+   std::vector<TraceEvent> events;
+   uint32_t lastSession = 0;
+   int64_t origin = 0;
+   size_t dropped = 0;
+
+   // --- Small sequential ids read better in the viewer than hashed std::thread::id values ---
+   uint32_t threadId() {
+      static std::atomic<uint32_t> nextThread{ 1 };
+      thread_local const uint32_t id = nextThread.fetch_add(1, std::memory_order_relaxed);
+      return id;
+   }
+
+   void writeString(std::ofstream& out, const char* text) {
+      out << '"';
+      for (; *text != '\0'; ++text) {
+         const char ch = *text;
+         if (ch == '"' || ch == '\\') {
+            out << '\\' << ch;
+         } else if (static_cast<unsigned char>(ch) < 0x20) {
+            char escaped[8];
+            std::snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned>(ch));
+            out << escaped;
+         } else {
+            out << ch;
+         }
+      }
+      out << '"';
+   }
+
+   // --- trace_event timestamps are microseconds; keep the nanoseconds as decimals ---
+   void writeMicros(std::ofstream& out, int64_t nanos) {
+      char text[32];
+      std::snprintf(text, sizeof(text), "%lld.%03lld", static_cast<long long>(nanos / 1000), static_cast<long long>(nanos % 1000));
+      out << text;
+   }
+
+} // namespace
+
+namespace trace_detail {
+
+   std::atomic<uint32_t> session{ 0 };
+
+   int64_t nowNanos() {
+      return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+   }
+
+   void record(uint32_t spanSession, const char* name, int64_t startNanos, const char* const* argNames, const int64_t* argValues, int argCount) {
+      const int64_t end = nowNanos();
+      const uint32_t thread = threadId();
+
+      std::lock_guard<std::mutex> lock(mutex);
+      // --- Spans that straddle traceStop() (or a later traceStart()) belong to no recording ---
+      if (spanSession != session.load(std::memory_order_relaxed)) return;
+      if (events.size() == kMaxEvents) {
+         ++dropped;
+         return;
+      }
+
+      TraceEvent event{ name, startNanos - origin, end - startNanos, thread, argCount, {}, {} };
+      std::copy(argNames, argNames + argCount, event.argNames);
+      std::copy(argValues, argValues + argCount, event.argValues);
+      events.push_back(event);
+   }
+
+} // namespace trace_detail
+
+bool traceStart() {
+   std::lock_guard<std::mutex> lock(mutex);
+   if (trace_detail::session.load(std::memory_order_relaxed) != 0) return false;
+
+   events.clear();
+   dropped = 0;
+   origin = trace_detail::nowNanos();
+   if (++lastSession == 0) lastSession = 1;
+   trace_detail::session.store(lastSession, std::memory_order_relaxed);
+   return true;
+}
+
+bool traceStop(const std::string& path) {
+   std::vector<TraceEvent> recorded;
+   size_t droppedEvents = 0;
+   {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (trace_detail::session.load(std::memory_order_relaxed) == 0) return false;
+
+      trace_detail::session.store(0, std::memory_order_relaxed);
+      recorded.swap(events);
+      droppedEvents = dropped;
+   }
+
+   // --- Spans are recorded as they end; the viewer nests them more reliably in start order ---
+   std::stable_sort(recorded.begin(), recorded.end(), [](const TraceEvent& a, const TraceEvent& b) { return a.start < b.start; });
+
+   std::ofstream out(path, std::ios::binary | std::ios::trunc);
+   if (!out.is_open()) return false;
+
+   out << "{\"traceEvents\":[";
+   bool first = true;
+   for (const TraceEvent& event : recorded) {
+      out << (first ? "\n" : ",\n") << "{\"name\":";
+      first = false;
+      writeString(out, event.name);
+      out << ",\"cat\":\"phpspa\",\"ph\":\"X\",\"pid\":1,\"tid\":" << event.thread << ",\"ts\":";
+      writeMicros(out, event.start);
+      out << ",\"dur\":";
+      writeMicros(out, event.duration);
+
+      if (event.argCount > 0) {
+         out << ",\"args\":{";
+         for (int i = 0; i < event.argCount; ++i) {
+            if (i > 0) out << ',';
+            writeString(out, event.argNames[i]);
+            out << ':' << event.argValues[i];
+         }
+         out << '}';
+      }
+      out << '}';
+   }
+   out << "\n],\"displayTimeUnit\":\"ms\",\"otherData\":{\"droppedEvents\":" << droppedEvents << "}}\n";
+
+   out.close();
+   return !out.fail();
+}
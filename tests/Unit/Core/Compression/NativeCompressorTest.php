@@ -0,0 +1,641 @@
+<?php
+
+declare(strict_types=1);
+
+use PHPUnit\Framework\TestCase;
+use PhpSPA\Core\Compression\NativeCompressor;
+
+final class NativeCompressorTest extends TestCase
+{
+   /**
+    * Option values of a fresh handle; every test starts from them.
+    */
+   private const array DEFAULT_OPTIONS = [
+      'minified_threshold' => '0.95',
+      'prune_unused_css' => '0',
+      'css_allowlist' => '',
+      'omit_optional_tags' => '1',
+      'svg_precision' => '3',
+      'dedupe_inline_styles' => '0',
+      'dedupe_inline_scripts' => '0',
+      'mangle_names' => '0',
+      'mangle_allowlist' => '',
+      'canonical_attributes' => '0',
+      'bundler_min_bytes' => '0',
+      'fragment_cache' => '0',
+   ];
+
+   /**
+    * PHPSPA_JS_BUNDLER as the test found it.
+    */
+   private string|false $bundler = false;
+
+   protected function setUp(): void
+   {
+      $this->bundler = getenv('PHPSPA_JS_BUNDLER');
+
+      if (!NativeCompressor::isAvailable()) {
+         $this->markTestSkipped('Native compressor library is not available.');
+      }
+
+      // --- The committed library may predate the handle API; PHPSPA_COMPRESSOR_LIB points at a fresh build ---
+      if (NativeCompressor::getBundlerStats() === null) {
+         $this->markTestSkipped('Native compressor library is too old; build it and set PHPSPA_COMPRESSOR_LIB.');
+      }
+   }
+
+   protected function tearDown(): void
+   {
+      foreach (self::DEFAULT_OPTIONS as $name => $value) {
+         NativeCompressor::setOption($name, $value);
+      }
+      NativeCompressor::setLatencyBudget(null);
+      NativeCompressor::setAsyncBundling(false);
+      putenv($this->bundler === false ? 'PHPSPA_JS_BUNDLER' : 'PHPSPA_JS_BUNDLER=' . $this->bundler);
+   }
+
+   public function testTrainingCorpusShrinksWithEachLevel(): void
+   {
+      $types = ['html' => 'HTML', 'css' => 'CSS', 'js' => 'JS'];
+      $files = glob(\dirname(__DIR__, 4) . '/bench/corpus/*');
+      $this->assertNotEmpty($files);
+
+      foreach ($files as $file) {
+         $type = $types[pathinfo($file, PATHINFO_EXTENSION)];
+         $content = (string) file_get_contents($file);
+         $previous = $content;
+
+         foreach ([1, 2, 3] as $level) {
+            $compressed = NativeCompressor::compress($content, $level, $type, 'GLOBAL', false);
+            $this->assertLessThanOrEqual(\strlen($previous), \strlen($compressed), basename($file) . " at level $level");
+            $previous = $compressed;
+         }
+
+         $this->assertSame($previous, NativeCompressor::compress($previous, 3, $type, 'GLOBAL', false), basename($file) . ' compressed twice');
+      }
+   }
+
+   public function testInputIsReadByLengthNotUpToTheFirstNulByte(): void
+   {
+      $this->assertSame("<p>a\0b</p><div>c</div>", NativeCompressor::compress("<p>  a\0b  </p>\n<div> c </div>", 2, 'HTML', 'GLOBAL', false));
+      $this->assertSame(".a{color:red}\0.b{}", NativeCompressor::compress(".a { color : red }\0.b{}", 2, 'CSS', 'GLOBAL', false));
+   }
+
+   public function testHandleIsReusedAcrossInputs(): void
+   {
+      $this->assertSame('<div><p>first</p></div>', NativeCompressor::compress("<div>\n  <p> first </p>\n</div>", 2, 'HTML', 'GLOBAL', false));
+      $this->assertSame('<p>x</p>', NativeCompressor::compress('<p> x </p>', 2, 'HTML', 'GLOBAL', false));
+      $this->assertSame('<div><p>first</p></div>', NativeCompressor::compress("<div>\n  <p> first </p>\n</div>", 2, 'HTML', 'GLOBAL', false));
+   }
+
+   public function testOptionsReachExistingAndRecreatedHandles(): void
+   {
+      $list = "<ul>\n  <li>One</li>\n</ul>";
+      $this->assertSame('<ul><li>One</ul>', NativeCompressor::compress($list, 3, 'HTML', 'GLOBAL', false));
+
+      NativeCompressor::setOption('omit_optional_tags', '0');
+      $this->assertSame('<ul><li>One</li></ul>', NativeCompressor::compress($list, 3, 'HTML', 'GLOBAL', false));
+
+      NativeCompressor::releaseHandles();
+      $this->assertSame('<ul><li>One</li></ul>', NativeCompressor::compress($list, 3, 'HTML', 'GLOBAL', false));
+   }
+
+   public function testMinifiedPageIsPassedThrough(): void
+   {
+      $page = self::minifiedPage();
+
+      $this->assertSame($page, NativeCompressor::compress($page, 2, 'HTML', 'GLOBAL', false));
+      $this->assertSame(NativeCompressor::FLAG_SKIPPED_MINIFIED, NativeCompressor::getLastFlags() & NativeCompressor::FLAG_SKIPPED_MINIFIED);
+
+      NativeCompressor::setOption('minified_threshold', '2');
+      $this->assertSame($page, NativeCompressor::compress($page, 2, 'HTML', 'GLOBAL', false));
+      $this->assertSame(0, NativeCompressor::getLastFlags() & NativeCompressor::FLAG_SKIPPED_MINIFIED);
+   }
+
+   public function testCommentsDisqualifyThePassThrough(): void
+   {
+      $page = self::minifiedPage();
+      $commented = str_replace('<body>', '<body><!-- ' . str_repeat('y', 3000) . ' -->', $page);
+
+      $this->assertSame($page, NativeCompressor::compress($commented, 2, 'HTML', 'GLOBAL', false));
+      $this->assertSame(0, NativeCompressor::getLastFlags() & NativeCompressor::FLAG_SKIPPED_MINIFIED);
+   }
+
+   public function testMinifiedStylesheetIsOnlyTrimmed(): void
+   {
+      $once = NativeCompressor::compress((string) file_get_contents(\dirname(__DIR__, 4) . '/bench/corpus/vendor.min.css'), 2, 'CSS', 'GLOBAL', false);
+
+      $this->assertSame($once, NativeCompressor::compress($once, 2, 'CSS', 'GLOBAL', false));
+      $this->assertSame(NativeCompressor::FLAG_SKIPPED_MINIFIED, NativeCompressor::getLastFlags() & NativeCompressor::FLAG_SKIPPED_MINIFIED);
+   }
+
+   public function testStylesheetValuesAreCompacted(): void
+   {
+      $cases = [
+         '.a{margin:0px 0px 0px 0px;color:#ffffff;opacity:0.50;width:calc(100% - 10px);transition:all 0.300s;background:rgb(255,0,0)}'
+            => '.a{margin:0;color:#fff;opacity:.5;width:calc(100% - 10px);transition:all .3s;background:red}',
+         '.a{margin:10.0px -0.50em 0.0px 1.250rem;line-height:1.50}' => '.a{margin:10px -.5em 0 1.25rem;line-height:1.5}',
+         '.b{color:rgba(255,255,255,0.5);border-color:#AABBCC;background:#ff0000 url(a.png)}' => '.b{color:rgba(255,255,255,.5);border-color:#abc;background:red url(a.png)}',
+         '.c{padding:1px 2px 1px 2px;margin:0 auto 0 auto;font-weight:bold}' => '.c{padding:1px 2px;margin:0 auto;font-weight:700}',
+         '.d{content:"0.50";grid-area:1/2/3/4}' => '.d{content:"0.50";grid-area:1/2/3/4}',
+      ];
+
+      foreach ($cases as $css => $expected) {
+         $this->assertSame($expected, NativeCompressor::compress($css, 2, 'CSS', 'GLOBAL', false));
+      }
+   }
+
+   public function testStyleRulesAreMergedAcrossBlocksAtExtreme(): void
+   {
+      $cases = [
+         // --- Fallbacks for older browsers stay; only an identical value is a duplicate ---
+         '<style>.a{height:100vh;height:100dvh}</style>' => '<style>.a{height:100vh;height:100dvh}</style>',
+         '<style>.c{color:red;color:red}</style>' => '<style>.c{color:red}</style>',
+         '<style>.a{color:red}.b{color:red}</style>' => '<style>.a,.b{color:red}</style>',
+         '<style>.a{color:red}.b{margin:0}.a{color:red}</style>' => '<style>.a{color:red}.b{margin:0}</style>',
+         // --- grid-gap is the legacy name of gap: the rule between the copies overrides the first ---
+         '<style>.a{gap:1px}.b{grid-gap:2px}.a{gap:1px}</style>' => '<style>.a{gap:1px}.b{grid-gap:2px}.a{gap:1px}</style>',
+         // --- At-rules the merger does not understand are barriers ---
+         '<style>.a{color:red}@scope (.card){.a{color:blue}}.a{color:red}</style>' => '<style>.a{color:red}@scope (.card){.a{color:blue}}.a{color:red}</style>',
+      ];
+
+      foreach ($cases as $style => $expected) {
+         $markup = '<p class="a b c card">x</p>';
+         $this->assertSame($expected . $markup, NativeCompressor::compress($style . $markup, 3, 'HTML', 'GLOBAL', false));
+      }
+
+      $page = '<style>.a{color:red}</style><p class="a b">x</p><style>.a{color:red}.b{margin:0}</style>';
+      $this->assertSame('<style>.a{color:red}</style><p class="a b">x</p><style>.b{margin:0}</style>', NativeCompressor::compress($page, 3, 'HTML', 'GLOBAL', false));
+
+      $duplicate = '<style>.c{color:red;color:red}</style><p class="c">x</p>';
+      $this->assertSame($duplicate, NativeCompressor::compress($duplicate, 2, 'HTML', 'GLOBAL', false));
+   }
+
+   public function testUnusedRulesArePrunedFromFullPages(): void
+   {
+      $page = "<html>\n  <head>\n    <style>\n      .used { color: red }\n      .unused { color: blue }\n      .js-open { display: block }\n      #modal { top: 0 }\n    </style>\n  </head>\n  <body>\n    <div class=\"used\">x</div>\n  </body>\n</html>\n";
+      $this->assertSame(
+         '<html><head><style>.used{color:red}.unused{color:blue}.js-open{display:block}#modal{top:0}</style></head><body><div class="used">x</div></body></html>',
+         NativeCompressor::compress($page, 2, 'HTML', 'GLOBAL', false)
+      );
+
+      NativeCompressor::setOption('prune_unused_css', '1');
+      $this->assertSame('<html><head><style>.used{color:red}</style></head><body><div class="used">x</div></body></html>', NativeCompressor::compress($page, 2, 'HTML', 'GLOBAL', false));
+
+      NativeCompressor::setOption('css_allowlist', 'js-* #modal');
+      $this->assertSame(
+         '<html><head><style>.used{color:red}.js-open{display:block}#modal{top:0}</style></head><body><div class="used">x</div></body></html>',
+         NativeCompressor::compress($page, 2, 'HTML', 'GLOBAL', false)
+      );
+   }
+
+   public function testFragmentsAreNotPruned(): void
+   {
+      NativeCompressor::setOption('prune_unused_css', '1');
+
+      $fragment = "<style>\n  .used { color: red }\n  .unused { color: blue }\n</style>\n<div class=\"used\">x</div>\n";
+      $this->assertSame('<style>.used{color:red}.unused{color:blue}</style><div class="used">x</div>', NativeCompressor::compress($fragment, 2, 'HTML', 'GLOBAL', false));
+   }
+
+   public function testOptionalTagsAreOmittedAtExtreme(): void
+   {
+      $cases = [
+         "<ul>\n  <li>One</li>\n  <li>Two</li>\n</ul>\n<p>Text</p>\n<div>x</div>" => '<ul><li>One<li>Two</ul><p>Text<div>x</div>',
+         "<table>\n<tr><td>1</td><td>2</td></tr>\n</table>" => '<table><tr><td>1<td>2</table>',
+         '<select><option>a</option><option>b</option></select>' => '<select><option>a<option>b</select>',
+         '<dl><dt>t</dt><dd>d</dd></dl>' => '<dl><dt>t<dd>d</dl>',
+         // --- Text after it, or a parent like <a>, keeps </p> ---
+         '<div><p>a</p>b</div>' => '<div><p>a</p>b</div>',
+         '<a href="/x"><p>y</p></a>' => '<a href=/x><p>y</p></a>',
+      ];
+
+      foreach ($cases as $html => $expected) {
+         $this->assertSame($expected, NativeCompressor::compress($html, 3, 'HTML', 'GLOBAL', false));
+      }
+
+      $list = "<ul>\n  <li>One</li>\n  <li>Two</li>\n</ul>\n<p>Text</p>\n<div>x</div>";
+      $this->assertSame('<ul><li>One</li><li>Two</li></ul><p>Text</p><div>x</div>', NativeCompressor::compress($list, 2, 'HTML', 'GLOBAL', false));
+
+      NativeCompressor::setOption('omit_optional_tags', '0');
+      $this->assertSame('<ul><li>One</li><li>Two</li></ul><p>Text</p><div>x</div>', NativeCompressor::compress($list, 3, 'HTML', 'GLOBAL', false));
+   }
+
+   public function testSubmittedJobIsTakenOnce(): void
+   {
+      self::withoutBundler();
+      $script = "function add(first, second) {\n  // sum\n  return first + second;\n}\nconsole.log(add(1, 2));\n";
+
+      $ticket = NativeCompressor::submit($script, 2, 'JS', 'GLOBAL');
+      $this->assertNotNull($ticket);
+      $this->assertSame(NativeCompressor::JOB_DONE, NativeCompressor::wait($ticket, 10000));
+
+      $this->assertSame(NativeCompressor::compress($script, 2, 'JS', 'GLOBAL', false), NativeCompressor::take($ticket));
+      $this->assertNull(NativeCompressor::take($ticket));
+      $this->assertSame(NativeCompressor::JOB_UNKNOWN, NativeCompressor::poll($ticket));
+   }
+
+   public function testSubmitRejectsUnknownTypes(): void
+   {
+      $this->assertNull(NativeCompressor::submit('x', 2, 'PNG', 'GLOBAL'));
+      $this->assertSame(NativeCompressor::JOB_UNKNOWN, NativeCompressor::poll(PHP_INT_MAX));
+   }
+
+   public function testAsyncBundlingKeepsTheHandleOptions(): void
+   {
+      self::withoutBundler();
+      NativeCompressor::setAsyncBundling(true);
+      $list = "<ul>\n  <li>One</li>\n  <li>Two</li>\n</ul>\n<script>\nvar first = 1;\n</script>";
+
+      NativeCompressor::setOption('omit_optional_tags', '0');
+      $kept = NativeCompressor::compress($list, 3, 'HTML', 'GLOBAL', true);
+      $this->assertSame('<ul><li>One</li><li>Two</li></ul><script>var first=1;</script>', $kept);
+      $this->assertSame(NativeCompressor::hash($kept), NativeCompressor::getLastHash());
+      $this->assertSame(3, NativeCompressor::getLastLevel());
+
+      // --- Bundled output cached for one set of options is not served to another ---
+      NativeCompressor::setOption('omit_optional_tags', '1');
+      $this->assertSame('<ul><li>One<li>Two</ul><script>var first=1;</script>', NativeCompressor::compress($list, 3, 'HTML', 'GLOBAL', true));
+   }
+
+   public function testInlineScriptsAreRoutedOncePerPage(): void
+   {
+      self::withoutBundler();
+      NativeCompressor::setOption('bundler_min_bytes', '1');
+      $page = "<html><body><script>\nvar first = 1;\n// c\nconsole.log( first );\n</script><script>\nvar second = 2;\nconsole.log( second );\n</script></body></html>";
+
+      $before = self::bundlerDecisions();
+      $compressed = NativeCompressor::compress($page, 2, 'HTML', 'GLOBAL', true);
+
+      $this->assertSame('<html><body><script>var first=1;console.log(first);</script><script>var second=2;console.log(second);</script></body></html>', $compressed);
+      $this->assertSame($before + 1, self::bundlerDecisions());
+   }
+
+   public function testJsonIsStrippedOnlyWhenValid(): void
+   {
+      $cases = [
+         "{ \"a\" : [ 1, 2 ],\n  \"b\": \"x y\" }" => '{"a":[1,2],"b":"x y"}',
+         "{ \"s\" : \"a \\\" b\" ,\n \"t\" : \"\\\\\" }" => '{"s":"a \" b","t":"\\\\"}',
+         '  "x"  ' => '"x"',
+         // --- Invalid documents are returned as they came ---
+         '{ "a": [1, 2 }' => '{ "a": [1, 2 }',
+         '[ 1 , 2 ] [' => '[ 1 , 2 ] [',
+         '{ "a": 01 }' => '{ "a": 01 }',
+         '{ "a": tru }' => '{ "a": tru }',
+      ];
+
+      foreach ($cases as $json => $expected) {
+         $this->assertSame($expected, NativeCompressor::compress($json, 2, 'JSON', 'GLOBAL', false));
+      }
+   }
+
+   public function testJsonScriptsAreStrippedInPages(): void
+   {
+      $page = "<script type=\"application/ld+json\">\n{ \"@type\" : \"Person\" }\n</script><script type=\"application/json\">{ bad: 1 }</script><script type=\"text/template\"><p>  keep  </p></script>";
+      $this->assertSame(
+         '<script type="application/ld+json">{"@type":"Person"}</script><script type="application/json">{ bad: 1 }</script><script type="text/template"><p>  keep  </p></script>',
+         NativeCompressor::compress($page, 2, 'HTML', 'GLOBAL', false)
+      );
+
+      $this->assertSame(
+         '<script type=importmap>{"imports":{"a":"/a.js"}}</script>',
+         NativeCompressor::compress("<script type=\"importmap\">\n{ \"imports\" : { \"a\" : \"/a.js\" } }\n</script>", 3, 'HTML', 'GLOBAL', false)
+      );
+   }
+
+   public function testInlineSvgPathsAreMinifiedAtExtreme(): void
+   {
+      $svg = '<svg viewBox="0 0 24 24"><path d="M 10.123456 20.000000 L 30.500000 40.250000 Z"/></svg>';
+
+      $this->assertSame('<svg viewBox="0 0 24 24"><path d="M10.123 20 30.5 40.25z"/></svg>', NativeCompressor::compress($svg, 3, 'HTML', 'GLOBAL', false));
+      $this->assertSame($svg, NativeCompressor::compress($svg, 2, 'HTML', 'GLOBAL', false));
+
+      NativeCompressor::setOption('svg_precision', '1');
+      $this->assertSame('<svg viewBox="0 0 24 24"><path d="M10.1 20 30.5 40.3z"/></svg>', NativeCompressor::compress($svg, 3, 'HTML', 'GLOBAL', false));
+
+      NativeCompressor::setOption('svg_precision', '-1');
+      $this->assertSame('<svg viewBox="0 0 24 24"><path d="M10.123456 20 30.5 40.25Z"/></svg>', NativeCompressor::compress($svg, 3, 'HTML', 'GLOBAL', false));
+   }
+
+   public function testFragmentCacheKeepsOutputIdentical(): void
+   {
+      $fragment = "<div data-phpspa-target=\"card\">\n  <h2>  Title  </h2>\n  <p>  Body text  </p>\n</div>";
+      $page = "<html><body>\n" . $fragment . "\n<main>  <p> one </p> </main>\n" . $fragment . "\n</body></html>";
+
+      foreach ([1, 2, 3] as $level) {
+         NativeCompressor::setOption('fragment_cache', '0');
+         $expected = NativeCompressor::compress($page, $level, 'HTML', 'GLOBAL', false);
+
+         NativeCompressor::setOption('fragment_cache', '1');
+         $this->assertSame($expected, NativeCompressor::compress($page, $level, 'HTML', 'GLOBAL', false), "first run at level $level");
+         $this->assertSame($expected, NativeCompressor::compress($page, $level, 'HTML', 'GLOBAL', false), "cached run at level $level");
+      }
+
+      $this->assertSame(
+         '<html><body><div data-phpspa-target=card><h2>Title</h2><p>Body text</div><main><p>one</main><div data-phpspa-target=card><h2>Title</h2><p>Body text</div>',
+         NativeCompressor::compress($page, 3, 'HTML', 'GLOBAL', false)
+      );
+   }
+
+   public function testDeltaRoundTrip(): void
+   {
+      $base = NativeCompressor::compress('<div><h1>Home</h1><p>Welcome to the home page, with a long paragraph of text that repeats.</p></div>', 2, 'HTML', 'GLOBAL', false);
+      $target = NativeCompressor::compress('<div><h1>About</h1><p>Welcome to the home page, with a long paragraph of text that repeats.</p></div>', 2, 'HTML', 'GLOBAL', false);
+
+      $patch = NativeCompressor::encodeDelta($base, $target);
+      $this->assertNotNull($patch);
+      $this->assertLessThan(\strlen($target), \strlen($patch));
+      $this->assertSame($target, NativeCompressor::applyDelta($base, $patch));
+
+      $fromNothing = NativeCompressor::encodeDelta('', $target);
+      $this->assertNotNull($fromNothing);
+      $this->assertSame($target, NativeCompressor::applyDelta('', $fromNothing));
+   }
+
+   public function testDeltaRejectsOtherBasesAndMalformedPatches(): void
+   {
+      $patch = NativeCompressor::encodeDelta('<p>first render</p>', '<p>second render</p>');
+      $this->assertNotNull($patch);
+
+      $this->assertNull(NativeCompressor::applyDelta('<p>another page</p>', $patch));
+      $this->assertNull(NativeCompressor::applyDelta('<p>first render</p>', 'garbage'));
+   }
+
+   public function testLastHashMatchesTheOutput(): void
+   {
+      $page = "<html>\n<body>\n  <div   class=\"x\">  Hello   world  </div>\n</body>\n</html>\n";
+
+      foreach ([1, 2, 3] as $level) {
+         $compressed = NativeCompressor::compress($page, $level, 'HTML', 'GLOBAL', false);
+         $this->assertMatchesRegularExpression('/^[0-9a-f]{16}$/', (string) NativeCompressor::getLastHash());
+         $this->assertSame(NativeCompressor::hash($compressed), NativeCompressor::getLastHash());
+      }
+
+      // --- The pass-through path hashes what it returns too ---
+      $minified = self::minifiedPage();
+      NativeCompressor::compress($minified, 2, 'HTML', 'GLOBAL', false);
+      $this->assertSame(NativeCompressor::hash($minified), NativeCompressor::getLastHash());
+      $this->assertNotSame(NativeCompressor::hash($minified), NativeCompressor::hash($minified . ' '));
+   }
+
+   public function testTraceIsWrittenAsTraceEventJson(): void
+   {
+      $path = tempnam(sys_get_temp_dir(), 'phpspa_trace_');
+
+      try {
+         $this->assertTrue(NativeCompressor::startTrace());
+         $this->assertFalse(NativeCompressor::startTrace());
+
+         NativeCompressor::compress('<p> x </p>', 2, 'HTML', 'GLOBAL', false);
+
+         $this->assertTrue(NativeCompressor::stopTrace($path));
+         $this->assertFalse(NativeCompressor::stopTrace($path));
+
+         $trace = json_decode((string) file_get_contents($path), true, 512, JSON_THROW_ON_ERROR);
+         $names = array_column($trace['traceEvents'], 'name');
+         $this->assertContains('compress', $names);
+         $this->assertContains('minifyHTML', $names);
+      } finally {
+         @unlink($path);
+      }
+   }
+
+   public function testSharedCacheServesTheSameOutput(): void
+   {
+      $cachePath = tempnam(sys_get_temp_dir(), 'phpspa_cache_');
+      $tracePath = tempnam(sys_get_temp_dir(), 'phpspa_trace_');
+      $page = "<div>\n  <p> shared </p>\n</div>";
+
+      try {
+         $this->assertTrue(NativeCompressor::enableSharedCache($cachePath, 1024 * 1024));
+
+         NativeCompressor::startTrace();
+         $first = NativeCompressor::compress($page, 2, 'HTML', 'GLOBAL', false);
+         $firstHash = NativeCompressor::getLastHash();
+         $second = NativeCompressor::compress($page, 2, 'HTML', 'GLOBAL', false);
+         NativeCompressor::stopTrace($tracePath);
+
+         $this->assertSame('<div><p>shared</p></div>', $first);
+         $this->assertSame($first, $second);
+         $this->assertSame($firstHash, NativeCompressor::getLastHash());
+
+         $trace = json_decode((string) file_get_contents($tracePath), true, 512, JSON_THROW_ON_ERROR);
+         $lookups = array_values(array_filter($trace['traceEvents'], static fn(array $event): bool => $event['name'] === 'shared cache lookup'));
+         $this->assertSame([0, 1], array_map(static fn(array $event): int => $event['args']['hit'], $lookups));
+      } finally {
+         @unlink($cachePath);
+         @unlink($tracePath);
+      }
+   }
+
+   public function testEachLevelRunsItsOwnKernel(): void
+   {
+      $page = self::layoutPage();
+      $expected = [
+         1 => "<html><head><title>T</title></head><body><!-- note --><div   class=\"x\">Hello world</div><pre>  keep\n  this </pre></body></html>",
+         2 => "<html><head><title>T</title></head><body><div class=\"x\">Hello world</div><pre>  keep\n  this </pre></body></html>",
+         3 => "<html><head><title>T</title><body><div class=x>Hello world</div><pre>  keep\n  this </pre>",
+      ];
+
+      foreach ($expected as $level => $html) {
+         $this->assertSame($html, NativeCompressor::compress($page, $level, 'HTML', 'GLOBAL', false), "level $level");
+      }
+   }
+
+   public function testLargePagesCompressLikeTheirParts(): void
+   {
+      // --- Over 1 MiB, so machines with several cores split it into chunks minified in parallel ---
+      $block = "<section class=\"row\">\n  <h2>  Title  </h2>\n  <p>  Some   text   here  </p>\n  <pre>  keep\n   this  </pre>\n  <ul>\n    <li> one </li>\n    <li> two </li>\n  </ul>\n</section>\n";
+      $count = intdiv(1024 * 1024, \strlen($block)) + 100;
+      $page = static fn(string $body): string => "<!DOCTYPE html>\n<html>\n<head>\n  <title> Large </title>\n</head>\n<body>\n" . $body . "</body>\n</html>\n";
+
+      foreach ([1, 2, 3] as $level) {
+         $part = NativeCompressor::compress($block, $level, 'HTML', 'GLOBAL', false);
+         $single = NativeCompressor::compress($page($block), $level, 'HTML', 'GLOBAL', false);
+         $this->assertSame(1, substr_count($single, $part));
+
+         $expected = str_replace($part, str_repeat($part, $count), $single);
+         $this->assertSame($expected, NativeCompressor::compress($page(str_repeat($block, $count)), $level, 'HTML', 'GLOBAL', false), "level $level");
+      }
+   }
+
+   public function testWhitespaceLevelOnlyCollapsesWhitespace(): void
+   {
+      // --- PHP levels start at BASIC; an exhausted budget is what selects the whitespace-only level ---
+      NativeCompressor::setLatencyBudget(0);
+
+      $this->assertSame(
+         "<html><head><title> T </title></head><body><div   class=\"x\"> Hello world </div><pre>  keep\n  this </pre></body></html>",
+         NativeCompressor::compress(self::layoutPage(), 3, 'HTML', 'GLOBAL', false)
+      );
+      $this->assertSame(0, NativeCompressor::getLastLevel());
+   }
+
+   public function testLatencyBudgetLowersTheLevel(): void
+   {
+      $page = self::layoutPage();
+      $unbounded = NativeCompressor::compress($page, 3, 'HTML', 'GLOBAL', false);
+
+      NativeCompressor::setLatencyBudget(10_000_000);
+      $this->assertSame($unbounded, NativeCompressor::compress($page, 3, 'HTML', 'GLOBAL', false));
+      $this->assertSame(3, NativeCompressor::getLastLevel());
+      $this->assertSame(0, NativeCompressor::getLastFlags() & NativeCompressor::FLAG_DEADLINE_DEGRADED);
+
+      NativeCompressor::setLatencyBudget(0);
+      NativeCompressor::compress($page, 3, 'HTML', 'GLOBAL', false);
+      $this->assertLessThan(3, (int) NativeCompressor::getLastLevel());
+
+      // --- Mangled names must match the stylesheets and scripts compressed at EXTREME ---
+      NativeCompressor::setOption('mangle_names', '1');
+      NativeCompressor::compress($page, 3, 'HTML', 'GLOBAL', false);
+      $this->assertSame(3, NativeCompressor::getLastLevel());
+      $this->assertSame(NativeCompressor::FLAG_DEADLINE_DEGRADED, NativeCompressor::getLastFlags() & NativeCompressor::FLAG_DEADLINE_DEGRADED);
+   }
+
+   public function testScriptsBelowTheMinimumSizeSkipTheBundler(): void
+   {
+      self::withoutBundler();
+      // --- Each call compresses a script of its own, so no cached output skips the routing ---
+      $script = static fn(string $name): string => "function $name(first, second) {\n  return first + second;\n}\n";
+
+      NativeCompressor::setOption('bundler_min_bytes', '100000');
+      $before = NativeCompressor::getBundlerStats();
+      $this->assertSame('function belowMinimum(first,second){return first+second;}', NativeCompressor::compress($script('belowMinimum'), 2, 'JS', 'GLOBAL', true));
+      $after = NativeCompressor::getBundlerStats();
+      $this->assertSame($before['native_small'] + 1, $after['native_small']);
+
+      NativeCompressor::setOption('bundler_min_bytes', '1');
+      $decisions = self::bundlerDecisions();
+      NativeCompressor::compress($script('aboveMinimum'), 2, 'JS', 'GLOBAL', true);
+      $this->assertSame($decisions + 1, self::bundlerDecisions());
+      $this->assertSame($after['native_small'], NativeCompressor::getBundlerStats()['native_small']);
+   }
+
+   public function testMangledNamesAgreeAcrossMarkupStylesAndScripts(): void
+   {
+      NativeCompressor::setOption('mangle_names', '1');
+      $compressed = NativeCompressor::compress(self::manglePage(), 3, 'HTML', 'GLOBAL', false);
+
+      // --- Short names are handed out per process, so read them back from the markup ---
+      $this->assertSame(1, preg_match('/<nav id=([\w-]+)><div class="([\w-]+) ([\w-]+)">/', $compressed, $names));
+      [, $nav, $header, $toggle] = $names;
+
+      foreach (['main-nav', 'card-header', 'js-toggle'] as $original) {
+         $this->assertStringNotContainsString($original, $compressed);
+      }
+      $this->assertStringContainsString(".$header{color:red}#$nav{top:0}.$toggle{x:1}", $compressed);
+      $this->assertStringContainsString("document.querySelector('.$header');", $compressed);
+
+      $mapPath = tempnam(sys_get_temp_dir(), 'phpspa_names_');
+      try {
+         $this->assertTrue(NativeCompressor::exportNameMap($mapPath));
+         $map = json_decode((string) file_get_contents($mapPath), true, 512, JSON_THROW_ON_ERROR);
+         $this->assertSame($header, $map['classes']['card-header']);
+         $this->assertSame($nav, $map['ids']['main-nav']);
+      } finally {
+         @unlink($mapPath);
+      }
+   }
+
+   public function testAllowlistedNamesAreKeptAsWritten(): void
+   {
+      NativeCompressor::setOption('mangle_names', '1');
+      NativeCompressor::setOption('mangle_allowlist', 'card-* #main-nav');
+      $compressed = NativeCompressor::compress(self::manglePage(), 3, 'HTML', 'GLOBAL', false);
+
+      $this->assertSame(1, preg_match('/<div class="card-header ([\w-]+)">/', $compressed, $names));
+      $this->assertNotSame('js-toggle', $names[1]);
+      $this->assertStringContainsString('<nav id=main-nav>', $compressed);
+      $this->assertStringContainsString(".card-header{color:red}#main-nav{top:0}.{$names[1]}{x:1}", $compressed);
+      $this->assertStringContainsString("document.querySelector('.card-header');", $compressed);
+   }
+
+   public function testNamesAreOnlyMangledAtExtreme(): void
+   {
+      NativeCompressor::setOption('mangle_names', '1');
+
+      $this->assertStringContainsString('class="card-header js-toggle"', NativeCompressor::compress(self::manglePage(), 2, 'HTML', 'GLOBAL', false));
+   }
+
+   public function testRepeatedInlineStylesAreKeptOnce(): void
+   {
+      $page = '<div><style>.a{color:red}</style>x</div><div><style>.a{color:red}</style>y</div><script>init()</script><script>init()</script>';
+      // --- Off by default: a partial navigation may swap in the component whose copy was dropped ---
+      $this->assertSame('<div><style>.a{color:red}</style>x</div><div><style>.a{color:red}</style>y</div><script>init()</script><script>init()</script>', NativeCompressor::compress($page, 2, 'HTML', 'GLOBAL', false));
+
+      NativeCompressor::setOption('dedupe_inline_styles', '1');
+      $this->assertSame('<div><style>.a{color:red}</style>x</div><div>y</div><script>init()</script><script>init()</script>', NativeCompressor::compress($page, 2, 'HTML', 'GLOBAL', false));
+
+      // --- A different stylesheet between the copies would win over the first: the last one stays ---
+      $overridden = '<div><style>.a{color:red}</style>x</div><style>.a{color:blue}</style><div><style>.a{color:red}</style>y</div>';
+      $this->assertSame('<div>x</div><style>.a{color:blue}</style><div><style>.a{color:red}</style>y</div>', NativeCompressor::compress($overridden, 2, 'HTML', 'GLOBAL', false));
+
+      $template = '<style>.a{color:red}</style><template><style>.a{color:red}</style></template>';
+      $this->assertSame($template, NativeCompressor::compress($template, 2, 'HTML', 'GLOBAL', false));
+   }
+
+   public function testRepeatedInlineScriptsAreDedupedOnlyWhenEnabled(): void
+   {
+      NativeCompressor::setOption('dedupe_inline_scripts', '1');
+
+      $page = '<div><style>.a{color:red}</style>x</div><div><style>.a{color:red}</style>y</div><script>init()</script><script>init()</script>';
+      $this->assertSame('<div><style>.a{color:red}</style>x</div><div><style>.a{color:red}</style>y</div><script>init()</script>', NativeCompressor::compress($page, 2, 'HTML', 'GLOBAL', false));
+
+      $current = '<script>document.currentScript.remove()</script><script>document.currentScript.remove()</script>';
+      $this->assertSame($current, NativeCompressor::compress($current, 2, 'HTML', 'GLOBAL', false));
+   }
+
+   public function testAttributesAndClassesAreCanonicalized(): void
+   {
+      $html = '<div id="x" class="b a b" data-z="1">x</div><div class="{{ cls }} b a">y</div>';
+      $this->assertSame('<div id=x class="b a b" data-z=1>x</div><div class="{{ cls }} b a">y</div>', NativeCompressor::compress($html, 3, 'HTML', 'GLOBAL', false));
+
+      NativeCompressor::setOption('canonical_attributes', '1');
+      $this->assertSame('<div class="a b" data-z=1 id=x>x</div><div class="{{ cls }} b a">y</div>', NativeCompressor::compress($html, 3, 'HTML', 'GLOBAL', false));
+      $this->assertSame('<div id="x" class="b a b" data-z="1">x</div><div class="{{ cls }} b a">y</div>', NativeCompressor::compress($html, 2, 'HTML', 'GLOBAL', false));
+
+      // --- Framework directives may run in written order: such tags keep their attribute order ---
+      $this->assertSame(
+         '<div x-data={} class="a b" id=y>x</div><p class="${c} z" title=t>y</p><input name=n type=text value=v>',
+         NativeCompressor::compress('<div x-data="{}" class="b a" id="y">x</div><p title="t" class="${c} z">y</p><input value="v" name="n" type="text">', 3, 'HTML', 'GLOBAL', false)
+      );
+   }
+
+   /**
+    * Point the bundler at a missing binary, so scripts fall back to the
+    * native minifier instead of fetching esbuild through npx.
+    */
+   private static function withoutBundler(): void
+   {
+      putenv('PHPSPA_JS_BUNDLER=' . __DIR__ . '/missing-esbuild');
+   }
+
+   private static function minifiedPage(): string
+   {
+      $rows = '';
+      for ($i = 0; $i < 30; $i++) {
+         $rows .= '<div class="row"><span>item' . $i . '</span></div>';
+      }
+
+      return '<!DOCTYPE html><html><head><title>t</title></head><body>' . $rows . '</body></html>';
+   }
+
+   /**
+    * Routing decisions made so far between esbuild and the native minifier.
+    */
+   private static function bundlerDecisions(): int
+   {
+      $stats = NativeCompressor::getBundlerStats() ?? [];
+
+      return ($stats['bundled'] ?? 0) + ($stats['native_small'] ?? 0) + ($stats['native_low_savings'] ?? 0) + ($stats['explored'] ?? 0);
+   }
+
+   private static function layoutPage(): string
+   {
+      return "<html>\n<head>\n  <title> T </title>\n</head>\n<body>\n  <!-- note -->\n  <div   class=\"x\">  Hello   world  </div>\n  <pre>  keep\n  this </pre>\n</body>\n</html>\n";
+   }
+
+   private static function manglePage(): string
+   {
+      return "<html>\n<head>\n  <style>.card-header { color: red } #main-nav { top: 0 } .js-toggle { x: 1 }</style>\n</head>\n<body>\n  <nav id=\"main-nav\"><div class=\"card-header js-toggle\">x</div></nav>\n  <script>document.querySelector('.card-header');</script>\n</body>\n</html>\n";
+   }
+}